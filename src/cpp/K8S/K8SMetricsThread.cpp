@@ -51,6 +51,62 @@ K8SMetricsThread::K8SMetricsThread(std::string const& job_name, PE const& pe, ui
                               { { "job", m_job_name }, { "pe", m_pe_id } },
                               "Number of tuples filtered out by connection",
                               1))
+  , m_pe_conn_transport_metrics(
+      { K8SCounterMetric::build(m_registry,
+                                "pe_output_n_batches_flushed",
+                                { { "job", m_job_name }, { "pe", m_pe_id } },
+                                "Number of message batches written by connection",
+                                2),
+        K8SCounterMetric::build(m_registry,
+                                "pe_output_n_messages_batched",
+                                { { "job", m_job_name }, { "pe", m_pe_id } },
+                                "Number of messages written in batches by connection",
+                                3),
+        K8SCounterMetric::build(m_registry,
+                                "pe_output_n_flushes_on_size",
+                                { { "job", m_job_name }, { "pe", m_pe_id } },
+                                "Number of batches flushed because the send buffer was full",
+                                4),
+        K8SCounterMetric::build(m_registry,
+                                "pe_output_n_flushes_on_deadline",
+                                { { "job", m_job_name }, { "pe", m_pe_id } },
+                                "Number of batches flushed because of the latency deadline",
+                                5),
+        K8SCounterMetric::build(m_registry,
+                                "pe_output_n_flushes_on_punct",
+                                { { "job", m_job_name }, { "pe", m_pe_id } },
+                                "Number of batches flushed because of a punctuation",
+                                6),
+        K8SGaugeMetric::build(m_registry,
+                              "pe_output_n_messages_queued",
+                              { { "job", m_job_name }, { "pe", m_pe_id } },
+                              "Number of messages waiting for the connection writer thread",
+                              7),
+        K8SCounterMetric::build(m_registry,
+                                "pe_output_n_messages_dropped",
+                                { { "job", m_job_name }, { "pe", m_pe_id } },
+                                "Number of messages the connection writer thread could not write",
+                                8),
+        K8SCounterMetric::build(m_registry,
+                                "pe_output_n_bytes_compressed",
+                                { { "job", m_job_name }, { "pe", m_pe_id } },
+                                "Number of bytes submitted to compression by connection",
+                                9),
+        K8SCounterMetric::build(m_registry,
+                                "pe_output_n_bytes_saved_by_compression",
+                                { { "job", m_job_name }, { "pe", m_pe_id } },
+                                "Number of bytes compression saved on the connection",
+                                10),
+        K8SGaugeMetric::build(m_registry,
+                              "pe_output_compression_ratio",
+                              { { "job", m_job_name }, { "pe", m_pe_id } },
+                              "Compressed size in percent of the bytes submitted to compression",
+                              11),
+        K8SCounterMetric::build(m_registry,
+                                "pe_output_compression_time",
+                                { { "job", m_job_name }, { "pe", m_pe_id } },
+                                "CPU time spent compressing by connection (microseconds)",
+                                12) })
   ,
 
   // Note that the order of the metrics below matches the order established in the public
@@ -74,7 +130,22 @@ K8SMetricsThread::K8SMetricsThread(std::string const& job_name, PE const& pe, ui
                                             "pe_input_n_final_puncts_processed",
                                             { { "job", m_job_name }, { "pe", m_pe_id } },
                                             "Processed input final punctations count",
-                                            SPL::PEMetrics::nFinalPunctsProcessed) })
+                                            SPL::PEMetrics::nFinalPunctsProcessed),
+                    K8SGaugeMetric::build(m_registry,
+                                          "pe_input_deliver_latency_p50",
+                                          { { "job", m_job_name }, { "pe", m_pe_id } },
+                                          "Median delivery time in nanoseconds",
+                                          SPL::PEMetrics::deliverLatencyP50),
+                    K8SGaugeMetric::build(m_registry,
+                                          "pe_input_deliver_latency_p99",
+                                          { { "job", m_job_name }, { "pe", m_pe_id } },
+                                          "99th percentile delivery time in nanoseconds",
+                                          SPL::PEMetrics::deliverLatencyP99),
+                    K8SGaugeMetric::build(m_registry,
+                                          "pe_input_deliver_latency_p999",
+                                          { { "job", m_job_name }, { "pe", m_pe_id } },
+                                          "99.9th percentile delivery time in nanoseconds",
+                                          SPL::PEMetrics::deliverLatencyP999) })
   ,
 
   // Note that the order of the metrics below matches the order established in the public
@@ -194,7 +265,48 @@ K8SMetricsThread::K8SMetricsThread(std::string const& job_name, PE const& pe, ui
         "op_input_n_enqueue_waits",
         { { "job", m_job_name }, { "pe", m_pe_id } },
         "Number of waits due to a full queue when enqueueing times for the port",
-        SPL::OperatorMetrics::nEnqueueWaits) })
+        SPL::OperatorMetrics::nEnqueueWaits),
+      K8SCounterMetric::build(
+        m_registry,
+        "op_input_queue_wait_time",
+        { { "job", m_job_name }, { "pe", m_pe_id } },
+        "Time in milliseconds the port thread waited for items to be queued",
+        SPL::OperatorMetrics::queueWaitTime),
+      K8SCounterMetric::build(m_registry,
+                              "op_input_n_dequeue_batches",
+                              { { "job", m_job_name }, { "pe", m_pe_id } },
+                              "Number of batches of items dequeued by the port thread",
+                              SPL::OperatorMetrics::nDequeueBatches),
+      K8SGaugeMetric::build(m_registry,
+                            "op_input_queue_latency_p50",
+                            { { "job", m_job_name }, { "pe", m_pe_id } },
+                            "Median queueing time in nanoseconds for the port",
+                            SPL::OperatorMetrics::queueLatencyP50),
+      K8SGaugeMetric::build(m_registry,
+                            "op_input_queue_latency_p99",
+                            { { "job", m_job_name }, { "pe", m_pe_id } },
+                            "99th percentile queueing time in nanoseconds for the port",
+                            SPL::OperatorMetrics::queueLatencyP99),
+      K8SGaugeMetric::build(m_registry,
+                            "op_input_queue_latency_p999",
+                            { { "job", m_job_name }, { "pe", m_pe_id } },
+                            "99.9th percentile queueing time in nanoseconds for the port",
+                            SPL::OperatorMetrics::queueLatencyP999),
+      K8SGaugeMetric::build(m_registry,
+                            "op_input_process_latency_p50",
+                            { { "job", m_job_name }, { "pe", m_pe_id } },
+                            "Median processing time in nanoseconds for the port",
+                            SPL::OperatorMetrics::processLatencyP50),
+      K8SGaugeMetric::build(m_registry,
+                            "op_input_process_latency_p99",
+                            { { "job", m_job_name }, { "pe", m_pe_id } },
+                            "99th percentile processing time in nanoseconds for the port",
+                            SPL::OperatorMetrics::processLatencyP99),
+      K8SGaugeMetric::build(m_registry,
+                            "op_input_process_latency_p999",
+                            { { "job", m_job_name }, { "pe", m_pe_id } },
+                            "99.9th percentile processing time in nanoseconds for the port",
+                            SPL::OperatorMetrics::processLatencyP999) })
   ,
 
   // Note that this order matches the order in the enum
@@ -260,6 +372,9 @@ void K8SMetricsThread::initializePEOutputConnectionMetrics(const size_t i,
           { { "pe_port", std::to_string(i) }, { "connection", pe_port } });
         m_pe_n_tuples_filtered_out->append(
           { { "pe_port", std::to_string(i) }, { "connection", pe_port } });
+        for (auto& m : m_pe_conn_transport_metrics) {
+            m->append({ { "pe_port", std::to_string(i) }, { "connection", pe_port } });
+        }
     }
 }
 
@@ -336,6 +451,12 @@ void K8SMetricsThread::collectPEOutputMetrics(const PEMetricsInfo& peMetrics)
             m_pe_n_tuples_filtered_out->clear();
             reset = true;
         }
+        for (auto& m : m_pe_conn_transport_metrics) {
+            if (m->size() != connectionMetrics.size()) {
+                m->clear();
+                reset = true;
+            }
+        }
         /*
          * Re-initialize the connection metrics upon reset.
          */
@@ -350,6 +471,9 @@ void K8SMetricsThread::collectPEOutputMetrics(const PEMetricsInfo& peMetrics)
         for (auto& kv : connectionMetrics) {
             m_pe_output_congestion_factor_metric->update(j, kv.second);
             m_pe_n_tuples_filtered_out->update(j, kv.second);
+            for (auto& m : m_pe_conn_transport_metrics) {
+                m->update(j, kv.second);
+            }
             j += 1;
         }
     }
@@ -70,6 +70,7 @@ class K8SMetricsThread : public UTILS_NAMESPACE::Thread
     Registry m_registry;
     K8SMetric::Ref m_pe_output_congestion_factor_metric;
     K8SMetric::Ref m_pe_n_tuples_filtered_out;
+    std::vector<K8SMetric::Ref> m_pe_conn_transport_metrics;
     std::vector<K8SMetric::Ref> m_pe_in_metrics;
     std::vector<K8SMetric::Ref> m_pe_out_metrics;
     std::vector<K8SMetric::Ref> m_op_in_metrics;
@@ -0,0 +1,338 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TestUtils.h"
+#include <TRANS/ShmRing.h>
+#include <UTILS/DistilleryApplication.h>
+#include <UTILS/Thread.h>
+#include <UTILS/UTILSTypes.h>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <algorithm>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DBG_ASP "ShmRingTest"
+
+/**
+ * \file ShmRingTest.cpp
+ * Test of the shared memory ring used between co-located PEs.
+ *
+ * The single-threaded tests check the ring capacity, the wrap around of
+ * the data, the park/wakeup flags and closing.  The multi-threaded test
+ * runs a writer and a reader on the two ends of a ring: the writer sends
+ * a sequence of numbers in chunks of varying sizes, and wakes up the
+ * reader through a pipe, which stands for the connection socket, when
+ * the reader parked.  The reader checks that it receives the sequence in
+ * order and that it is never left parked with data in the ring.
+ */
+
+namespace Distillery {
+
+class ShmRingTest : public DistilleryApplication
+{
+  public:
+    /// Default number of 32-bit values sent through the ring
+    static const unsigned int defaultValueCount = 10000000;
+
+    ShmRingTest()
+      : valueCount_(defaultValueCount)
+    {}
+
+    void getArguments(option_vector_t& options);
+    virtual int run(const std::vector<std::string>& /*remains*/);
+
+    void setValueCount(const option_t* option, int value)
+    {
+        if (value < 1) {
+            THROW(InvalidOption, "valueCount must be greater than 0");
+        }
+        valueCount_ = value;
+    }
+
+  private:
+    void testReadWrite();
+    void testWrapAround();
+    void testPark();
+    void testClose();
+    void testWriterReader();
+
+    unsigned int valueCount_;
+};
+
+/// Writer end of the multi-threaded test
+class RingWriter : public Thread
+{
+  public:
+    RingWriter(ShmRing& ring, int wakeupFd, unsigned int count)
+      : ring_(ring)
+      , wakeupFd_(wakeupFd)
+      , count_(count)
+      , wakeups_(0)
+    {}
+
+    void* run(void* /*args*/)
+    {
+        uint32_t block[97];
+        unsigned int next = 0;
+        unsigned int chunk = 1;
+        while (next < count_) {
+            unsigned int n = std::min(chunk, count_ - next);
+            for (unsigned int i = 0; i < n; i++) {
+                block[i] = next + i;
+            }
+
+            // Writes may be partial: the ring only takes whole bytes it has
+            // room for, so the rest of the block is sent on the next round
+            const unsigned char* data = reinterpret_cast<const unsigned char*>(block);
+            size_t size = n * sizeof(uint32_t);
+            while (size > 0) {
+                struct iovec iov[2];
+                iov[0].iov_base = const_cast<unsigned char*>(data);
+                iov[0].iov_len = size / 2;
+                iov[1].iov_base = const_cast<unsigned char*>(data + size / 2);
+                iov[1].iov_len = size - size / 2;
+                size_t written = ring_.writev(iov, 2);
+                if (written == 0) {
+                    ring_.waitWritable(1000);
+                    continue;
+                }
+                data += written;
+                size -= written;
+                if (ring_.needsWakeup()) {
+                    char c = 0;
+                    ASSERT_EQUALS(1L, static_cast<long>(::write(wakeupFd_, &c, 1)));
+                    wakeups_++;
+                }
+            }
+            next += n;
+            chunk = chunk % 97 + 1;
+        }
+        return NULL;
+    }
+
+    unsigned int wakeups() const { return wakeups_; }
+
+  private:
+    ShmRing& ring_;
+    int wakeupFd_;
+    unsigned int count_;
+    unsigned int wakeups_;
+};
+
+} // namespace Distillery
+
+using namespace Distillery;
+
+void ShmRingTest::getArguments(option_vector_t& options)
+{
+    option_t args[] = {
+        { 'n', "valueCount", ARG, "",
+          "Send the specified number of values through the ring (default 10000000)",
+          INT_OPT(ShmRingTest::setValueCount) },
+    };
+    APPEND_OPTIONS(options, args);
+}
+
+int ShmRingTest::run(const std::vector<std::string>&)
+{
+    testReadWrite();
+    testWrapAround();
+    testPark();
+    testClose();
+    testWriterReader();
+    SPCDBG(L_INFO, "Success!", DBG_ASP);
+    return 0;
+}
+
+void ShmRingTest::testReadWrite()
+{
+    // The capacity is rounded up to a power of 2
+    boost::scoped_ptr<ShmRing> writer(ShmRing::create(100));
+    boost::scoped_ptr<ShmRing> reader(ShmRing::attach(writer->name()));
+    writer->unlink();
+    ASSERT_TRUE(reader->empty());
+
+    unsigned char in[200], out[200];
+    for (unsigned int i = 0; i < sizeof(in); i++) {
+        in[i] = static_cast<unsigned char>(i);
+    }
+    struct iovec iov;
+    iov.iov_base = in;
+    iov.iov_len = sizeof(in);
+
+    // A full ring takes what fits, then nothing
+    ASSERT_EQUALS(128L, static_cast<long>(writer->writev(&iov, 1)));
+    ASSERT_EQUALS(0L, static_cast<long>(writer->writev(&iov, 1)));
+    ASSERT_TRUE(!reader->empty());
+
+    ASSERT_EQUALS(28L, static_cast<long>(reader->read(out, 28)));
+    ASSERT_EQUALS(100L, static_cast<long>(reader->read(out + 28, sizeof(out))));
+    ASSERT_TRUE(memcmp(in, out, 128) == 0);
+    ASSERT_TRUE(reader->empty());
+    ASSERT_EQUALS(0L, static_cast<long>(reader->read(out, sizeof(out))));
+}
+
+void ShmRingTest::testWrapAround()
+{
+    boost::scoped_ptr<ShmRing> writer(ShmRing::create(64));
+    boost::scoped_ptr<ShmRing> reader(ShmRing::attach(writer->name()));
+    writer->unlink();
+
+    // Blocks of a size prime to the capacity wrap at every offset
+    unsigned char in[37], out[37];
+    for (unsigned int round = 0; round < 1000; round++) {
+        for (unsigned int i = 0; i < sizeof(in); i++) {
+            in[i] = static_cast<unsigned char>(round + i);
+        }
+        struct iovec iov[3];
+        iov[0].iov_base = in;
+        iov[0].iov_len = 5;
+        iov[1].iov_base = in + 5;
+        iov[1].iov_len = 0;
+        iov[2].iov_base = in + 5;
+        iov[2].iov_len = sizeof(in) - 5;
+        ASSERT_EQUALS(static_cast<long>(sizeof(in)), static_cast<long>(writer->writev(iov, 3)));
+        ASSERT_EQUALS(static_cast<long>(sizeof(out)),
+                      static_cast<long>(reader->read(out, sizeof(out))));
+        ASSERT_TRUE_MSG("round " << round, memcmp(in, out, sizeof(in)) == 0);
+    }
+}
+
+void ShmRingTest::testPark()
+{
+    boost::scoped_ptr<ShmRing> writer(ShmRing::create(64));
+    boost::scoped_ptr<ShmRing> reader(ShmRing::attach(writer->name()));
+    writer->unlink();
+
+    // No wakeup unless the reader parked
+    unsigned char c = 1;
+    struct iovec iov;
+    iov.iov_base = &c;
+    iov.iov_len = 1;
+    ASSERT_EQUALS(1L, static_cast<long>(writer->writev(&iov, 1)));
+    ASSERT_TRUE(!writer->needsWakeup());
+
+    // The reader may not park while there is data to read
+    ASSERT_TRUE(!reader->park());
+    ASSERT_TRUE(!writer->needsWakeup());
+    ASSERT_EQUALS(1L, static_cast<long>(reader->read(&c, 1)));
+
+    // A parked reader is woken up once
+    ASSERT_TRUE(reader->park());
+    ASSERT_EQUALS(1L, static_cast<long>(writer->writev(&iov, 1)));
+    ASSERT_TRUE(writer->needsWakeup());
+    ASSERT_EQUALS(1L, static_cast<long>(writer->writev(&iov, 1)));
+    ASSERT_TRUE(!writer->needsWakeup());
+    unsigned char out[2];
+    ASSERT_EQUALS(2L, static_cast<long>(reader->read(out, sizeof(out))));
+}
+
+void ShmRingTest::testClose()
+{
+    boost::scoped_ptr<ShmRing> writer(ShmRing::create(64));
+    boost::scoped_ptr<ShmRing> reader(ShmRing::attach(writer->name()));
+    writer->unlink();
+
+    // The segment is gone once unlinked: only the mapped ends remain
+    bool attached = true;
+    try {
+        boost::scoped_ptr<ShmRing> late(ShmRing::attach(writer->name()));
+    } catch (ShmRingException const&) {
+        attached = false;
+    }
+    ASSERT_TRUE(!attached);
+
+    // Writes to a closed ring fail as if it was full
+    unsigned char c = 1;
+    struct iovec iov;
+    iov.iov_base = &c;
+    iov.iov_len = 1;
+    reader->close();
+    ASSERT_EQUALS(0L, static_cast<long>(writer->writev(&iov, 1)));
+    ASSERT_TRUE(reader->empty());
+}
+
+void ShmRingTest::testWriterReader()
+{
+    int fds[2];
+    ASSERT_EQUALS(0, ::pipe(fds));
+
+    // A small ring, so that the writer often finds it full
+    boost::scoped_ptr<ShmRing> ring(ShmRing::create(1024));
+    boost::scoped_ptr<ShmRing> reader(ShmRing::attach(ring->name()));
+    ring->unlink();
+
+    RingWriter writer(*ring, fds[1], valueCount_);
+    writer.create();
+
+    uint64_t beginTime = TestUtils::getTimeMillis();
+    unsigned int parks = 0;
+    uint32_t expected = 0;
+    union
+    {
+        uint32_t values[64];
+        unsigned char bytes[64 * sizeof(uint32_t)];
+    } buf;
+    size_t pending = 0; // bytes of an incomplete value at the start of buf
+    while (expected < valueCount_) {
+        size_t n = reader->read(buf.bytes + pending, sizeof(buf) - pending);
+        if (n == 0) {
+            if (!reader->park()) {
+                continue;
+            }
+            parks++;
+
+            // A parked reader with data in the ring was not woken up
+            struct pollfd pfd;
+            pfd.fd = fds[0];
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            int rc = ::poll(&pfd, 1, 5000);
+            ASSERT_TRUE_MSG("lost wakeup at value " << expected, rc == 1);
+            char c;
+            ASSERT_EQUALS(1L, static_cast<long>(::read(fds[0], &c, 1)));
+            continue;
+        }
+        n += pending;
+        size_t count = n / sizeof(uint32_t);
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQUALS(expected, buf.values[i]);
+            expected++;
+        }
+        pending = n % sizeof(uint32_t);
+        memmove(buf.bytes, buf.bytes + count * sizeof(uint32_t), pending);
+    }
+    writer.join();
+    ASSERT_TRUE(reader->empty());
+    ASSERT_EQUALS(0L, static_cast<long>(pending));
+
+    // Each park gets a wakeup. A reader which finds data while parking may
+    // also get one, which it then reads as a spurious wakeup.
+    ASSERT_TRUE(parks <= writer.wakeups());
+    SPCDBG(L_INFO,
+           "Read " << valueCount_ << " values in " << (TestUtils::getTimeMillis() - beginTime)
+                   << " ms, " << parks << " wakeups",
+           DBG_ASP);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+MAIN_APP(Distillery::ShmRingTest)
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TestUtils.h"
+#include <SPL/Runtime/ProcessingElement/WorkStealingDeque.h>
+#include <UTILS/DistilleryApplication.h>
+#include <UTILS/Thread.h>
+#include <UTILS/UTILSTypes.h>
+
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+#define DBG_ASP "WorkStealingDequeTest"
+
+/**
+ * \file WorkStealingDequeTest.cpp
+ * Multi-threaded test for the work-stealing deque of the dynamic threading
+ * scheduler.
+ *
+ * The owner thread pushes all the items in rounds and pops some of them,
+ * down to the last element of the deque, while the thief threads keep
+ * stealing.  Every thread counts the items it takes; at the end each item
+ * must have been taken exactly once.
+ */
+
+namespace Distillery {
+
+class WorkStealingDequeTest : public DistilleryApplication
+{
+  public:
+    /// Default number of items pushed by the owner
+    static const unsigned int defaultItemCount = 10000000;
+    /// Default number of thief threads
+    static const unsigned int defaultThiefCount = 3;
+    /// Capacity of the deque
+    static const unsigned int capacity = 64;
+
+    WorkStealingDequeTest()
+      : itemCount_(defaultItemCount)
+      , thiefCount_(defaultThiefCount)
+      , ownerDone_(false)
+    {}
+
+    void getArguments(option_vector_t& options);
+    virtual int run(const std::vector<std::string>& /*remains*/);
+
+    void setItemCount(const option_t* option, int value)
+    {
+        if (value < 1) {
+            THROW(InvalidOption, "itemCount must be greater than 0");
+        }
+        itemCount_ = value;
+    }
+
+    void setThiefCount(const option_t* option, int value)
+    {
+        if (value < 1 || value > 64) {
+            THROW(InvalidOption, "thiefCount must be between 1 and 64");
+        }
+        thiefCount_ = value;
+    }
+
+    /// Push and pop items as the owner of the deque
+    void test_owner();
+
+    /// Steal items until the owner is done and the deque is empty
+    /// @param seed seed of the thief's pauses
+    void test_thief(unsigned int seed);
+
+  private:
+    /// Record that an item was taken
+    void take(unsigned int* item)
+    {
+        ASSERT_TRUE_MSG("item " << (item - items_.get()) << " out of range",
+                        item >= items_.get() && item < items_.get() + itemCount_);
+        taken_[*item].fetch_add(1, boost::memory_order_relaxed);
+    }
+
+    unsigned int itemCount_;
+    unsigned int thiefCount_;
+    SPL::WorkStealingDeque<unsigned int> deque_;
+    boost::scoped_array<unsigned int> items_;
+    boost::scoped_array<boost::atomic<uint32_t> > taken_;
+    boost::atomic<bool> ownerDone_;
+};
+
+/// The tester thread
+class TestWorker : public Thread
+{
+  public:
+    TestWorker(WorkStealingDequeTest& tester, bool owner, unsigned int seed)
+      : tester_(tester)
+      , owner_(owner)
+      , seed_(seed)
+    {}
+
+    void* run(void* /*args*/)
+    {
+        if (owner_) {
+            tester_.test_owner();
+        } else {
+            tester_.test_thief(seed_);
+        }
+        return 0;
+    }
+
+  private:
+    WorkStealingDequeTest& tester_;
+    const bool owner_;
+    const unsigned int seed_;
+};
+
+} // namespace Distillery
+
+///////////////////////////////////////////////////////////////////////////
+using namespace Distillery;
+
+void WorkStealingDequeTest::getArguments(option_vector_t& options)
+{
+    option_t args[] = {
+        { 'n', "itemCount", ARG, "", "Push the specified number of items (default 10000000)",
+          INT_OPT(WorkStealingDequeTest::setItemCount) },
+        { 't', "thiefCount", ARG, "", "Run the specified number of thief threads (default 3)",
+          INT_OPT(WorkStealingDequeTest::setThiefCount) },
+    };
+    APPEND_OPTIONS(options, args);
+}
+
+int WorkStealingDequeTest::run(const std::vector<std::string>&)
+{
+    SPCDBG(L_INFO,
+           "Testing WorkStealingDeque with itemCount=" << itemCount_
+                                                       << ", thiefCount=" << thiefCount_,
+           DBG_ASP);
+    uint64_t beginTime = TestUtils::getTimeMillis();
+
+    deque_.reserve(capacity);
+    items_.reset(new unsigned int[itemCount_]);
+    taken_.reset(new boost::atomic<uint32_t>[itemCount_]);
+    for (unsigned int i = 0; i < itemCount_; i++) {
+        items_[i] = i;
+        taken_[i].store(0, boost::memory_order_relaxed);
+    }
+
+    std::vector<TestWorker*> t;
+    t.push_back(new TestWorker(*this, true, 0));
+    for (unsigned int i = 0; i < thiefCount_; i++) {
+        t.push_back(new TestWorker(*this, false, i + 1));
+    }
+    for (size_t i = 0; i < t.size(); i++) {
+        t[i]->create();
+    }
+    for (size_t i = 0; i < t.size(); i++) {
+        t[i]->join();
+        delete t[i];
+    }
+
+    ASSERT_TRUE(deque_.empty());
+    for (unsigned int i = 0; i < itemCount_; i++) {
+        ASSERT_EQUALS_MSG("item " << i << " taken", 1U, taken_[i].load());
+    }
+
+    SPCDBG(L_INFO,
+           "Success! Test ran for " << (TestUtils::getTimeMillis() - beginTime) << " ms",
+           DBG_ASP);
+    return 0;
+}
+
+void WorkStealingDequeTest::test_owner()
+{
+    // Each round pushes up to half the capacity, pops some of it, pushes
+    // up to half the capacity again and pops until the deque is empty, so
+    // the deque never holds more than its capacity
+    unsigned int seed = 0;
+    unsigned int next = 0;
+    while (next < itemCount_) {
+        unsigned int pushes = rand_r(&seed) % (capacity / 2) + 1;
+        for (unsigned int i = 0; i < pushes && next < itemCount_; i++) {
+            deque_.push(&items_[next++]);
+        }
+        unsigned int pops = rand_r(&seed) % (pushes + 1);
+        for (unsigned int i = 0; i < pops; i++) {
+            unsigned int* item = deque_.pop();
+            if (item == NULL) {
+                break;
+            }
+            take(item);
+        }
+        pushes = rand_r(&seed) % (capacity / 2) + 1;
+        for (unsigned int i = 0; i < pushes && next < itemCount_; i++) {
+            deque_.push(&items_[next++]);
+        }
+        while (unsigned int* item = deque_.pop()) {
+            take(item);
+        }
+    }
+    ownerDone_.store(true);
+}
+
+void WorkStealingDequeTest::test_thief(unsigned int seed)
+{
+    while (true) {
+        // Read the owner's flag first: an empty deque after that is final
+        bool done = ownerDone_.load();
+        unsigned int* item = deque_.steal();
+        if (item != NULL) {
+            take(item);
+        } else if (done && deque_.empty()) {
+            break;
+        }
+
+        // Vary the timing against the owner
+        for (unsigned int i = rand_r(&seed) % 16; i > 0; i--) {
+            boost::atomic_thread_fence(boost::memory_order_relaxed);
+        }
+    }
+}
+
+MAIN_APP(Distillery::WorkStealingDequeTest)
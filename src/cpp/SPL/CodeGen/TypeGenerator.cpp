@@ -276,6 +276,12 @@ bool TypeGenerator::isFacade(TupleTyp const& tuple) const
             } break;
             case MetaType::BSTRING:
                 break;
+            case MetaType::OPTIONAL:
+                // Held as a member of the facade, next to its buffer
+                if (!isFacadeScalarType(bt.as<OptionalTyp>().getUnderlyingType())) {
+                    return false;
+                }
+                break;
             default:
                 return false;
         }
@@ -397,9 +403,10 @@ void TypeGenerator::buildModel(TupleTyp const& tuple, TupleModel& model)
         // set the attribute's SPL type
         attr->getSPLType() = type.getName();
 
-        // set the fixed size
+        // set the fixed size, which is the space in the facade buffer: optionals
+        // are not in the buffer
         if (facade) {
-            attr->setFixedSize(type.getFixedSize());
+            attr->setFixedSize(type.is<OptionalTyp>() ? 0 : type.getFixedSize());
         }
 
         model.getAttributes().push_back(attr);
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <SPL/Runtime/Common/LatencyHistogram.h>
+
+#include <SPL/Runtime/Common/RuntimeDebug.h>
+#include <UTILS/SupportFunctions.h>
+
+#include <cmath>
+#include <stdlib.h>
+#include <time.h>
+
+using namespace SPL;
+using namespace Distillery;
+using namespace std;
+
+// One item in 64 keeps the two clock reads well under 1% of the per-tuple cost
+static const uint32_t DefaultSamplingInterval = 64;
+
+__thread uint32_t LatencyHistogram::countdown_ = 0;
+
+static uint32_t configureSamplingInterval()
+{
+    string value = get_environment_variable("STREAMS_LATENCY_SAMPLING", "");
+    if (value.empty()) {
+        return DefaultSamplingInterval;
+    }
+    char* end;
+    unsigned long interval = strtoul(value.c_str(), &end, 10);
+    if (*end != '\0' || interval > UINT32_MAX) {
+        APPTRC(L_WARN,
+               "Invalid latency sampling interval '" << value << "', using "
+                                                     << DefaultSamplingInterval << " instead",
+               SPL_METRIC_DBG);
+        return DefaultSamplingInterval;
+    }
+    return interval;
+}
+
+static uint32_t samplingInterval()
+{
+    static const uint32_t interval = configureSamplingInterval();
+    return interval;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    for (uint32_t i = 0; i < numBuckets; ++i) {
+        counts_[i].store(0, boost::memory_order_relaxed);
+        prevCounts_[i].store(0, boost::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::rotate()
+{
+    // Values recorded concurrently land in either interval
+    for (uint32_t i = 0; i < numBuckets; ++i) {
+        prevCounts_[i].store(counts_[i].exchange(0, boost::memory_order_relaxed),
+                             boost::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::getCount() const
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < numBuckets; ++i) {
+        total += counts_[i].load(boost::memory_order_relaxed) +
+                 prevCounts_[i].load(boost::memory_order_relaxed);
+    }
+    return total;
+}
+
+int64_t LatencyHistogram::getPercentile(double quantile) const
+{
+    uint64_t counts[numBuckets];
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < numBuckets; ++i) {
+        counts[i] = counts_[i].load(boost::memory_order_relaxed) +
+                    prevCounts_[i].load(boost::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(ceil(quantile * total));
+    if (rank == 0) {
+        rank = 1;
+    } else if (rank > total) {
+        rank = total;
+    }
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < numBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return highestValueOf(i);
+        }
+    }
+    return highestValueOf(numBuckets - 1);
+}
+
+uint64_t LatencyHistogram::highestValueOf(uint32_t bucket)
+{
+    if (bucket < subBuckets) {
+        return bucket;
+    }
+    uint32_t shift = (bucket >> subBucketBits) - 1;
+    uint64_t lowest = static_cast<uint64_t>((bucket & (subBuckets - 1)) | subBuckets) << shift;
+    return lowest + (UINT64_C(1) << shift) - 1;
+}
+
+bool LatencyHistogram::isEnabled()
+{
+    return samplingInterval() != 0;
+}
+
+uint64_t LatencyHistogram::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+uint64_t LatencyHistogram::restartSample()
+{
+    uint32_t interval = samplingInterval();
+    if (interval == 0) {
+        countdown_ = UINT32_MAX;
+        return 0;
+    }
+    countdown_ = interval;
+    return now();
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_COMMON_LATENCY_HISTOGRAM_H
+#define SPL_RUNTIME_COMMON_LATENCY_HISTOGRAM_H
+
+#include <SPL/Runtime/Common/Prediction.h>
+#include <SPL/Runtime/Operator/Port/Inline.h>
+
+#include <boost/atomic/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <stdint.h>
+
+namespace SPL {
+/// Lock-free log-linear histogram of latencies, in nanoseconds.
+///
+/// Each power of two is split into subBuckets linear buckets (HdrHistogram
+/// style), so that a recorded value is reported with a relative error below
+/// 1/subBuckets. Values are counted in the current interval; rotate() starts
+/// a new interval, and percentiles are computed over the current and the
+/// previous intervals, like recentMaxItemsQueued.
+///
+/// Latencies are sampled: sampleStart() returns a start time for one call in
+/// STREAMS_LATENCY_SAMPLING (default 64) on each thread, and 0 otherwise.
+/// A sampling interval of 0 disables the measurements.
+class LatencyHistogram : private boost::noncopyable
+{
+  public:
+    /// Constructor
+    LatencyHistogram();
+
+    /// Record the time elapsed since a sample start
+    /// @param start value returned by sampleStart(), 0 if the item is not sampled
+    inline void recordSince(uint64_t start) ALWAYS_INLINE
+    {
+        if (UNLIKELY(start != 0)) {
+            record(now() - start);
+        }
+    }
+
+    /// Record a latency
+    /// @param nanos latency in nanoseconds
+    void record(uint64_t nanos)
+    {
+        counts_[bucketOf(nanos)].fetch_add(1, boost::memory_order_relaxed);
+    }
+
+    /// Start a new interval, forgetting the previous one
+    void rotate();
+
+    /// Compute a percentile over the current and previous intervals
+    /// @param quantile quantile in [0, 1], e.g. 0.99
+    /// @return the highest latency equivalent to the percentile, in
+    /// nanoseconds, or 0 if nothing was recorded
+    int64_t getPercentile(double quantile) const;
+
+    /// Get the number of latencies recorded in the current and previous intervals
+    uint64_t getCount() const;
+
+    /// Start a latency measurement on the calling thread
+    /// @return the current time if this item is sampled, 0 otherwise
+    static inline uint64_t sampleStart() ALWAYS_INLINE
+    {
+        if (LIKELY(countdown_ > 1)) {
+            --countdown_;
+            return 0;
+        }
+        return restartSample();
+    }
+
+    /// Check if latencies are measured
+    static bool isEnabled();
+
+    /// Get a monotonic time
+    /// @return time in nanoseconds
+    static uint64_t now();
+
+  private:
+    enum
+    {
+        subBucketBits = 4,
+        subBuckets = 1 << subBucketBits,
+        maxValueBits = 41, // about 36 minutes
+        numBuckets = (maxValueBits - subBucketBits + 1) * subBuckets
+    };
+
+    static inline uint32_t bucketOf(uint64_t nanos) ALWAYS_INLINE
+    {
+        if (nanos < subBuckets) {
+            return nanos;
+        }
+        if (UNLIKELY(nanos >> maxValueBits)) {
+            nanos = (UINT64_C(1) << maxValueBits) - 1;
+        }
+        uint32_t shift = (63 - __builtin_clzll(nanos)) - subBucketBits;
+        return (shift << subBucketBits) + (nanos >> shift);
+    }
+
+    static uint64_t highestValueOf(uint32_t bucket);
+    static uint64_t restartSample();
+
+    boost::atomic<uint64_t> counts_[numBuckets];
+    boost::atomic<uint64_t> prevCounts_[numBuckets];
+
+    static __thread uint32_t countdown_;
+};
+};
+
+#endif /* SPL_RUNTIME_COMMON_LATENCY_HISTOGRAM_H */
@@ -17,6 +17,7 @@
 #ifndef SPL_RUNTIME_COMMON_METRIC_IMPL_H
 #define SPL_RUNTIME_COMMON_METRIC_IMPL_H
 
+#include <SPL/Runtime/Common/LatencyHistogram.h>
 #include <SPL/Runtime/Common/Metric.h>
 #include <UTILS/SpinLock.h>
 #include <UTILS/ThreadTimingInfo.h>
@@ -321,6 +322,45 @@ class RecentMaxItemsQueuedSystemMetricImpl : public SystemMetricImpl
   private:
     int64_t* valuePrv_;
 };
+
+/// Class that represents a read-only system metric object
+/// for a percentile of a latency histogram.
+class LatencyPercentileSystemMetricImpl : public SystemMetricImpl
+{
+  public:
+    /// Constructor
+    /// @param myName metric name
+    /// @param myLongName metric long name
+    /// @param kind metric kind
+    /// @param value value pointer (unused, the value is computed from the histogram)
+    /// @param histogram latency histogram
+    /// @param quantile quantile reported by the metric, e.g. 0.99
+    LatencyPercentileSystemMetricImpl(std::string const& myName,
+                                      std::string const& myLongName,
+                                      Kind kind,
+                                      boost::atomic<int64_t>* value,
+                                      LatencyHistogram const* histogram,
+                                      double quantile)
+      : SystemMetricImpl(myName, myLongName, kind, value)
+      , histogram_(histogram)
+      , quantile_(quantile)
+    {}
+
+    /// Destructor
+    ~LatencyPercentileSystemMetricImpl() {}
+
+    /// Get the metric value
+    /// @return percentile of the current and previous interval latencies, in nanoseconds
+    int64_t getValue() const { return histogram_->getPercentile(quantile_); }
+
+    /// Get the metric value (without locking)
+    /// @return metric value
+    int64_t getValueNoLock() const { return getValue(); }
+
+  private:
+    LatencyHistogram const* histogram_;
+    double quantile_;
+};
 };
 
 #endif /* SPL_RUNTIME_COMMON_METRIC_IMPL_H */
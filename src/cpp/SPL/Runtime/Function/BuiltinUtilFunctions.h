@@ -613,7 +613,7 @@ SPL::rstring getEnvironmentVariable(SPL::rstring const& name, SPL::boolean& isSe
 /// @param name The name of the metric.
 /// @param value Value of the specified input port metric for the current operator.
 /// @throws SPLRuntimeInvalidIndexException If the port index is out of bounds.
-/// @splnative public stateful void getInputPortMetricValue(uint32 port, enum {nTuplesProcessed, nTuplesDropped, nTuplesQueued, nWindowPunctsProcessed, nFinalPunctsProcessed, nWindowPunctsQueued, nFinalPunctsQueued, queueSize, maxItemsQueued, recentMaxItemsQueued, recentMaxItemsQueuedInterval, nEnqueueWaits} name, mutable int64 value)
+/// @splnative public stateful void getInputPortMetricValue(uint32 port, enum {nTuplesProcessed, nTuplesDropped, nTuplesQueued, nWindowPunctsProcessed, nFinalPunctsProcessed, nWindowPunctsQueued, nFinalPunctsQueued, queueSize, maxItemsQueued, recentMaxItemsQueued, recentMaxItemsQueuedInterval, nEnqueueWaits, queueWaitTime, nDequeueBatches, queueLatencyP50, queueLatencyP99, queueLatencyP999, processLatencyP50, processLatencyP99, processLatencyP999} name, mutable int64 value)
 void getInputPortMetricValue(SPL::uint32 port, int name, SPL::int64& value);
 inline void getInputPortMetricValue(SPL::uint32 port, const SPL::Enum& name, SPL::int64& value)
 {
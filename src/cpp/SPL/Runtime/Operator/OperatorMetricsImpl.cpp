@@ -56,7 +56,7 @@ OperatorMetricsImpl::OperatorMetricsImpl(OperatorContextImpl& opctx, PEImpl& pe)
 
     // Check metric count
     assert(SystemMetricInfoFactory::getSystemMetricInfoCount(
-             SystemMetricInfoFactory::OperatorInputPort) == nEnqueueWaits + 1);
+             SystemMetricInfoFactory::OperatorInputPort) == processLatencyP999 + 1);
     assert(SystemMetricInfoFactory::getSystemMetricInfoCount(
              SystemMetricInfoFactory::OperatorOutputPort) == nFinalPunctsSubmitted + 1);
     assert(SystemMetricInfoFactory::getSystemMetricInfoCount(SystemMetricInfoFactory::Operator) ==
@@ -75,6 +75,14 @@ OperatorMetricsImpl::OperatorMetricsImpl(OperatorContextImpl& opctx, PEImpl& pe)
         createInputPortMetric(i, recentMaxItemsQueued, "recentMaxItemsQueued");
         createInputPortMetric(i, recentMaxItemsQueuedInterval, "recentMaxItemsQueuedInterval");
         createInputPortMetric(i, nEnqueueWaits, "nEnqueueWaits");
+        createInputPortMetric(i, queueWaitTime, "queueWaitTime");
+        createInputPortMetric(i, nDequeueBatches, "nDequeueBatches");
+        createInputPortMetric(i, queueLatencyP50, "queueLatencyP50");
+        createInputPortMetric(i, queueLatencyP99, "queueLatencyP99");
+        createInputPortMetric(i, queueLatencyP999, "queueLatencyP999");
+        createInputPortMetric(i, processLatencyP50, "processLatencyP50");
+        createInputPortMetric(i, processLatencyP99, "processLatencyP99");
+        createInputPortMetric(i, processLatencyP999, "processLatencyP999");
     }
 
     for (uint32_t i = 0; i < numOps; ++i) {
@@ -98,6 +106,7 @@ OperatorMetricsImpl::~OperatorMetricsImpl(void)
         delete systemMetrics_[i];
     }
     for (size_t i = 0, iu = inputMetrics_.size(); i < iu; ++i) {
+        dumpLatencyAtExit(i);
         for (size_t j = 0, ju = inputMetrics_[i].size(); j < ju; ++j) {
             dumpMetricAtExit(true, *inputMetrics_[i][j]);
             delete inputMetrics_[i][j];
@@ -131,6 +140,32 @@ void OperatorMetricsImpl::dumpMetricAtExit(bool isSystem, Metric& metric)
     }
 }
 
+void OperatorMetricsImpl::dumpLatencyAtExit(uint32_t port)
+{
+    // Standalone applications have no metrics service, log the latencies instead
+    if (!pe_.isStandalone()) {
+        return;
+    }
+    LatencyHistogram const& queue = inputMetricsRaw_[port].queueLatency_;
+    LatencyHistogram const& process = inputMetricsRaw_[port].processLatency_;
+    if (queue.getCount() > 0) {
+        APPTRC(L_INFO,
+               "Operator '" << opName_ << "' input port " << port
+                            << " queue latency (ns): p50=" << queue.getPercentile(0.5)
+                            << " p99=" << queue.getPercentile(0.99)
+                            << " p999=" << queue.getPercentile(0.999),
+               SPL_METRIC_DBG);
+    }
+    if (process.getCount() > 0) {
+        APPTRC(L_INFO,
+               "Operator '" << opName_ << "' input port " << port
+                            << " process latency (ns): p50=" << process.getPercentile(0.5)
+                            << " p99=" << process.getPercentile(0.99)
+                            << " p999=" << process.getPercentile(0.999),
+               SPL_METRIC_DBG);
+    }
+}
+
 void OperatorMetricsImpl::createInputPortMetric(uint32_t port,
                                                 InputPortMetricName name,
                                                 string const& shortName)
@@ -146,6 +181,8 @@ void OperatorMetricsImpl::createInputPortMetric(uint32_t port,
         m = createItemsQueuedMetric(port, name, shortName, longName, kind);
     } else if (name == recentMaxItemsQueued) {
         m = createRecentMaxItemsQueuedMetric(port, name, shortName, longName, kind);
+    } else if (name >= queueLatencyP50 && name <= processLatencyP999) {
+        m = createLatencyMetric(port, name, shortName, longName, kind);
     } else {
         m = createPortMetric(port, shortName, longName, kind, &(inputMetricsRaw_[port][name]));
     }
@@ -275,6 +312,50 @@ SystemMetricImpl* OperatorMetricsImpl::createRecentMaxItemsQueuedMetric(uint32_t
     return np;
 }
 
+SystemMetricImpl* OperatorMetricsImpl::createLatencyMetric(uint32_t port,
+                                                           InputPortMetricName name,
+                                                           string const& shortName,
+                                                           string const& longName,
+                                                           Metric::Kind kind)
+{
+    LatencyHistogram const* histogram;
+    double quantile;
+    switch (name) {
+        case queueLatencyP50:
+            histogram = &inputMetricsRaw_[port].queueLatency_;
+            quantile = 0.5;
+            break;
+        case queueLatencyP99:
+            histogram = &inputMetricsRaw_[port].queueLatency_;
+            quantile = 0.99;
+            break;
+        case queueLatencyP999:
+            histogram = &inputMetricsRaw_[port].queueLatency_;
+            quantile = 0.999;
+            break;
+        case processLatencyP50:
+            histogram = &inputMetricsRaw_[port].processLatency_;
+            quantile = 0.5;
+            break;
+        case processLatencyP99:
+            histogram = &inputMetricsRaw_[port].processLatency_;
+            quantile = 0.99;
+            break;
+        case processLatencyP999:
+            histogram = &inputMetricsRaw_[port].processLatency_;
+            quantile = 0.999;
+            break;
+        default:
+            assert(!"invalid metric name");
+            histogram = NULL;
+            quantile = 0;
+    }
+    SystemMetricImpl* np = new LatencyPercentileSystemMetricImpl(
+      shortName, makePortMetricDescription(port, longName), kind, &inputMetricsRaw_[port][name],
+      histogram, quantile);
+    return np;
+}
+
 #if 0
 SPL::MultiSamplePerfCounter * OperatorMetricsImpl::createPortProfMetric(uint32_t port,
                                                        string const & shortName,
@@ -367,6 +448,9 @@ void OperatorMetricsImpl::processIntervalMetrics(OperatorImpl const& op) const
 
     // input port metrics
     for (uint32_t i = 0; i < numIps; ++i) {
+        inputMetricsRaw_[i].queueLatency_.rotate();
+        inputMetricsRaw_[i].processLatency_.rotate();
+
         boolean hasQueue = (inputMetricsRaw_[i][queueSize].load(boost::memory_order_relaxed) > 0);
         if (!hasQueue) {
             continue;
@@ -17,6 +17,7 @@
 #ifndef SPL_RUNTIME_OPERATOR_OPERATOR_METRICS_IMPL_H
 #define SPL_RUNTIME_OPERATOR_OPERATOR_METRICS_IMPL_H
 
+#include <SPL/Runtime/Common/LatencyHistogram.h>
 #include <SPL/Runtime/Common/MetricImpl.h>
 #include <SPL/Runtime/Common/Prediction.h>
 #include <SPL/Runtime/Common/RuntimeDebug.h>
@@ -239,8 +240,34 @@ class OperatorMetricsImpl : public OperatorMetrics
         }
     }
 
+    /// Set the time the port thread waited for items to be queued.
+    /// Not thread safe.
+    /// @param port input port index
+    /// @param millis total time waited, in milliseconds
+    inline void setQueueWaitTimeNoLock(uint32_t port, int64_t millis)
+    {
+        inputMetricsRaw_[port][queueWaitTime].store(millis, boost::memory_order_relaxed);
+    }
+
+    /// Record the time an item spent queued on an input port.
+    /// @param port input port index
+    /// @param start time the item was queued, from LatencyHistogram::sampleStart()
+    inline void recordQueueLatency(uint32_t port, uint64_t start) ALWAYS_INLINE
+    {
+        inputMetricsRaw_[port].queueLatency_.recordSince(start);
+    }
+
     /* END: Input port queue counters */
 
+    /// Record the time spent processing a tuple received by an input port.
+    /// This includes the operators downstream of the port on the same thread.
+    /// @param port input port index
+    /// @param start time the processing started, from LatencyHistogram::sampleStart()
+    inline void recordProcessLatency(uint32_t port, uint64_t start) ALWAYS_INLINE
+    {
+        inputMetricsRaw_[port].processLatency_.recordSince(start);
+    }
+
     /// Update receive counters (when profiling is off)
     /// @pre isProfiling() == false
     /// @param type type of the item being received
@@ -333,7 +360,7 @@ class OperatorMetricsImpl : public OperatorMetrics
   private:
     enum
     {
-        numInputPortMetrics = 12
+        numInputPortMetrics = 20
     };
     enum
     {
@@ -374,8 +401,14 @@ class OperatorMetricsImpl : public OperatorMetrics
                                                        std::string const& shortName,
                                                        std::string const& longName,
                                                        Metric::Kind kind);
+    SystemMetricImpl* createLatencyMetric(uint32_t port,
+                                          InputPortMetricName name,
+                                          std::string const& shortName,
+                                          std::string const& longName,
+                                          Metric::Kind kind);
     uint32_t getIntervalMetricsPeriod() const; // interval in seconds
     void dumpMetricAtExit(bool isSystem, Metric& metric);
+    void dumpLatencyAtExit(uint32_t port);
 
     // PE/operator hosting this operator
     std::string opName_;
@@ -404,6 +437,9 @@ class OperatorMetricsImpl : public OperatorMetrics
         boost::atomic<int64_t> nFinalPunctsDequeued_;
         boost::atomic<int64_t> nTuplesEnqueued_ __attribute__((aligned(PADDING)));
         boost::atomic<int64_t> nTuplesDequeued_ __attribute__((aligned(PADDING)));
+        // Sampled latencies, reported as percentiles
+        LatencyHistogram queueLatency_;
+        LatencyHistogram processLatency_;
     } __attribute__((aligned(PADDING)));
     struct OutputPortMetricBlock
     {
@@ -19,11 +19,48 @@
 #include <SPL/Runtime/Operator/OperatorImpl.h>
 #include <SPL/Runtime/Operator/Port/Punctuation.h>
 #include <SPL/Runtime/ProcessingElement/PEImpl.h>
+#include <SPL/Runtime/Utility/BackoffSpinner.h>
+#include <UTILS/SupportFunctions.h>
+
+#include <stdlib.h>
 
 using namespace Distillery;
 using namespace SPL;
 using namespace std;
 
+// Largest pause count of the spin phase: the counts double from 1, so the
+// phase executes about twice as many pause instructions
+static const uint32_t MaxSpinPause = 1024;
+// Number of pthread_yield() calls of the Adaptive strategy before blocking
+static const uint32_t MaxYields = 64;
+static const uint32_t DefaultBatchSize = 32;
+
+static ActiveQueue::WaitStrategy configureWaitStrategy()
+{
+    string value = get_environment_variable("STREAMS_THREADED_PORT_WAIT_STRATEGY", "");
+    if (value.empty() || value == "park") {
+        return ActiveQueue::Park;
+    } else if (value == "spin") {
+        return ActiveQueue::Spin;
+    } else if (value == "adaptive") {
+        return ActiveQueue::Adaptive;
+    }
+    APPTRC(L_WARN,
+           "Unknown threaded port wait strategy '" << value << "', using 'park' instead",
+           SPL_PE_DBG);
+    return ActiveQueue::Park;
+}
+
+static uint32_t configureBatchSize(uint32_t maxSize)
+{
+    string value = get_environment_variable("STREAMS_THREADED_PORT_BATCH_SIZE", "");
+    unsigned long size = value.empty() ? DefaultBatchSize : strtoul(value.c_str(), NULL, 10);
+    if (size == 0) {
+        return 1;
+    }
+    return size < maxSize ? size : maxSize;
+}
+
 ActiveQueue::ActiveQueue(OperatorImpl& oper,
                          uint32_t index,
                          CongestionPolicy congestionMode,
@@ -33,6 +70,9 @@ ActiveQueue::ActiveQueue(OperatorImpl& oper,
   , congestionMode_(congestionMode)
   , maxSize_(maxSize ? maxSize : 1)
   , singleThreadedOnInput_(singleThreadedOnInput)
+  , waitStrategy_(configureWaitStrategy())
+  , batchSize_(configureBatchSize(maxSize_))
+  , waitTime_(0)
   , currentSize_(0)
   , prodWait_(false)
   , isShutdown_(false)
@@ -134,7 +174,7 @@ void* ActiveQueue::run(void* threadArgs)
             while (
               LIKELY(!(isShutdown_.load(boost::memory_order_acquire) ||
                        (isDraining_.load(boost::memory_order_acquire) && queueLF_->empty())))) {
-                popOneForWait();
+                popBatchForWait();
             }
         } else {
             while (LIKELY(!(isShutdown_.load(boost::memory_order_acquire) ||
@@ -159,6 +199,73 @@ void* ActiveQueue::run(void* threadArgs)
     return NULL;
 }
 
+bool ActiveQueue::spinUntil(bool (ActiveQueue::*ready)() const)
+{
+    for (uint32_t count = 1; count <= MaxSpinPause; count *= 2) {
+        BackoffSpinner::pause(count);
+        if ((this->*ready)()) {
+            return true;
+        }
+    }
+    if (waitStrategy_ == Adaptive && BackoffSpinner::getYieldBehaviour() == BackoffSpinner::No) {
+        for (uint32_t i = 0; i < MaxYields; ++i) {
+            pthread_yield();
+            if ((this->*ready)()) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool ActiveQueue::waitForItems()
+{
+    uint64_t start = getTimeInMicrosecs();
+    bool ready = waitStrategy_ != Park && spinUntil(&ActiveQueue::hasItems);
+    if (!ready) {
+        Distillery::AutoMutex am(mutexCons_);
+        long ns = 100;
+        timespec delay;
+        delay.tv_sec = 0;
+        ready = true;
+        while (queueLF_->empty()) {
+            delay.tv_nsec = ns;
+            consCV_.waitFor(mutexCons_, delay);
+            if (ns < 10000000) {
+                ns *= 10;
+            }
+            if (UNLIKELY(isShutdown_.load(boost::memory_order_acquire) ||
+                         isDraining_.load(boost::memory_order_acquire))) {
+                ready = false;
+                break;
+            }
+        }
+    }
+    waitTime_ += getTimeInMicrosecs() - start;
+    operMetric_.setQueueWaitTimeNoLock(index_, waitTime_ / 1000);
+    return ready;
+}
+
+bool ActiveQueue::waitForRoom(size_t& queueLength)
+{
+    if (waitStrategy_ != Park && spinUntil(&ActiveQueue::hasRoom)) {
+        queueLF_->full(&queueLength);
+        return true;
+    }
+    timespec delay = { 0, 100000000 }; // 0.1 sec timeout
+    Distillery::AutoMutex am(mutexProd_);
+    prodWait_.store(true, boost::memory_order_relaxed);
+    while (queueLF_->full(&queueLength)) {
+        if (UNLIKELY(isShutdown_.load(boost::memory_order_acquire))) {
+            prodWait_.store(false, boost::memory_order_relaxed);
+            return false;
+        }
+        prodCV_.waitFor(mutexProd_, delay);
+    }
+    prodWait_.store(false, boost::memory_order_relaxed);
+    return true;
+}
+
 void ActiveQueue::popOneForDropFirst()
 {
     Data item;
@@ -175,6 +282,7 @@ void ActiveQueue::popOneForDropFirst()
         item = *queue_.begin();
         --currentSize_;
         updateMetricsInPop(item);
+        operMetric_.recordQueueLatency(index_, item.getEnqueueTime());
         queue_.pop_front();
 
         if (currentSize_ == maxSize_ - 1) {
@@ -225,6 +333,7 @@ void ActiveQueue::pushOneForDropFirst(Data& item)
     } else { // also make a copy
         item.setPunctuation(*(new Punctuation(item.getPunctuation())));
     }
+    item.setEnqueueTime(LatencyHistogram::sampleStart());
     queue_.push_back(item);
     if (currentSize_ == 1) {
         consCV_.signal();
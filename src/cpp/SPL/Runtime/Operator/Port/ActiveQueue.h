@@ -50,6 +50,16 @@ class ActiveQueue
         DropLast
     };
 
+    /// How the port thread waits for items, and the producers for room, in
+    /// the Wait and DropLast congestion modes. Set for the whole PE with the
+    /// STREAMS_THREADED_PORT_WAIT_STRATEGY environment variable.
+    enum WaitStrategy
+    {
+        Park,    //!< block on a condition variable right away
+        Spin,    //!< spin with exponential backoff, then block
+        Adaptive //!< spin, then yield the processor, then block
+    };
+
     /// Constructor
     /// @param oper operator that holds this port
     /// @param index index of the port
@@ -68,6 +78,14 @@ class ActiveQueue
     /// @return max queue size
     uint32_t getMaxQueueSize() const { return maxSize_; }
 
+    /// Get the wait strategy
+    /// @return wait strategy
+    WaitStrategy getWaitStrategy() const { return waitStrategy_; }
+
+    /// Get the largest number of items the port thread dequeues per wakeup
+    /// @return batch size
+    uint32_t getBatchSize() const { return batchSize_; }
+
     /// Submit a tuple on this port
     /// @param tuple tuple to submit
     void submit(Tuple& tuple)
@@ -126,17 +144,9 @@ class ActiveQueue
             // Always have to wait for punctuations
             if (queueLF_->full(&queueLength)) {
                 operMetric_.incrementQueueCounterNoLock(index_, OperatorMetrics::nEnqueueWaits);
-                timespec delay = { 0, 100000000 }; // 0.1 sec timeout
-                Distillery::AutoMutex am(mutexProd_);
-                prodWait_.store(true, boost::memory_order_relaxed);
-                while (queueLF_->full(&queueLength)) {
-                    if (UNLIKELY(isShutdown_.load(boost::memory_order_acquire))) {
-                        prodWait_.store(false, boost::memory_order_relaxed);
-                        return;
-                    }
-                    prodCV_.waitFor(mutexProd_, delay);
+                if (!waitForRoom(queueLength)) {
+                    return;
                 }
-                prodWait_.store(false, boost::memory_order_relaxed);
             }
         } else if (queueLF_->full(&queueLength)) { // DropLast and full (and isTuple())
             operMetric_.incrementQueueCounterNoLock(index_, OperatorMetrics::nTuplesDropped);
@@ -154,6 +164,7 @@ class ActiveQueue
             Punctuation& ref = rearItem.getPunctuation();
             ref = item.getPunctuation();
         }
+        rearItem.setEnqueueTime(LatencyHistogram::sampleStart());
 
         updateMetricsInPush(item, (int64_t)queueLength + 1);
         bool wasEmpty = queueLF_->empty();
@@ -193,41 +204,40 @@ class ActiveQueue
         }
     }
 
-    inline bool popOneForWait() ALWAYS_INLINE
+    inline bool popBatchForWait() ALWAYS_INLINE
     {
-        if (queueLF_->empty()) {
-            Distillery::AutoMutex am(mutexCons_);
-            long ns = 100;
-            timespec delay;
-            delay.tv_sec = 0;
-            while (queueLF_->empty()) {
-                delay.tv_nsec = ns;
-                consCV_.waitFor(mutexCons_, delay);
-                if (ns < 10000000) {
-                    ns *= 10;
-                }
-                if (UNLIKELY(isShutdown_.load(boost::memory_order_acquire) ||
-                             isDraining_.load(boost::memory_order_acquire))) {
-                    return false;
-                }
-            }
+        if (queueLF_->empty() && !waitForItems()) {
+            return false;
         }
+        operMetric_.incrementQueueCounterNoLock(index_, OperatorMetrics::nDequeueBatches);
 
-        Data& item = queueLF_->front();
-        if (LIKELY(item.isTuple())) {
-            signal_->submit(item.getTuple());
-            item.getTuple().clear();
-        } else {
-            assert(item.getPunctuation().getValue() != Punctuation::Invalid);
-            signal_->submit(item.getPunctuation());
-        }
+        size_t len;
+        bool empty;
+        uint32_t count = 0;
+        do {
+            Data& item = queueLF_->front();
+            operMetric_.recordQueueLatency(index_, item.getEnqueueTime());
+            if (LIKELY(item.isTuple())) {
+                signal_->submit(item.getTuple());
+                item.getTuple().clear();
+            } else {
+                assert(item.getPunctuation().getValue() != Punctuation::Invalid);
+                signal_->submit(item.getPunctuation());
+            }
 
-        updateMetricsInPop(item);
-        queueLF_->pop_front();
+            updateMetricsInPop(item);
+            queueLF_->pop_front();
+            empty = queueLF_->empty(&len);
 
-        size_t len;
-        if (queueLF_->empty(&len) ||
-            (prodWait_.load(boost::memory_order_relaxed) && len < maxSize_ / 2)) {
+            // A waiting producer must not wait for the end of the batch
+            if (!empty && prodWait_.load(boost::memory_order_relaxed) && len < maxSize_ / 2) {
+                Distillery::AutoMutex am(mutexProd_);
+                prodCV_.signal();
+            }
+        } while (!empty && ++count < batchSize_ &&
+                 LIKELY(!isShutdown_.load(boost::memory_order_acquire)));
+
+        if (empty) {
             Distillery::AutoMutex am(mutexProd_);
             prodCV_.signal();
         }
@@ -262,6 +272,12 @@ class ActiveQueue
         }
     }
 
+    bool hasItems() const { return !queueLF_->empty(); }
+    bool hasRoom() const { return !queueLF_->full(); }
+    bool spinUntil(bool (ActiveQueue::*ready)() const);
+    bool waitForItems();
+    bool waitForRoom(size_t& queueLength);
+
     void popOneForDropFirst();
     void pushOneForDropFirst(Data& item);
     bool dropTupleFromQueue();
@@ -275,6 +291,9 @@ class ActiveQueue
     CongestionPolicy const congestionMode_;
     uint32_t const maxSize_;
     bool const singleThreadedOnInput_;
+    WaitStrategy const waitStrategy_;
+    uint32_t const batchSize_;
+    uint64_t waitTime_; // microseconds, port thread only
     uint32_t currentSize_;
     boost::atomic<bool> prodWait_;
     boost::atomic<bool> isShutdown_;
@@ -34,14 +34,17 @@ class Data
       : tuple_(NULL)
       , punct_(NULL)
       , type_(Invalid)
+      , enqueueTime_(0)
     {}
     Data(SPL::Tuple& tuple)
       : tuple_(&tuple)
       , type_(Tuple)
+      , enqueueTime_(0)
     {}
     Data(Punctuation& punct)
       : punct_(&punct)
       , type_(Punct)
+      , enqueueTime_(0)
     {}
 
     Type getType() const
@@ -86,10 +89,16 @@ class Data
 
     void setPunctuation(Punctuation& punct) { punct_ = &punct; }
 
+    /// Time the item was queued, 0 if its queue latency is not sampled
+    uint64_t getEnqueueTime() const { return enqueueTime_; }
+
+    void setEnqueueTime(uint64_t time) { enqueueTime_ = time; }
+
   private:
     SPL::Tuple* tuple_;
     SPL::Punctuation* punct_;
     Type type_;
+    uint64_t enqueueTime_;
 };
 }
 
@@ -80,7 +80,9 @@ class ProcessSignal : public DirectPortSignal
 
         // update metric to this receiver
         operMetric_.updateReceiveCounters(SPL::OperatorMetricsImpl::TUPLE, index_);
+        uint64_t start = LatencyHistogram::sampleStart();
         submitInternalNoProfile(buffer);
+        operMetric_.recordProcessLatency(index_, start);
         OperatorTracker::resetCurrentOperator();
     }
 
@@ -99,7 +101,9 @@ class ProcessSignal : public DirectPortSignal
 
         // update metric to this receiver
         operMetric_.updateReceiveCounters(SPL::OperatorMetricsImpl::TUPLE, index_);
+        uint64_t start = LatencyHistogram::sampleStart();
         submitInternalNoProfile(tuple);
+        operMetric_.recordProcessLatency(index_, start);
         OperatorTracker::resetCurrentOperator();
     }
 
@@ -76,17 +76,9 @@ class AttributeHash : public SplitterAlgorithm
   private:
     uint64_t hashTuple(const Tuple& tuple)
     {
-        if (attributes_.size() == 1) {
-            return tuple.getAttributeValue(attributes_[0]).hashCode();
-        } else {
-            // technique for combining hashes (must match the one in generated
-            // tuple code what can be found in the codegen template tuple_h.cgt)
-            uint64_t hash = 17;
-            for (size_t i = 0; i < attributes_.size(); ++i) {
-                hash = 37 * hash + tuple.getAttributeValue(attributes_[i]).hashCode();
-            }
-            return hash;
-        }
+        // Generated tuple types hash the attributes directly, rather than
+        // through value handles, with the same hash values
+        return tuple.hashAttributes(&attributes_[0], attributes_.size());
     }
 
     const std::vector<uint32_t> attributes_;
@@ -636,6 +636,11 @@ void PEImpl::initialize(PEModel& pemod, PlatformAdapter& platform)
         threadPool_.reset(new FixedThreadPool(100 /* queue size */, 2 /* workers */));
     }
 
+    uint32_t windowTimerThreads = WindowTimerService::getConfiguredThreads();
+    if (windowTimerThreads > 0) {
+        windowTimerService_.reset(new WindowTimerService(windowTimerThreads));
+    }
+
     if (isStandalone_ == false && (isCheckpointing_ == true || isInConsistentRegion_ == true)) {
         CheckpointContextImpl::initialize();
     }
@@ -1523,6 +1528,7 @@ void PEImpl::processIntervalMetrics()
         OperatorImpl const& oper = **oit;
         oper.getContextImpl().getMetricsImpl().processIntervalMetrics(oper);
     }
+    peMetric_->processIntervalMetrics();
 }
 
 uint32_t PEImpl::getIntervalMetricsPeriod()
@@ -1576,6 +1582,7 @@ void PEImpl::process()
         autoMetricsIntervalTimer_->initialize();
 
         startScheduledQueue();
+        startWindowTimerService();
         startProfilingThread();
 
         waitForConnections();
@@ -1834,6 +1841,9 @@ void PEImpl::joinWindowThreads()
     for (oit = operators_.begin(); oit != operators_.end(); ++oit) {
         (*oit)->joinWindowThreads();
     }
+    if (windowTimerService_.get() != NULL) {
+        windowTimerService_->joinThreads();
+    }
     APPTRC(L_DEBUG, "Joined all window threads", SPL_PE_DBG);
 }
 
@@ -1851,6 +1861,13 @@ void PEImpl::joinScheduledQueue()
     }
 }
 
+void PEImpl::startWindowTimerService()
+{
+    if (windowTimerService_.get() != NULL) {
+        windowTimerService_->start();
+    }
+}
+
 void PEImpl::startProfilingThread()
 {
     APPTRC(L_INFO, "Starting profiling thread", SPL_PE_DBG);
@@ -1978,6 +1995,9 @@ void PEImpl::shutdown(bool isJobShuttingDown)
     if (threadPool_.get() != NULL) {
         threadPool_->shutdown();
     }
+    if (windowTimerService_.get() != NULL) {
+        windowTimerService_->shutdown();
+    }
     if (scheduledQueue_.get() != NULL) {
         scheduledQueue_->shutdown();
     }
@@ -42,6 +42,7 @@
 #include <SPL/Runtime/Utility/Singleton.h>
 #include <SPL/Runtime/Utility/Thread.h>
 #include <SPL/Runtime/Utility/Visibility.h>
+#include <SPL/Runtime/Window/WindowTimerService.h>
 #include <TRANS/ConnectionState.h>
 #include <TRANS/DataReceiver.h>
 #include <TRANS/DataSender.h>
@@ -573,7 +574,9 @@ class DLL_PUBLIC PEImpl
           pmark ? PEMetricsImpl::UpdateType(pmark) : PEMetricsImpl::TUPLE;
         peMetric_->updateReceiveCounters(type, udata.u64, size);
         try {
+            uint64_t start = LatencyHistogram::sampleStart();
             receiveMessage(msg, size, udata.u64);
+            peMetric_->recordDeliverLatency(udata.u64, start);
         } catch (SPLRuntimeShutdownException const& e) {
             std::string const& opName = getOperatorName(OperatorTracker::getCurrentOperator());
             // This exception is benign, so logging in INFO level
@@ -641,7 +644,13 @@ class DLL_PUBLIC PEImpl
                     inputPortToOperPort_[port]->submit(buffer);
                 } else {
                     Tuple& tuple = *iportTuples_[port];
-                    tuple.deserialize(buffer);
+                    // The message outlives the submit: wide tuples decode
+                    // their attributes from it when they are first accessed
+                    if (debug) {
+                        tuple.deserialize(buffer);
+                    } else {
+                        tuple.deserializeInPlace(buffer);
+                    }
                     tuple.setPayloadContainer(payload);
                     inputPortToOperPort_[port]->submit(tuple);
                 }
@@ -987,6 +996,10 @@ class DLL_PUBLIC PEImpl
             } else {
                 sender.write(data, size, alwaysRetryAfterReconnect, resetReconnectionState);
             }
+            // Punctuations are window and progress boundaries: don't hold them back
+            if (pmark) {
+                sender.flush();
+            }
             if (needsMutex) {
                 op->getMutex().unlock();
             }
@@ -1094,6 +1107,7 @@ class DLL_PUBLIC PEImpl
     void joinActiveQueues();
     void startScheduledQueue();
     void joinScheduledQueue();
+    void startWindowTimerService();
     void startProfilingThread();
     void stopProfilingThread();
     void joinProfilingThread();
@@ -1261,6 +1275,10 @@ class DLL_PUBLIC PEImpl
     /// @return handle to thread pool
     UTILS_NAMESPACE::FixedThreadPool* getThreadPool() { return threadPool_.get(); }
 
+    /// Get the timer service shared by the time-based windows
+    /// @return the window timer service, NULL if every window runs its own threads
+    WindowTimerService* getWindowTimerService() { return windowTimerService_.get(); }
+
     // TODO this seems to duplicate getPEModel above.
     PEModel const* getModel() const { return peModel_; }
 
@@ -1507,6 +1525,10 @@ class DLL_PUBLIC PEImpl
     // Consistent Region Controller
     std::auto_ptr<UTILS_NAMESPACE::FixedThreadPool> threadPool_;
 
+    // Timer service for the trigger and eviction policies of time-based
+    // windows, NULL unless STREAMS_WINDOW_TIMER_THREADS is set
+    std::auto_ptr<WindowTimerService> windowTimerService_;
+
     // Indicates if the exception should be rethrown when it has
     // a @catch annotation
     bool mustRethrowException_;
@@ -45,7 +45,7 @@ PEMetricsImpl::PEMetricsImpl(PEImpl& pe)
 
     // Check metric count
     assert(SystemMetricInfoFactory::getSystemMetricInfoCount(
-             SystemMetricInfoFactory::PEInputPort) == nFinalPunctsProcessed + 1);
+             SystemMetricInfoFactory::PEInputPort) == deliverLatencyP999 + 1);
     assert(SystemMetricInfoFactory::getSystemMetricInfoCount(
              SystemMetricInfoFactory::PEOutputPort) == nConnections + 1);
     // input port metrics
@@ -54,6 +54,9 @@ PEMetricsImpl::PEMetricsImpl(PEImpl& pe)
         createInputPortMetric(i, nTupleBytesProcessed, "nTupleBytesProcessed");
         createInputPortMetric(i, nWindowPunctsProcessed, "nWindowPunctsProcessed");
         createInputPortMetric(i, nFinalPunctsProcessed, "nFinalPunctsProcessed");
+        createInputPortMetric(i, deliverLatencyP50, "deliverLatencyP50");
+        createInputPortMetric(i, deliverLatencyP99, "deliverLatencyP99");
+        createInputPortMetric(i, deliverLatencyP999, "deliverLatencyP999");
     }
 
     // output port metrics
@@ -111,8 +114,12 @@ void PEMetricsImpl::createInputPortMetric(uint32_t port,
     assert((InputPortMetricName)mi.getIndex() == name);
     const string& longName = mi.getDescription();
     Metric::Kind kind = mi.getKind();
-    SystemMetricImpl* m =
-      createPortMetric(port, shortName, longName, kind, &(inputMetricsRaw_[port][name]));
+    SystemMetricImpl* m;
+    if (name >= deliverLatencyP50 && name <= deliverLatencyP999) {
+        m = createLatencyMetric(port, name, shortName, longName, kind);
+    } else {
+        m = createPortMetric(port, shortName, longName, kind, &(inputMetricsRaw_[port][name]));
+    }
     if (inputMetrics_.size() == port) {
         inputMetrics_.push_back(vector<SystemMetricImpl*>());
     }
@@ -151,6 +158,36 @@ SystemMetricImpl* PEMetricsImpl::createPortMetric(uint32_t port,
     return np;
 }
 
+SystemMetricImpl* PEMetricsImpl::createLatencyMetric(uint32_t port,
+                                                     InputPortMetricName name,
+                                                     string const& shortName,
+                                                     string const& longName,
+                                                     Metric::Kind kind)
+{
+    double quantile;
+    if (name == deliverLatencyP50) {
+        quantile = 0.5;
+    } else if (name == deliverLatencyP99) {
+        quantile = 0.99;
+    } else {
+        quantile = 0.999;
+    }
+    stringstream strLong;
+    strLong.imbue(locale::classic());
+    strLong << longName << " (port " << port << ")";
+    SystemMetricImpl* np = new LatencyPercentileSystemMetricImpl(
+      shortName, strLong.str(), kind, &(inputMetricsRaw_[port][name]),
+      &inputMetricsRaw_[port].deliverLatency_, quantile);
+    return np;
+}
+
+void PEMetricsImpl::processIntervalMetrics()
+{
+    for (size_t i = 0, iu = inputMetrics_.size(); i < iu; ++i) {
+        inputMetricsRaw_[i].deliverLatency_.rotate();
+    }
+}
+
 /// Fill in system PE metrics data (PE ports)
 void PEMetricsImpl::getMetrics(PEMetricsInfo& peMetrics) const
 {
@@ -160,10 +197,9 @@ void PEMetricsImpl::getMetrics(PEMetricsInfo& peMetrics) const
     // input port metrics
     for (uint32_t i = 0; i < numIps; ++i) {
         APPTRC(L_TRACE, "Get input port metric" << i, SPL_METRIC_DBG);
-        InputPortMetricBlock& m = inputMetricsRaw_[i];
         PortMetricsInfo pmi(i);
         for (uint32_t j = 0; j < numInputPortMetrics; j++) {
-            pmi.addMetrics(m[j]);
+            pmi.addMetrics(inputMetrics_[i][j]->getValue());
         }
         peMetrics.addInputPortMetrics(pmi);
     }
@@ -199,6 +235,22 @@ void PEMetricsImpl::getMetrics(PEMetricsInfo& peMetrics) const
                 }
             }
             opm.push_back(nTuplesFilteredOut);
+            // Transport batching
+            opm.push_back(cf.nBatchesFlushed);
+            opm.push_back(cf.nMessagesBatched);
+            opm.push_back(cf.nFlushesOnSize);
+            opm.push_back(cf.nFlushesOnDeadline);
+            opm.push_back(cf.nFlushesOnPunct);
+            // Asynchronous writes
+            opm.push_back(cf.nMessagesQueued);
+            opm.push_back(cf.nMessagesDropped);
+            // Compression: bytes submitted, bytes saved, ratio (percent), CPU time
+            opm.push_back(cf.nBytesBeforeCompression);
+            opm.push_back(cf.nBytesBeforeCompression - cf.nBytesAfterCompression);
+            opm.push_back(cf.nBytesBeforeCompression > 0
+                            ? 100 * cf.nBytesAfterCompression / cf.nBytesBeforeCompression
+                            : 100);
+            opm.push_back(cf.compressionTime);
             pmi.addConnectionMetric(cf.receiverPEId, cf.receiverPortId, opm);
         }
         peMetrics.addOutputPortMetrics(pmi);
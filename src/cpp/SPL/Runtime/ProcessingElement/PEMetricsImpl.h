@@ -17,6 +17,7 @@
 #ifndef SPL_RUNTIME_PROCESSING_ELEMENT_PE_METRICS_IMPL_H
 #define SPL_RUNTIME_PROCESSING_ELEMENT_PE_METRICS_IMPL_H
 
+#include <SPL/Runtime/Common/LatencyHistogram.h>
 #include <SPL/Runtime/Common/MetricImpl.h>
 #include <SPL/Runtime/Common/RuntimeDebug.h>
 #include <SPL/Runtime/Common/RuntimeException.h>
@@ -149,6 +150,14 @@ class PEMetricsImpl : public PEMetrics
         }
     }
 
+    // Record the time to deliver a received message to the operators
+    // @param port index of the input port that received the message
+    // @param start time the delivery started, from LatencyHistogram::sampleStart()
+    inline void recordDeliverLatency(uint32_t port, uint64_t start)
+    {
+        inputMetricsRaw_[port].deliverLatency_.recordSince(start);
+    }
+
     // Update send counters
     // @param type type of the item being sent
     // @param port index of the output port that received data
@@ -217,6 +226,9 @@ class PEMetricsImpl : public PEMetrics
     /// @pre peMetrics is newly constructed, and thus empty
     void getMetrics(PEMetricsInfo& peMetrics) const;
 
+    /// Process PE metrics that are based on a time interval
+    void processIntervalMetrics();
+
     // Update connection counters
     // @param metric metric to be updated
     // @param port index of the output port to be updated
@@ -231,7 +243,7 @@ class PEMetricsImpl : public PEMetrics
   private:
     enum
     {
-        numInputPortMetrics = 4
+        numInputPortMetrics = 7
     };
     enum
     {
@@ -249,6 +261,11 @@ class PEMetricsImpl : public PEMetrics
                                        std::string const& longName,
                                        Metric::Kind kind,
                                        boost::atomic<int64_t>* value);
+    SystemMetricImpl* createLatencyMetric(uint32_t port,
+                                          PEMetrics::InputPortMetricName name,
+                                          std::string const& shortName,
+                                          std::string const& longName,
+                                          Metric::Kind kind);
     void dumpMetricAtExit(Metric& metric);
 
     PEImpl& pe_;
@@ -262,6 +279,8 @@ class PEMetricsImpl : public PEMetrics
     {
         boost::atomic<int64_t> metrics_[numInputPortMetrics];
         boost::atomic<int64_t>& operator[](size_t i) { return metrics_[i]; }
+        // Sampled delivery latencies, reported as percentiles
+        LatencyHistogram deliverLatency_;
     };
     struct OutputPortMetricBlock
     {
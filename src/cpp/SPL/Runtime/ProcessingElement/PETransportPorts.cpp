@@ -333,6 +333,20 @@ PETransportIPortCollection::PETransportIPortCollection(PEImpl& pe)
     }
 }
 
+bool PETransportIPortCollection::isSingleThreadedOnInputs(uint64_t operInstanceIndex) const
+{
+    using namespace xmlns::prod::streams::application;
+    const operInstancesType::operInstance_sequence& ops =
+      pe_->getPEModel().operInstances().operInstance();
+    operInstancesType::operInstance_const_iterator it;
+    for (it = ops.begin(); it != ops.end(); it++) {
+        if (it->index() == operInstanceIndex) {
+            return it->singleThreadedOnInputs();
+        }
+    }
+    return true;
+}
+
 void PETransportIPortCollection::open()
 {
     APPTRC(L_DEBUG, "PE input ports are being open...", SPL_PE_DBG);
@@ -371,6 +385,8 @@ void PETransportIPortCollection::open()
             pd.operator_ns_label = StrDup(operator_endpoint.c_str());
             pd.callback = pe_;
             pd.user_data.u64 = i++;
+            pd.singleThreaded =
+              isSingleThreadedOnInputs(ip->operInstanceConnection().operInstanceIndex());
             /*
              * Prepare the recipient list.
              */
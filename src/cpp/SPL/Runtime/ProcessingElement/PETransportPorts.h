@@ -281,6 +281,10 @@ class PETransportIPortCollection : public std::vector<PETransportIPort*>
     void getStaticConnectionLabels(std::vector<std::string>& labels) const;
 
   private:
+    /// Is the operator fed by a PE input port single threaded on its inputs?
+    /// @param operInstanceIndex application model index of the operator
+    bool isSingleThreadedOnInputs(uint64_t operInstanceIndex) const;
+
     volatile bool isOpen_;
     volatile bool isShutdown_;
     mutable Distillery::CV statusCV_;
@@ -64,6 +64,7 @@ class ScheduledData
             Punctuation& punct = _data.getPunctuation();
             punct = other._data.getPunctuation();
         }
+        _data.setEnqueueTime(LatencyHistogram::sampleStart());
     }
 
     void incrementQueueCounter(int64_t queueLength)
@@ -97,6 +98,8 @@ class ScheduledData
         }
     }
 
+    void recordQueueLatency() { _opMetric->recordQueueLatency(_opIndex, _data.getEnqueueTime()); }
+
     void incrementWaitCounter()
     {
         _opMetric->incrementQueueCounterNoLock(_opIndex, OperatorMetrics::nEnqueueWaits);
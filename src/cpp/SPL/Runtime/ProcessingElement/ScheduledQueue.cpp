@@ -17,18 +17,110 @@
 #include <SPL/Runtime/Operator/OperatorTracker.h>
 #include <SPL/Runtime/ProcessingElement/PEImpl.h>
 #include <SPL/Runtime/ProcessingElement/ScheduledQueue.h>
-
+#include <UTILS/SupportFunctions.h>
+
+#include <dirent.h>
+#include <fstream>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+using namespace Distillery;
 using namespace SPL;
 
 const long ScheduledQueue::ONE_MILLISECOND = 1000000;
 const uint32_t ScheduledQueue::queueSize = 1000;
+// A scheduler thread checks the inject queue before its own deque every so many rounds, so
+// that ports made runnable by source and PE input port threads are not starved
+const uint32_t ScheduledQueue::injectPollInterval = 61;
 const int64_t ADAPT_PERIOD = 10;
 const double THRESHOLD = 0.05;
 namespace SPL {
 __thread bool isDraining = false;
 }
+
+static bool configureStealing()
+{
+    std::string value = get_environment_variable("STREAMS_DYNAMIC_THREADING_SCHEDULER", "");
+    if (value.empty() || value == "shared") {
+        return false;
+    } else if (value == "stealing") {
+        return true;
+    }
+    APPTRC(L_WARN, "Unknown dynamic threading scheduler '" << value << "', using 'shared' instead",
+           SPL_PE_DBG);
+    return false;
+}
+
+static bool configureNumaPlacement()
+{
+    return get_environment_variable("STREAMS_DYNAMIC_THREADING_NUMA", "on") != "off";
+}
+
+// Read the CPUs of each NUMA node from sysfs, restricted to the CPUs the PE may run on.
+// Nodes without any such CPU are left out.
+static void readNumaNodes(std::vector<cpu_set_t>& nodes)
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return;
+    }
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (dir == NULL) {
+        return;
+    }
+    std::set<int> ids;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        int id;
+        if (sscanf(entry->d_name, "node%d", &id) == 1) {
+            ids.insert(id);
+        }
+    }
+    closedir(dir);
+
+    for (std::set<int>::const_iterator it = ids.begin(); it != ids.end(); ++it) {
+        std::ostringstream path;
+        path << "/sys/devices/system/node/node" << *it << "/cpulist";
+        std::ifstream in(path.str().c_str());
+        std::string list;
+        if (!std::getline(in, list)) {
+            continue;
+        }
+        // the list looks like "0-3,8-11"
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        const char* p = list.c_str();
+        while (true) {
+            char* end;
+            unsigned long first = strtoul(p, &end, 10);
+            if (end == p) {
+                break;
+            }
+            unsigned long last = first;
+            if (*end == '-') {
+                p = end + 1;
+                last = strtoul(p, &end, 10);
+            }
+            for (unsigned long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    CPU_SET(cpu, &cpus);
+                }
+            }
+            if (*end != ',') {
+                break;
+            }
+            p = end + 1;
+        }
+        if (CPU_COUNT(&cpus) > 0) {
+            nodes.push_back(cpus);
+        }
+    }
+}
+
 ScheduledQueue::ScheduleThread::ScheduleThread()
   : _suspended(false)
   , _suspendable(true)
@@ -36,6 +128,11 @@ ScheduledQueue::ScheduleThread::ScheduleThread()
   , _shutdown(false)
   , _allPortsClosed(false)
   , _active(false)
+  , _idle(false)
+  , _notified(false)
+  , _node(0)
+  , _cpus(NULL)
+  , _seed(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this) >> 4) | 1)
 {}
 ScheduledQueue::ScheduleThread::~ScheduleThread() {}
 
@@ -45,6 +142,15 @@ void* ScheduledQueue::ScheduleThread::run(void* threadArgs)
 
     OperatorTracker::init();
 
+    if (_cpus != NULL) {
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), _cpus);
+        if (rc != 0) {
+            APPTRC(L_WARN,
+                   "Unable to bind dynamic thread to NUMA node " << _node << ": " << strerror(rc),
+                   SPL_PE_DBG);
+        }
+    }
+
     ScheduledQueue* q = reinterpret_cast<ScheduledQueue*>(threadArgs);
     q->registerThread(this);
     try {
@@ -83,10 +189,20 @@ void ScheduledQueue::ScheduleThread::suspend()
 void ScheduledQueue::ScheduleThread::block(long ns)
 {
     Distillery::AutoMutex am(_mutex);
-    timespec delay;
-    delay.tv_sec = 0;
-    delay.tv_nsec = ns;
-    _cv.waitFor(_mutex, delay);
+    if (!_notified) {
+        timespec delay;
+        delay.tv_sec = 0;
+        delay.tv_nsec = ns;
+        _cv.waitFor(_mutex, delay);
+    }
+    _notified = false;
+}
+
+void ScheduledQueue::ScheduleThread::notifyWork()
+{
+    Distillery::AutoMutex am(_mutex);
+    _notified = true;
+    _cv.signal();
 }
 
 void ScheduledQueue::ScheduleThread::notifySuspended()
@@ -176,6 +292,9 @@ ScheduledQueue::ScheduledQueue(uint32_t minThreads,
   , _prevNTuples(0)
   , _portAdapter(NULL)
   , _adaptCount(0)
+  , _stealing(configureStealing())
+  , _workers(NULL)
+  , _idleWorkers(0)
 {
     APPTRC(L_TRACE, "ScheduledQueue instantiation", SPL_PE_DBG);
 
@@ -212,6 +331,19 @@ ScheduledQueue::ScheduledQueue(uint32_t minThreads,
         _threads.push_back(new ScheduleThread());
     }
 
+    if (_stealing) {
+        if (configureNumaPlacement()) {
+            readNumaNodes(_nodeCPUs);
+            if (_nodeCPUs.size() < 2) {
+                _nodeCPUs.clear();
+            }
+        }
+        APPTRC(L_INFO,
+               "ScheduledQueue using the work-stealing scheduler, threads placed on "
+                 << _nodeCPUs.size() << " NUMA nodes",
+               SPL_PE_DBG);
+    }
+
     if (adaptOn) {
         queueClosureProcessed = queueClosureRequested = 0;
         _adjustingQueueInProgress = true;
@@ -288,6 +420,9 @@ ScheduledQueue::~ScheduledQueue()
     if (_freePorts != NULL) {
         delete _freePorts;
     }
+    for (size_t i = 0; i < _workerSnapshots.size(); ++i) {
+        delete _workerSnapshots[i];
+    }
     if (_portAdapter != NULL) {
         delete _portAdapter;
     }
@@ -302,8 +437,16 @@ void ScheduledQueue::start()
            SPL_PE_DBG);
     _freePorts = new boost::lockfree::queue<ProcessSignal*, boost::lockfree::fixed_sized<true> >(
       _startupFreePorts.size());
-    for (size_t i = 0; i < _startupFreePorts.size(); ++i) {
-        _freePorts->push(_startupFreePorts[i]);
+    if (_stealing) {
+        // the free ports queue becomes the inject queue, holding only runnable ports
+        for (size_t i = 0; i < _threads.size(); ++i) {
+            initWorker(_threads[i], i);
+        }
+        publishWorkers();
+    } else {
+        for (size_t i = 0; i < _startupFreePorts.size(); ++i) {
+            _freePorts->push(_startupFreePorts[i]);
+        }
     }
     _startupFreePorts.clear();
 
@@ -322,9 +465,32 @@ void ScheduledQueue::createNewThread()
     Distillery::AutoMutex am(_cvMutex);
     APPTRC(L_DEBUG, "ScheduledQueue starting a new thread", SPL_PE_DBG);
     _threads.push_back(new ScheduleThread());
+    if (_stealing) {
+        initWorker(_threads.back(), _threads.size() - 1);
+        publishWorkers();
+    }
     _threads.back()->create(NULL, false, this);
 }
 
+void ScheduledQueue::initWorker(ScheduleThread* thread, uint32_t index)
+{
+    // each port is in at most one deque at a time, so a deque never holds more than all ports
+    thread->deque().reserve(_queues.size());
+    if (!_nodeCPUs.empty()) {
+        uint32_t node = index % _nodeCPUs.size();
+        thread->place(node, &_nodeCPUs[node]);
+    }
+}
+
+// Called before start or with _cvMutex acquired. Thieves may still be reading the previous
+// list, so all the lists are kept until destruction.
+void ScheduledQueue::publishWorkers()
+{
+    std::vector<ScheduleThread*>* workers = new std::vector<ScheduleThread*>(_threads);
+    _workerSnapshots.push_back(workers);
+    _workers.store(workers, boost::memory_order_release);
+}
+
 void ScheduledQueue::createNewThreads(uint32_t toCreate)
 {
     for (size_t i = 0; i < toCreate; ++i) {
@@ -464,48 +630,52 @@ void ScheduledQueue::schedule(const boost::atomic<bool>& suspended,
 {
     APPTRC(L_DEBUG, "ScheduledQueue thread starting", SPL_PE_DBG);
 
-    ScheduledData data;
     uint64_t processed = 0;
-    /*
-     * When returning true, the SPSCEnforcer consumer is locked.
-     */
-    while (findWorkBlocking(data, suspended, localShutdown, localAllPortsClosed, active)) {
-        ProcessSignal* port = data.port();
-        if (port->shouldSkipScheduledPort() && port->tryDrain()) {
-            execute(data);
-            ++processed;
-
-            SPSCEnforcer* mq = _queues[data.port()->getQueueIndex()];
-            uint32_t localProcessed = 0;
-            while (mq->front(data)) {
+    if (_stealing) {
+        processed = scheduleStealing(suspended, localShutdown, localAllPortsClosed, active);
+    } else {
+        ScheduledData data;
+        /*
+         * When returning true, the SPSCEnforcer consumer is locked.
+         */
+        while (findWorkBlocking(data, suspended, localShutdown, localAllPortsClosed, active)) {
+            ProcessSignal* port = data.port();
+            if (port->shouldSkipScheduledPort() && port->tryDrain()) {
                 execute(data);
                 ++processed;
-                ++localProcessed;
-                if (localProcessed > queueSize || suspended || localShutdown ||
-                    localAllPortsClosed) {
-                    break;
-                }
-            }
-            queueClosureProcessed++;
-            freePort(data.port());
-            port->completeDrain();
-        } else {
-            execute(data);
-            ++processed;
 
-            SPSCEnforcer* mq = _queues[data.port()->getQueueIndex()];
-            uint32_t localProcessed = 0;
-            while (mq->front(data)) {
+                SPSCEnforcer* mq = _queues[data.port()->getQueueIndex()];
+                uint32_t localProcessed = 0;
+                while (mq->front(data)) {
+                    execute(data);
+                    ++processed;
+                    ++localProcessed;
+                    if (localProcessed > queueSize || suspended || localShutdown ||
+                        localAllPortsClosed) {
+                        break;
+                    }
+                }
+                queueClosureProcessed++;
+                freePort(data.port());
+                port->completeDrain();
+            } else {
                 execute(data);
                 ++processed;
-                ++localProcessed;
-                if (localProcessed > queueSize || suspended || localShutdown ||
-                    localAllPortsClosed) {
-                    break;
+
+                SPSCEnforcer* mq = _queues[data.port()->getQueueIndex()];
+                uint32_t localProcessed = 0;
+                while (mq->front(data)) {
+                    execute(data);
+                    ++processed;
+                    ++localProcessed;
+                    if (localProcessed > queueSize || suspended || localShutdown ||
+                        localAllPortsClosed) {
+                        break;
+                    }
                 }
-            }
 
-            freePort(data.port());
+                freePort(data.port());
+            }
         }
     }
 
@@ -521,6 +691,190 @@ void ScheduledQueue::schedule(const boost::atomic<bool>& suspended,
     APPTRC(L_DEBUG, reason.str(), SPL_PE_DBG);
 }
 
+uint64_t ScheduledQueue::scheduleStealing(const boost::atomic<bool>& suspended,
+                                          const boost::atomic<bool>& localShutdown,
+                                          const boost::atomic<bool>& localAllPortsClosed,
+                                          boost::atomic<bool>& active)
+{
+    ScheduleThread& self = *_thisThread;
+    ScheduledData data;
+    uint64_t processed = 0;
+    uint32_t round = 0;
+    long nsDelay = 1;
+    while (!localShutdown.load(boost::memory_order_acquire) &&
+           !localAllPortsClosed.load(boost::memory_order_acquire)) {
+        if (suspended.load(boost::memory_order_acquire)) {
+            flushRunnablePorts(self);
+            self.suspend();
+        }
+        active.store(true, boost::memory_order_release);
+
+        ProcessSignal* port = findRunnablePort(self, ++round);
+        if (port == NULL) {
+            port = waitForRunnablePort(self, nsDelay);
+            if (nsDelay < 100 * ONE_MILLISECOND) {
+                nsDelay *= 10;
+            }
+            if (port == NULL) {
+                continue;
+            }
+        }
+        SPSCEnforcer* mq = _queues[port->getQueueIndex()];
+        if (!mq->tryLockConsumer()) {
+            // a blocked producer is consuming the queue itself; the port stays runnable
+            injectPort(port);
+            self.block(nsDelay);
+            if (nsDelay < 100 * ONE_MILLISECOND) {
+                nsDelay *= 10;
+            }
+            continue;
+        }
+        nsDelay = 1;
+
+        if (port->shouldSkipScheduledPort() && port->tryDrain()) {
+            processed += executeBatch(mq, data, suspended, localShutdown, localAllPortsClosed);
+            queueClosureProcessed++;
+            releaseRunnablePort(self, port, mq);
+            port->completeDrain();
+        } else {
+            processed += executeBatch(mq, data, suspended, localShutdown, localAllPortsClosed);
+            releaseRunnablePort(self, port, mq);
+        }
+    }
+    return processed;
+}
+
+ProcessSignal* ScheduledQueue::findRunnablePort(ScheduleThread& self, uint32_t round)
+{
+    ProcessSignal* port = NULL;
+    if (round % injectPollInterval == 0 && _freePorts->pop(port)) {
+        return port;
+    }
+    port = self.deque().pop();
+    if (port != NULL) {
+        return port;
+    }
+    if (_freePorts->pop(port)) {
+        return port;
+    }
+    return stealRunnablePort(self);
+}
+
+ProcessSignal* ScheduledQueue::stealRunnablePort(ScheduleThread& self)
+{
+    const std::vector<ScheduleThread*>& workers = *_workers.load(boost::memory_order_acquire);
+    size_t n = workers.size();
+    if (n < 2) {
+        return NULL;
+    }
+    // victims on the same NUMA node first, starting from a random one
+    size_t start = self.nextRandom() % n;
+    uint32_t passes = _nodeCPUs.empty() ? 1 : 2;
+    for (uint32_t pass = 0; pass < passes; ++pass) {
+        for (size_t i = 0; i < n; ++i) {
+            ScheduleThread* victim = workers[(start + i) % n];
+            if (victim == &self) {
+                continue;
+            }
+            if (passes == 2 && (victim->node() == self.node()) != (pass == 0)) {
+                continue;
+            }
+            ProcessSignal* port = victim->deque().steal();
+            if (port != NULL) {
+                return port;
+            }
+        }
+    }
+    return NULL;
+}
+
+ProcessSignal* ScheduledQueue::waitForRunnablePort(ScheduleThread& self, long nsDelay)
+{
+    // Advertise the thread as idle before the last look for work: a producer enqueueing a port
+    // after that look sees the idle thread and wakes it up
+    self.setIdle(true);
+    _idleWorkers.fetch_add(1, boost::memory_order_seq_cst);
+    ProcessSignal* port = findRunnablePort(self, 0);
+    if (port == NULL) {
+        self.block(nsDelay);
+    }
+    _idleWorkers.fetch_sub(1, boost::memory_order_relaxed);
+    self.setIdle(false);
+    return port;
+}
+
+uint32_t ScheduledQueue::executeBatch(SPSCEnforcer* mq,
+                                      ScheduledData& data,
+                                      const boost::atomic<bool>& suspended,
+                                      const boost::atomic<bool>& localShutdown,
+                                      const boost::atomic<bool>& localAllPortsClosed)
+{
+    uint32_t localProcessed = 0;
+    while (mq->front(data)) {
+        execute(data);
+        ++localProcessed;
+        if (localProcessed > queueSize || suspended || localShutdown || localAllPortsClosed) {
+            break;
+        }
+    }
+    return localProcessed;
+}
+
+void ScheduledQueue::releaseRunnablePort(ScheduleThread& self,
+                                         ProcessSignal* port,
+                                         SPSCEnforcer* mq)
+{
+    mq->unLockConsumer();
+    if (mq->hasItems()) {
+        // the batch limit was hit: keep the token and let the other runnable ports go first
+        injectPort(port);
+        signalWork();
+        return;
+    }
+    mq->clearRunnable();
+    // a producer may have pushed after the queue was found empty, while the token was still
+    // taken
+    if (mq->hasItems() && mq->markRunnable()) {
+        self.deque().push(port);
+    }
+}
+
+void ScheduledQueue::flushRunnablePorts(ScheduleThread& self)
+{
+    ProcessSignal* port;
+    bool flushed = false;
+    while ((port = self.deque().pop()) != NULL) {
+        injectPort(port);
+        flushed = true;
+    }
+    if (flushed) {
+        signalWork();
+    }
+}
+
+// Make a port which was just turned off runnable, so that a scheduler thread drains it
+void ScheduledQueue::scheduleDrain(ProcessSignal* port)
+{
+    if (_stealing && _queues[port->getQueueIndex()]->markRunnable()) {
+        injectPort(port);
+        signalWork();
+    }
+}
+
+void ScheduledQueue::wakeIdleWorker()
+{
+    const std::vector<ScheduleThread*>* workers = _workers.load(boost::memory_order_acquire);
+    if (workers == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < workers->size(); ++i) {
+        if ((*workers)[i]->claimIdle()) {
+            (*workers)[i]->notifyWork();
+            return;
+        }
+    }
+}
+
 void ScheduledQueue::adapt()
 {
     if (_globalIsShutdown || _globalAllPortsClosed) {
@@ -797,6 +1151,7 @@ void ScheduledQueue::turnOffScheduledPort(std::vector<uint32_t>& operators, std:
                                     changed++;
                                     queueClosureRequested++;
                                     scq->unLockConsumer();
+                                    scheduleDrain(it->second[j]);
                                 }
                                 scq->unLockProducer();
                             }
@@ -869,6 +1224,7 @@ void ScheduledQueue::turnOffScheduledPort(std::set<uint32_t>& operators)
                                     changed++;
                                     queueClosureRequested++;
                                     scq->unLockConsumer();
+                                    scheduleDrain(it->second[j]);
                                 }
                                 scq->unLockProducer();
                             }
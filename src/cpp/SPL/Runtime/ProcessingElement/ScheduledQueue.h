@@ -24,6 +24,7 @@
 #include <SPL/Runtime/ProcessingElement/ElasticThreadAdapter.h>
 #include <SPL/Runtime/ProcessingElement/ProcessingElement.h>
 #include <SPL/Runtime/ProcessingElement/ScheduledData.h>
+#include <SPL/Runtime/ProcessingElement/WorkStealingDeque.h>
 #include <SPL/Runtime/Type/Tuple.h>
 #include <SPL/Runtime/Utility/Thread.h>
 #include <SPL/Runtime/Utility/Visibility.h>
@@ -38,6 +39,7 @@
 
 #include <list>
 #include <map>
+#include <sched.h>
 #include <set>
 #include <vector>
 
@@ -70,11 +72,16 @@ class ScheduledQueue
 
     void push(ScheduledData& data)
     {
-        SPSCEnforcer* mq = _queues[data.port()->getQueueIndex()];
+        ProcessSignal* port = data.port();
+        SPSCEnforcer* mq = _queues[port->getQueueIndex()];
 
         if (!mq->push(data)) {
             reSchedule(mq, data);
         }
+        // In work-stealing mode, the first producer to find the port idle makes it runnable
+        if (_stealing && !port->shouldSkipScheduledPort() && mq->markRunnable()) {
+            enqueueRunnable(port);
+        }
     }
 
     void turnOnScheduledPort(std::vector<uint32_t>& operators, std::pair<int, int>& p);
@@ -166,6 +173,7 @@ class ScheduledQueue
         ProcessSignal* port = schedData.port();
         Data& data = schedData.data();
 
+        schedData.recordQueueLatency();
         if (data.isTuple()) {
             port->submit(data.getTuple());
             data.getTuple().clear();
@@ -265,6 +273,55 @@ class ScheduledQueue
         return false;
     }
 
+    // Work-stealing mode: every port with queued work is held, exactly once, by a scheduler
+    // thread deque or by the inject queue (_freePorts). The thread which pops or steals the port
+    // then processes it under the consumer lock, which keeps the ordering of the port queue.
+    uint64_t scheduleStealing(const boost::atomic<bool>& suspended,
+                              const boost::atomic<bool>& shutdown,
+                              const boost::atomic<bool>& allPortsClosed,
+                              boost::atomic<bool>& active);
+    ProcessSignal* findRunnablePort(ScheduleThread& self, uint32_t round);
+    ProcessSignal* stealRunnablePort(ScheduleThread& self);
+    ProcessSignal* waitForRunnablePort(ScheduleThread& self, long nsDelay);
+    uint32_t executeBatch(SPSCEnforcer* mq,
+                          ScheduledData& data,
+                          const boost::atomic<bool>& suspended,
+                          const boost::atomic<bool>& shutdown,
+                          const boost::atomic<bool>& allPortsClosed);
+    void releaseRunnablePort(ScheduleThread& self, ProcessSignal* port, SPSCEnforcer* mq);
+    void flushRunnablePorts(ScheduleThread& self);
+    void scheduleDrain(ProcessSignal* port);
+    void initWorker(ScheduleThread* thread, uint32_t index);
+    void publishWorkers();
+    void wakeIdleWorker();
+
+    void enqueueRunnable(ProcessSignal* port)
+    {
+        ScheduleThread* self = _thisThread.get();
+        if (self != NULL) {
+            // downstream work of a scheduler thread stays on that thread, while it is hot
+            self->deque().push(port);
+        } else {
+            injectPort(port);
+        }
+        signalWork();
+    }
+
+    void injectPort(ProcessSignal* port)
+    {
+        while (!_freePorts->bounded_push(port)) {
+        }
+    }
+
+    void signalWork()
+    {
+        // pairs with the idle count increment in waitForRunnablePort
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+        if (_idleWorkers.load(boost::memory_order_relaxed) > 0) {
+            wakeIdleWorker();
+        }
+    }
+
     void queueElasticity(double& throughput);
     void threadElasticity(double& throughput);
     void validatePerformance(double& throughput);
@@ -363,6 +420,36 @@ class ScheduledQueue
 
         void resetActive() { _active.store(false, boost::memory_order_release); }
 
+        // work-stealing mode
+        void notifyWork();
+
+        WorkStealingDeque<ProcessSignal>& deque() { return _deque; }
+
+        void place(uint32_t node, const cpu_set_t* cpus)
+        {
+            _node = node;
+            _cpus = cpus;
+        }
+
+        uint32_t node() const { return _node; }
+
+        void setIdle(bool idle) { _idle.store(idle, boost::memory_order_seq_cst); }
+
+        bool claimIdle()
+        {
+            bool expected = true;
+            return _idle.load(boost::memory_order_relaxed) &&
+                   _idle.compare_exchange_strong(expected, false);
+        }
+
+        uint32_t nextRandom()
+        {
+            _seed ^= _seed << 13;
+            _seed ^= _seed >> 17;
+            _seed ^= _seed << 5;
+            return _seed;
+        }
+
       private:
         // for graceful thread suspension
         Distillery::Mutex _mutex;
@@ -375,6 +462,14 @@ class ScheduledQueue
         boost::atomic<bool> _shutdown;
         boost::atomic<bool> _allPortsClosed;
         boost::atomic<bool> _active;
+
+        // work-stealing mode
+        WorkStealingDeque<ProcessSignal> _deque;
+        boost::atomic<bool> _idle;
+        bool _notified; // only accessed when _mutex is acquired
+        uint32_t _node;
+        const cpu_set_t* _cpus;
+        uint32_t _seed;
     };
 
     class SPSCEnforcer
@@ -384,16 +479,19 @@ class ScheduledQueue
           : _queue(NULL)
           , _producerLocked(false)
           , _consumerLocked(false)
+          , _runnable(false)
         {}
         SPSCEnforcer(CircularQueue<ScheduledData>* q)
           : _queue(q)
           , _producerLocked(false)
           , _consumerLocked(false)
+          , _runnable(false)
         {}
         SPSCEnforcer(const SPSCEnforcer& other)
           : _queue(other._queue)
           , _producerLocked(other._producerLocked.load())
           , _consumerLocked(other._consumerLocked.load())
+          , _runnable(other._runnable.load())
         {}
 
         bool push(ScheduledData& data)
@@ -460,6 +558,23 @@ class ScheduledQueue
 
         void unLockProducer() { _producerLocked.store(false, boost::memory_order_release); }
 
+        // Take the runnable token of the port; the caller must then enqueue the port
+        bool markRunnable()
+        {
+            return !_runnable.load(boost::memory_order_relaxed) &&
+                   !_runnable.exchange(true, boost::memory_order_seq_cst);
+        }
+
+        // Give back the runnable token; the caller must check hasItems() afterwards, since
+        // producers which saw the token taken did not enqueue the port
+        void clearRunnable()
+        {
+            _runnable.store(false, boost::memory_order_seq_cst);
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+        }
+
+        bool hasItems() const { return !_queue->empty(); }
+
         // We can't make this the destructor because we copy these objects into vectors
         void freeQueue() { delete _queue; }
 
@@ -467,6 +582,7 @@ class ScheduledQueue
         CircularQueue<ScheduledData>* _queue;
         boost::atomic<bool> _producerLocked;
         boost::atomic<bool> _consumerLocked;
+        boost::atomic<bool> _runnable;
     };
 
     std::vector<SPSCEnforcer*> _queues;
@@ -510,6 +626,14 @@ class ScheduledQueue
 
     boost::atomic<int> queueClosureRequested;
     boost::atomic<int> queueClosureProcessed;
+
+    // work-stealing mode
+    bool _stealing;
+    std::vector<cpu_set_t> _nodeCPUs; // allowed CPUs of each NUMA node, empty if only one
+    boost::atomic<std::vector<ScheduleThread*>*> _workers; // thread list seen by thieves
+    std::vector<std::vector<ScheduleThread*>*> _workerSnapshots;
+    boost::atomic<uint32_t> _idleWorkers;
+    static const uint32_t injectPollInterval;
 };
 }
 
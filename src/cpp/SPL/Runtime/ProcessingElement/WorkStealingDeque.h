@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_PROCESSING_ELEMENT_WORK_STEALING_DEQUE_H
+#define SPL_RUNTIME_PROCESSING_ELEMENT_WORK_STEALING_DEQUE_H
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+
+#include <cassert>
+#include <stdint.h>
+
+namespace SPL {
+/// Chase-Lev work-stealing deque of pointers (Le, Pop, Cohen, Zappa Nardelli,
+/// "Correct and Efficient Work-Stealing for Weak Memory Models", PPoPP 2013).
+/// The owner thread pushes and pops at the bottom; other threads steal from
+/// the top. The capacity is fixed: the caller guarantees that the deque
+/// never holds more than capacity elements.
+template<typename T>
+class WorkStealingDeque : private boost::noncopyable
+{
+  public:
+    WorkStealingDeque()
+      : _top(0)
+      , _bottom(0)
+      , _mask(0)
+    {}
+
+    /// Allocate the deque storage; must be called before any other operation
+    /// @param capacity maximum number of elements, rounded up to a power of 2
+    void reserve(uint32_t capacity)
+    {
+        uint32_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _buffer.reset(new boost::atomic<T*>[size]);
+        _mask = size - 1;
+    }
+
+    /// Push an element at the bottom (owner only)
+    void push(T* item)
+    {
+        int64_t b = _bottom.load(boost::memory_order_relaxed);
+        assert(b - _top.load(boost::memory_order_relaxed) <= static_cast<int64_t>(_mask));
+        _buffer[b & _mask].store(item, boost::memory_order_relaxed);
+        boost::atomic_thread_fence(boost::memory_order_release);
+        _bottom.store(b + 1, boost::memory_order_relaxed);
+    }
+
+    /// Pop the element at the bottom (owner only)
+    /// @return the element, NULL if the deque is empty
+    T* pop()
+    {
+        int64_t b = _bottom.load(boost::memory_order_relaxed) - 1;
+        _bottom.store(b, boost::memory_order_relaxed);
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+        int64_t t = _top.load(boost::memory_order_relaxed);
+        if (t > b) {
+            _bottom.store(b + 1, boost::memory_order_relaxed);
+            return NULL;
+        }
+        T* item = _buffer[b & _mask].load(boost::memory_order_relaxed);
+        if (t == b) {
+            // Last element: race against the thieves
+            if (!_top.compare_exchange_strong(t, t + 1, boost::memory_order_seq_cst,
+                                              boost::memory_order_relaxed)) {
+                item = NULL;
+            }
+            _bottom.store(b + 1, boost::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /// Steal the element at the top (any thread)
+    /// @return the element, NULL if the deque is empty or another thread won the race
+    T* steal()
+    {
+        int64_t t = _top.load(boost::memory_order_acquire);
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+        int64_t b = _bottom.load(boost::memory_order_acquire);
+        if (t >= b) {
+            return NULL;
+        }
+        T* item = _buffer[t & _mask].load(boost::memory_order_relaxed);
+        if (!_top.compare_exchange_strong(t, t + 1, boost::memory_order_seq_cst,
+                                          boost::memory_order_relaxed)) {
+            return NULL;
+        }
+        return item;
+    }
+
+    /// Check if the deque looks empty (any thread)
+    bool empty() const
+    {
+        return _bottom.load(boost::memory_order_relaxed) <= _top.load(boost::memory_order_relaxed);
+    }
+
+  private:
+    boost::atomic<int64_t> _top;
+    char _pad[64 - sizeof(boost::atomic<int64_t>)]; // owner and thieves on separate cache lines
+    boost::atomic<int64_t> _bottom;
+    uint64_t _mask;
+    boost::scoped_array<boost::atomic<T*> > _buffer;
+};
+}
+
+#endif /* SPL_RUNTIME_PROCESSING_ELEMENT_WORK_STEALING_DEQUE_H */
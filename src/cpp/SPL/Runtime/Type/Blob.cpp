@@ -20,6 +20,7 @@
 #include <SPL/Runtime/Type/Blob.h>
 #include <SPL/Runtime/Type/List.h>
 #include <SPL/Runtime/Type/PrimitiveType.h>
+#include <SPL/Runtime/Utility/Hash.h>
 
 #include <cstring>
 #include <iomanip>
@@ -87,13 +88,28 @@ void blob::copyData(unsigned char const* data, uint64_t size)
     }
 }
 
+void blob::allocData(uint64_t size)
+{
+    if (data_ && size_ == size) {
+        return;
+    }
+    deleteData();
+    size_ = size;
+    data_ = new unsigned char[size];
+}
+
 blob& blob::operator=(const blob& ot)
 {
     if (&ot == this) {
         return *this;
     }
-    deleteData();
-    copyData(ot.data_, REAL_SIZE(ot.size_));
+    if (ot.data_) {
+        allocData(REAL_SIZE(ot.size_));
+        memcpy(data_, ot.data_, size_);
+    } else {
+        deleteData();
+        size_ = 0;
+    }
     return *this;
 }
 
@@ -423,10 +439,14 @@ void blob::deserialize(istream& istr)
 
 size_t blob::hashCode() const
 {
+#if ENABLE_SPL_FAST_HASH
+    return static_cast<size_t>(Hash::hashBytes(data_, getSize()));
+#else
     size_t r = 17;
     std::tr1::hash<size_t> hs;
     for (uint64_t i = 0, iu = this->getSize(); i < iu; ++i) {
-        r = 37 * r + hs(this->operator[](i));
+        r = Hash::combine(r, hs(this->operator[](i)));
     }
     return r;
+#endif
 }
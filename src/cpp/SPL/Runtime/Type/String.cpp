@@ -676,7 +676,11 @@ size_t SPL::ustring::getSerializedSize() const
 
 size_t SPL::ustring::hashCode() const
 {
+#if ENABLE_SPL_FAST_HASH
+    return static_cast<size_t>(Hash::hashBytes(impl().getBuffer(), impl().length() * sizeof(UChar)));
+#else
     return impl().hashCode();
+#endif
 }
 
 int32_t SPL::ustring::indexOf(ustring const& text) const
@@ -17,6 +17,7 @@
 #include <SPL/Runtime/Common/RuntimeDebug.h>
 #include <SPL/Runtime/Common/RuntimeMessage.h>
 #include <SPL/Runtime/Type/SPLType.h>
+#include <SPL/Runtime/Utility/Hash.h>
 #include <SPL/Runtime/Utility/LogTraceMessage.h>
 #include <SPL/Runtime/serializedTupleModel.h>
 #include <boost/filesystem/operations.hpp>
@@ -237,6 +238,18 @@ void Tuple::swapWith(Tuple& otuple, bool typesafe /*=true*/)
 
 void Tuple::normalizeBoundedSetsAndMaps() {}
 
+size_t Tuple::hashAttributes(uint32_t const* attributes, uint32_t count) const
+{
+    if (count == 1) {
+        return getAttributeValue(attributes[0]).hashCode();
+    }
+    size_t hash = 17;
+    for (uint32_t i = 0; i < count; ++i) {
+        hash = Hash::combine(hash, getAttributeValue(attributes[i]).hashCode());
+    }
+    return hash;
+}
+
 void Tuple::setPayloadContainer(PayloadContainer* payload)
 {
     if (payload == payload_) {
@@ -42,12 +42,12 @@ class StarTimeSlidingWindowImpl
 
     virtual ~StarTimeSlidingWindowImpl() {}
 
-    void createTriggerThread() { triggerThread_->create(); }
+    void createTriggerThread() { triggerThread_->start(); }
 
     void joinTriggerThread()
     {
         APPTRC(L_INFO, "Joining trigger thread...", SPL_WINDOW_DBG);
-        triggerThread_->join();
+        triggerThread_->finish();
         APPTRC(L_INFO, "Joined trigger thread.", SPL_WINDOW_DBG);
     }
 
@@ -57,12 +57,12 @@ class TimeStarSlidingWindowImpl
         cv_.signal();
     }
 
-    void createEvictionThread() { evictThread_->create(); }
+    void createEvictionThread() { evictThread_->start(); }
 
     void joinEvictionThread()
     {
         APPTRC(L_INFO, "Joining eviction thread...", SPL_WINDOW_DBG);
-        evictThread_->join();
+        evictThread_->finish();
         APPTRC(L_INFO, "Joined eviction thread.", SPL_WINDOW_DBG);
     }
 
@@ -89,8 +89,9 @@ class TimeStarSlidingWindowImpl
             size += it->second.size();
         }
         if (size == 0) {
-            if (evictThread_->isSuspended()) {
-                // Handler was suspended, don't wait for tuples to be inserted
+            if (evictThread_->isSuspended() || evictThread_->isShared()) {
+                // Handler was suspended, or runs on the shared window timer
+                // service, don't wait for tuples to be inserted
                 return evictThread_->getTime();
             }
             // it is fine if we wake up prematurely
@@ -143,8 +144,9 @@ class TimeStarSlidingWindowImpl
         }
 
         while (oldest < 0) { // no tuples in window
-            if (evictThread_->isSuspended()) {
-                // Handler was suspended, don't wait for tuples to be inserted
+            if (evictThread_->isSuspended() || evictThread_->isShared()) {
+                // Handler was suspended, or runs on the shared window timer
+                // service, don't wait for tuples to be inserted
                 return evictThread_->getTime();
             }
             cv_.wait(this->mutex_);
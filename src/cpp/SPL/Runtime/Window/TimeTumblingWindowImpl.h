@@ -59,12 +59,12 @@ class TimeTumblingWindowImpl
 
     ~TimeTumblingWindowImpl() {}
 
-    void createEvictionThread() { evictThread_->create(); }
+    void createEvictionThread() { evictThread_->start(); }
 
     void joinEvictionThread()
     {
         APPTRC(L_INFO, "Joining eviction thread...", SPL_WINDOW_DBG);
-        evictThread_->join();
+        evictThread_->finish();
         APPTRC(L_INFO, "Joined eviction thread.", SPL_WINDOW_DBG);
     }
 
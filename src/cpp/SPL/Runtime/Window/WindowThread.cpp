@@ -38,12 +38,36 @@ static double getTimeOfDay()
 
 SuspendableThread::SuspendableThread(OperatorImpl& oper)
   : oper_(oper)
+  , shared_(false)
   , inConsistentRegion_(static_cast<ConsistentRegionContext*>(
                           oper.getContext().getOptionalContext(CONSISTENT_REGION)) != NULL)
   , suspended_(false)
   , busy_(false)
 {}
 
+void SuspendableThread::start()
+{
+    WindowTimerService* service = PEImpl::instance().getWindowTimerService();
+    if (service != NULL) {
+        shared_ = true;
+        service->schedule(*this, getFirstDelay());
+    } else {
+        create();
+    }
+}
+
+void SuspendableThread::finish()
+{
+    if (shared_) {
+        // Like the thread, the task runs until shutdown is requested
+        WindowTimerService* service = PEImpl::instance().getWindowTimerService();
+        service->waitDone(*this);
+        service->cancel(*this);
+    } else {
+        join();
+    }
+}
+
 void SuspendableThread::resume()
 {
     // TODO inline
@@ -83,53 +107,63 @@ void* WindowTriggerThread::run(void* threadArgs)
         APPTRC(L_DEBUG, "blocking for " << period << " secs", SPL_OPER_DBG);
         OperatorTracker::resetCurrentOperator();
         pe.blockUntilShutdownRequest(period);
-        OperatorTracker::setCurrentOperator(context.getIndex());
-        setBusy();
-        APPTRC(L_DEBUG, "setBusy true", SPL_OPER_DBG);
-        double timeStart = getTimeOfDay();
-        if (handler_) {
-            bool alive = false;
-            try {
-                if (!this->isSuspended()) {
-                    APPTRC(L_DEBUG, "call event handler", SPL_OPER_DBG);
-                    alive = handler_->windowTriggerThreadEvent(*this);
-                } else {
-                    APPTRC(L_DEBUG, "no event handler invocation, thread suspended", SPL_OPER_DBG);
-                    alive = true;
-                }
-            } catch (DistilleryException const& e) {
-                pe.handleOperatorFailure("Exception received during WindowTriggerThread::run()",
-                                         e.getExplanation());
-                pe.shutdown();
-            } catch (std::exception const& e) {
-                pe.handleOperatorFailure("Exception received during WindowTriggerThread::run()",
-                                         e.what());
-                pe.shutdown();
-            } catch (...) {
-                pe.handleOperatorFailure(
-                  "Unknown exception received during WindowTriggerThread::run()",
-                  SPL_RUNTIME_UNKNOWN_EXCEPTION);
-                pe.shutdown();
-            }
-            if (!alive) {
-                setBusy(false);
-                OperatorTracker::finalize();
-                return NULL;
-            }
+        if (!fireTimer(period)) {
+            break;
         }
-        double timeEnd = getTimeOfDay();
-        double timeDiff = timeEnd - timeStart;
-        if (timeDiff >= period_)
-            period = 0;
-        else
-            period = period_ - timeDiff;
-        setBusy(false);
-        APPTRC(L_DEBUG, "setBusy false", SPL_OPER_DBG);
     }
     OperatorTracker::finalize();
     return NULL;
 }
 
+bool WindowTriggerThread::fireTimer(double& period)
+{
+    PEImpl& pe = PEImpl::instance();
+    OperatorTracker::setCurrentOperator(oper_.getContextImpl().getIndex());
+    setBusy();
+    APPTRC(L_DEBUG, "setBusy true", SPL_OPER_DBG);
+    double timeStart = getTimeOfDay();
+    if (handler_) {
+        bool alive = false;
+        try {
+            if (!this->isSuspended()) {
+                APPTRC(L_DEBUG, "call event handler", SPL_OPER_DBG);
+                alive = handler_->windowTriggerThreadEvent(*this);
+            } else {
+                APPTRC(L_DEBUG, "no event handler invocation, thread suspended", SPL_OPER_DBG);
+                alive = true;
+            }
+        } catch (DistilleryException const& e) {
+            pe.handleOperatorFailure("Exception received during WindowTriggerThread::run()",
+                                     e.getExplanation());
+            pe.shutdown();
+        } catch (std::exception const& e) {
+            pe.handleOperatorFailure("Exception received during WindowTriggerThread::run()",
+                                     e.what());
+            pe.shutdown();
+        } catch (...) {
+            pe.handleOperatorFailure(
+              "Unknown exception received during WindowTriggerThread::run()",
+              SPL_RUNTIME_UNKNOWN_EXCEPTION);
+            pe.shutdown();
+        }
+        if (!alive) {
+            setBusy(false);
+            OperatorTracker::resetCurrentOperator();
+            return false;
+        }
+    }
+    double timeEnd = getTimeOfDay();
+    double timeDiff = timeEnd - timeStart;
+    if (timeDiff >= period_)
+        period = 0;
+    else
+        period = period_ - timeDiff;
+    setBusy(false);
+    APPTRC(L_DEBUG, "setBusy false", SPL_OPER_DBG);
+    OperatorTracker::resetCurrentOperator();
+    return true;
+}
+
 WindowEvictionThread::WindowEvictionThread(double delta, OperatorImpl& oper)
   : SuspendableThread(oper)
   , delta_(delta)
@@ -155,52 +189,62 @@ void* WindowEvictionThread::run(void* threadArgs)
         APPTRC(L_DEBUG, "blocking for " << period << " secs", SPL_OPER_DBG);
         OperatorTracker::resetCurrentOperator();
         pe.blockUntilShutdownRequest(period);
-        OperatorTracker::setCurrentOperator(context.getIndex());
-        setBusy();
-        APPTRC(L_DEBUG, "setBusy true", SPL_OPER_DBG);
-        if (handler_) {
-            double deadline = 0;
-            try {
-                if (!this->isSuspended()) {
-                    APPTRC(L_DEBUG, "call event handler", SPL_OPER_DBG);
-                    deadline = handler_->windowEvictionThreadEvent(*this);
-                } else {
-                    APPTRC(L_DEBUG, "no event handler invocation, thread suspended", SPL_OPER_DBG);
-                    // Setting deadline to current time will schedule the next
-                    // execution in delta_ seconds
-                    deadline = this->getTime();
-                }
-            } catch (DistilleryException const& e) {
-                pe.handleOperatorFailure("Exception received during WindowEvictionThread::run(): ",
-                                         e.getExplanation());
-                pe.shutdown();
-            } catch (std::exception const& e) {
-                pe.handleOperatorFailure("Exception received during WindowEvictionThread::run(): ",
-                                         e.what());
-                pe.shutdown();
-            } catch (...) {
-                pe.handleOperatorFailure(
-                  "Unknown exception received during WindowEvictionThread::run()",
-                  SPL_RUNTIME_UNKNOWN_EXCEPTION);
-                pe.shutdown();
-            }
-            if (deadline < 0) {
-                setBusy(false);
-                OperatorTracker::finalize();
-                return NULL; // shutdown requested
-            }
-            deadline = deadline + delta_;
-            double ctime = getTimeOfDay();
-            if (deadline < ctime)
-                period = 0;
-            else
-                period = deadline - ctime;
-        } else
-            period = 1.0;
-
-        setBusy(false);
-        APPTRC(L_DEBUG, "setBusy false", SPL_OPER_DBG);
+        if (!fireTimer(period)) {
+            break; // shutdown requested
+        }
     }
     OperatorTracker::finalize();
     return NULL;
 }
+
+bool WindowEvictionThread::fireTimer(double& period)
+{
+    PEImpl& pe = PEImpl::instance();
+    OperatorTracker::setCurrentOperator(oper_.getContextImpl().getIndex());
+    setBusy();
+    APPTRC(L_DEBUG, "setBusy true", SPL_OPER_DBG);
+    if (handler_) {
+        double deadline = 0;
+        try {
+            if (!this->isSuspended()) {
+                APPTRC(L_DEBUG, "call event handler", SPL_OPER_DBG);
+                deadline = handler_->windowEvictionThreadEvent(*this);
+            } else {
+                APPTRC(L_DEBUG, "no event handler invocation, thread suspended", SPL_OPER_DBG);
+                // Setting deadline to current time will schedule the next
+                // execution in delta_ seconds
+                deadline = this->getTime();
+            }
+        } catch (DistilleryException const& e) {
+            pe.handleOperatorFailure("Exception received during WindowEvictionThread::run(): ",
+                                     e.getExplanation());
+            pe.shutdown();
+        } catch (std::exception const& e) {
+            pe.handleOperatorFailure("Exception received during WindowEvictionThread::run(): ",
+                                     e.what());
+            pe.shutdown();
+        } catch (...) {
+            pe.handleOperatorFailure(
+              "Unknown exception received during WindowEvictionThread::run()",
+              SPL_RUNTIME_UNKNOWN_EXCEPTION);
+            pe.shutdown();
+        }
+        if (deadline < 0) {
+            setBusy(false);
+            OperatorTracker::resetCurrentOperator();
+            return false;
+        }
+        deadline = deadline + delta_;
+        double ctime = getTimeOfDay();
+        if (deadline < ctime)
+            period = 0;
+        else
+            period = deadline - ctime;
+    } else
+        period = 1.0;
+
+    setBusy(false);
+    APPTRC(L_DEBUG, "setBusy false", SPL_OPER_DBG);
+    OperatorTracker::resetCurrentOperator();
+    return true;
+}
@@ -19,6 +19,7 @@
 
 #include <SPL/Runtime/Utility/Thread.h>
 #include <SPL/Runtime/Utility/Visibility.h>
+#include <SPL/Runtime/Window/WindowTimerService.h>
 #include <UTILS/CV.h>
 #include <UTILS/Mutex.h>
 
@@ -99,10 +100,35 @@ struct atomic_bool
 };
 } // end namespace internal
 
-/** Thread for which task execution can be suspended. */
-class DLL_PUBLIC SuspendableThread : public Thread
+/**
+ * Thread for which task execution can be suspended. When the PE has a
+ * window timer service, the task runs on the service instead of on its
+ * own thread.
+ */
+class DLL_PUBLIC SuspendableThread
+  : public Thread
+  , public WindowTimerTask
 {
   public:
+    /**
+     * Start executing tasks, on the window timer service of the PE if
+     * there is one, otherwise on this thread.
+     */
+    void start();
+
+    /**
+     * Wait until tasks stop executing, either because shutdown was
+     * requested or because the event handler stopped them.
+     */
+    void finish();
+
+    /**
+     * Determines whether tasks execute on the window timer service of
+     * the PE. Event handlers must not block in that case.
+     * @return true if tasks execute on the service, otherwise false.
+     */
+    bool isShared() const { return shared_; }
+
     /**
      * Suspend task execution.
      * This function returns only after all outstanding tasks finish
@@ -144,9 +170,14 @@ class DLL_PUBLIC SuspendableThread : public Thread
     bool isBusy() const { return busy_; }
     void setBusy(bool value = true) { busy_ = value; }
 
+    // Delay before the first task execution, in seconds
+    virtual double getFirstDelay() const = 0;
+
     OperatorImpl& oper_;
 
   private:
+    // True if tasks execute on the window timer service.
+    bool shared_;
     // True if the thread runs within the context of a consistent
     // region, otherwise false.
     const bool inConsistentRegion_;
@@ -195,7 +226,12 @@ class DLL_PUBLIC WindowTriggerThread : public SuspendableThread
     /// Run method
     void* run(void* threadArgs);
 
+    /// Fire one event
+    bool fireTimer(double& delay);
+
   private:
+    double getFirstDelay() const { return period_; }
+
     double period_;
     EventHandler* handler_;
 };
@@ -248,7 +284,12 @@ class DLL_PUBLIC WindowEvictionThread : public SuspendableThread
     /// Run method
     void* run(void* threadArgs);
 
+    /// Fire one event
+    bool fireTimer(double& delay);
+
   private:
+    double getFirstDelay() const { return 0.0; }
+
     double delta_;
     EventHandler* handler_;
 };
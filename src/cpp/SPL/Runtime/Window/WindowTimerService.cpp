@@ -0,0 +1,345 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <SPL/Runtime/Window/WindowTimerService.h>
+
+#include <SPL/Runtime/Common/RuntimeDebug.h>
+#include <SPL/Runtime/Common/RuntimeDebugAspect.h>
+#include <SPL/Runtime/Operator/OperatorTracker.h>
+#include <SPL/Runtime/ProcessingElement/PEImpl.h>
+#include <UTILS/SupportFunctions.h>
+
+#include <cassert>
+#include <cmath>
+#include <stdlib.h>
+#include <time.h>
+
+using namespace SPL;
+using namespace Distillery;
+using namespace std;
+
+// More workers than this defeats the purpose of sharing them between windows
+static const uint32_t MaxThreads = 64;
+
+class WindowTimerService::TimerThread : public Thread
+{
+  public:
+    TimerThread(WindowTimerService& service)
+      : service_(service)
+    {}
+
+    void* run(void* threadArgs)
+    {
+        // Outside of a PE, as in the unit tests, there is nothing to register with
+        if (PEImpl::hasInstance()) {
+            registerThread("WinTimer");
+        }
+        service_.runTimer();
+        return NULL;
+    }
+
+  private:
+    WindowTimerService& service_;
+};
+
+class WindowTimerService::WorkerThread : public Thread
+{
+  public:
+    WorkerThread(WindowTimerService& service)
+      : service_(service)
+    {}
+
+    void* run(void* threadArgs)
+    {
+        bool inPE = PEImpl::hasInstance();
+        if (inPE) {
+            OperatorTracker::init();
+            registerThread("WinTimerWork");
+        }
+        service_.runWorker();
+        if (inPE) {
+            OperatorTracker::finalize();
+        }
+        return NULL;
+    }
+
+  private:
+    WindowTimerService& service_;
+};
+
+uint32_t WindowTimerService::getConfiguredThreads()
+{
+    string value = get_environment_variable("STREAMS_WINDOW_TIMER_THREADS", "");
+    if (value.empty()) {
+        return 0;
+    }
+    char* end;
+    unsigned long threads = strtoul(value.c_str(), &end, 10);
+    if (*end != '\0' || threads > MaxThreads) {
+        APPTRC(L_WARN,
+               "Invalid number of window timer threads '"
+                 << value << "', using a thread per window instead",
+               SPL_WINDOW_DBG);
+        return 0;
+    }
+    return threads;
+}
+
+WindowTimerService::WindowTimerService(uint32_t numThreads)
+  : numThreads_(numThreads)
+  , currentTick_(now())
+  , wakeupTick_(UINT64_MAX)
+  , numInWheel_(0)
+  , shutdown_(false)
+{}
+
+WindowTimerService::~WindowTimerService()
+{
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        delete threads_[i];
+    }
+}
+
+void WindowTimerService::start()
+{
+    APPTRC(L_INFO, "Starting window timer service with " << numThreads_ << " worker threads",
+           SPL_WINDOW_DBG);
+    threads_.push_back(new TimerThread(*this));
+    for (uint32_t i = 0; i < numThreads_; ++i) {
+        threads_.push_back(new WorkerThread(*this));
+    }
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        threads_[i]->create();
+    }
+}
+
+void WindowTimerService::schedule(WindowTimerTask& task, double delay)
+{
+    AutoMutex am(mutex_);
+    assert(task.state_ == WindowTimerTask::Idle);
+    if (shutdown_) {
+        return;
+    }
+    task.cancelled_ = false;
+    ready_.push_front(&task);
+    task.list_ = &ready_;
+    task.it_ = ready_.begin();
+    task.expiry_ = now() + toTicks(delay);
+    insert(task);
+}
+
+void WindowTimerService::cancel(WindowTimerTask& task)
+{
+    AutoMutex am(mutex_);
+    task.cancelled_ = true;
+    while (task.state_ == WindowTimerTask::Running) {
+        doneCV_.wait(mutex_);
+    }
+    if (task.state_ == WindowTimerTask::Scheduled) {
+        remove(task);
+    }
+}
+
+void WindowTimerService::waitDone(WindowTimerTask& task)
+{
+    AutoMutex am(mutex_);
+    while (task.state_ != WindowTimerTask::Idle && !shutdown_) {
+        doneCV_.wait(mutex_);
+    }
+}
+
+void WindowTimerService::shutdown()
+{
+    AutoMutex am(mutex_);
+    shutdown_ = true;
+    timerCV_.signal();
+    workerCV_.broadcast();
+    doneCV_.broadcast();
+}
+
+void WindowTimerService::joinThreads()
+{
+    APPTRC(L_DEBUG, "Joining window timer threads...", SPL_WINDOW_DBG);
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        threads_[i]->join();
+    }
+    APPTRC(L_DEBUG, "Joined window timer threads", SPL_WINDOW_DBG);
+}
+
+void WindowTimerService::runTimer()
+{
+    AutoMutex am(mutex_);
+    while (!shutdown_) {
+        uint64_t tick = now();
+        while (currentTick_ < tick) {
+            if (numInWheel_ == 0) {
+                currentTick_ = tick;
+                break;
+            }
+            advance();
+        }
+        if (!ready_.empty()) {
+            workerCV_.broadcast();
+        }
+
+        wakeupTick_ = nextWakeup();
+        if (wakeupTick_ == UINT64_MAX) {
+            timerCV_.wait(mutex_);
+        } else {
+            uint64_t millis = wakeupTick_ - tick;
+            struct timespec rel;
+            rel.tv_sec = millis / 1000;
+            rel.tv_nsec = (millis % 1000) * 1000 * 1000;
+            timerCV_.waitFor(mutex_, rel);
+        }
+    }
+}
+
+void WindowTimerService::runWorker()
+{
+    AutoMutex am(mutex_);
+    while (true) {
+        while (ready_.empty() && !shutdown_) {
+            workerCV_.wait(mutex_);
+        }
+        if (shutdown_) {
+            break;
+        }
+        WindowTimerTask& task = *ready_.front();
+        moveTo(task, running_);
+        task.state_ = WindowTimerTask::Running;
+
+        double delay = 0;
+        mutex_.unlock();
+        bool alive = task.fireTimer(delay);
+        mutex_.lock();
+
+        if (alive && !task.cancelled_ && !shutdown_) {
+            task.expiry_ = now() + toTicks(delay);
+            insert(task);
+        } else {
+            remove(task);
+            doneCV_.broadcast();
+        }
+    }
+}
+
+void WindowTimerService::insert(WindowTimerTask& task)
+{
+    task.state_ = WindowTimerTask::Scheduled;
+    uint64_t expiry = task.expiry_;
+    if (expiry <= currentTick_) {
+        moveTo(task, ready_);
+        workerCV_.signal();
+        return;
+    }
+
+    // Level n holds the tasks due in less than numSlots^(n+1) ticks; the last
+    // level also holds the ones due later, which cascade into it again
+    uint64_t delta = expiry - currentTick_;
+    uint32_t level = 0;
+    while (level < numLevels - 1 && delta >= (UINT64_C(1) << (slotBits * (level + 1)))) {
+        ++level;
+    }
+    moveTo(task, wheel_[level][(expiry >> (slotBits * level)) & (numSlots - 1)]);
+    if (expiry < wakeupTick_) {
+        timerCV_.signal();
+    }
+}
+
+void WindowTimerService::moveTo(WindowTimerTask& task, List& list)
+{
+    if (isInWheel(task.list_)) {
+        --numInWheel_;
+    }
+    if (isInWheel(&list)) {
+        ++numInWheel_;
+    }
+    list.splice(list.end(), *task.list_, task.it_);
+    task.list_ = &list;
+    task.it_ = --list.end();
+}
+
+void WindowTimerService::remove(WindowTimerTask& task)
+{
+    if (isInWheel(task.list_)) {
+        --numInWheel_;
+    }
+    task.list_->erase(task.it_);
+    task.list_ = NULL;
+    task.state_ = WindowTimerTask::Idle;
+}
+
+void WindowTimerService::advance()
+{
+    uint64_t tick = ++currentTick_;
+
+    // When the index of a level wraps around, the next slot of the level
+    // above is due; cascade from the highest such level down
+    uint32_t wrapped = 0;
+    while (wrapped < numLevels - 1 &&
+           (tick & ((UINT64_C(1) << (slotBits * (wrapped + 1))) - 1)) == 0) {
+        ++wrapped;
+    }
+    for (uint32_t level = wrapped; level > 0; --level) {
+        cascade(level, (tick >> (slotBits * level)) & (numSlots - 1));
+    }
+
+    List& due = wheel_[0][tick & (numSlots - 1)];
+    while (!due.empty()) {
+        moveTo(*due.front(), ready_);
+    }
+}
+
+void WindowTimerService::cascade(uint32_t level, uint32_t slot)
+{
+    List& list = wheel_[level][slot];
+    List pending;
+    while (!list.empty()) {
+        moveTo(*list.front(), pending);
+    }
+    while (!pending.empty()) {
+        insert(*pending.front());
+    }
+}
+
+uint64_t WindowTimerService::nextWakeup() const
+{
+    if (numInWheel_ == 0) {
+        return UINT64_MAX;
+    }
+    // Look for the next due slot up to the next cascade
+    uint64_t tick = currentTick_ + 1;
+    while (wheel_[0][tick & (numSlots - 1)].empty() && (tick & (numSlots - 1)) != 0) {
+        ++tick;
+    }
+    return tick;
+}
+
+uint64_t WindowTimerService::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / (1000 * 1000);
+}
+
+uint64_t WindowTimerService::toTicks(double seconds)
+{
+    if (seconds <= 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(ceil(seconds * 1000));
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_WINDOW_WINDOW_TIMER_SERVICE_H
+#define SPL_RUNTIME_WINDOW_WINDOW_TIMER_SERVICE_H
+
+#include <SPL/Runtime/Utility/Thread.h>
+#include <UTILS/CV.h>
+#include <UTILS/Mutex.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <list>
+#include <stdint.h>
+#include <vector>
+
+namespace SPL {
+class WindowTimerService;
+
+/// Task that is run periodically by the window timer service
+class WindowTimerTask
+{
+  public:
+    virtual ~WindowTimerTask() {}
+
+    /**
+     * Run the task. This must not throw, and should not block: the task
+     * runs on one of the few threads shared by all the windows of the PE.
+     * @param delay set to the delay before the next run, in seconds
+     * @return false to stop running the task, true otherwise
+     */
+    virtual bool fireTimer(double& delay) = 0;
+
+  protected:
+    WindowTimerTask()
+      : list_(NULL)
+      , expiry_(0)
+      , state_(Idle)
+      , cancelled_(false)
+    {}
+
+  private:
+    friend class WindowTimerService;
+    typedef std::list<WindowTimerTask*> List;
+
+    enum State
+    {
+        Idle,      // not known to the service
+        Scheduled, // in the wheel or in the ready list
+        Running    // being fired by a worker thread
+    };
+
+    List* list_;        // list holding the task
+    List::iterator it_; // position in list_
+    uint64_t expiry_;   // tick at which the task is due
+    State state_;
+    bool cancelled_;
+};
+
+/**
+ * Timer service shared by the time-based windows of a PE.
+ *
+ * Instead of a thread per trigger or eviction policy, tasks are kept in a
+ * hierarchical timer wheel (Varghese and Lauck) with a 1 ms tick: insertion
+ * and cancellation are O(1), and a single timer thread sleeps until the next
+ * expiry. Expired tasks are fired by a small pool of worker threads, so that
+ * a slow window handler does not delay the other windows.
+ *
+ * The service is enabled by setting STREAMS_WINDOW_TIMER_THREADS to the
+ * number of worker threads. It is off by default, and every window then
+ * runs its own thread.
+ */
+class WindowTimerService : private boost::noncopyable
+{
+  public:
+    /**
+     * Get the number of worker threads requested for the service.
+     * @return the number of worker threads, 0 if the service is disabled
+     */
+    static uint32_t getConfiguredThreads();
+
+    /**
+     * Constructor.
+     * @param numThreads number of worker threads
+     */
+    WindowTimerService(uint32_t numThreads);
+
+    /// Destructor
+    ~WindowTimerService();
+
+    /// Create the timer and worker threads
+    void start();
+
+    /**
+     * Schedule a task. The task keeps running, at the delays it returns,
+     * until it asks to stop, is cancelled, or the service is shut down.
+     * @param task task, which must not be scheduled already
+     * @param delay delay before the first run, in seconds
+     */
+    void schedule(WindowTimerTask& task, double delay);
+
+    /**
+     * Cancel a task. If the task is running, this waits for it to finish.
+     * @param task task
+     */
+    void cancel(WindowTimerTask& task);
+
+    /**
+     * Wait until a task stops running on its own, or the service is shut down.
+     * @param task task
+     */
+    void waitDone(WindowTimerTask& task);
+
+    /// Stop firing tasks; this does not wait for the threads to exit
+    void shutdown();
+
+    /// Wait for the timer and worker threads to exit
+    void joinThreads();
+
+  private:
+    class TimerThread;
+    class WorkerThread;
+    typedef WindowTimerTask::List List;
+
+    enum
+    {
+        slotBits = 6,
+        numSlots = 1 << slotBits,
+        numLevels = 4
+    };
+
+    void runTimer();
+    void runWorker();
+
+    // All the following are called with mutex_ held
+    void insert(WindowTimerTask& task);
+    void moveTo(WindowTimerTask& task, List& list);
+    void remove(WindowTimerTask& task);
+    bool isInWheel(List const* list) const
+    {
+        return list >= &wheel_[0][0] && list < &wheel_[0][0] + numLevels * numSlots;
+    }
+    void advance();
+    void cascade(uint32_t level, uint32_t slot);
+    uint64_t nextWakeup() const;
+
+    static uint64_t now();
+    static uint64_t toTicks(double seconds);
+
+    uint32_t numThreads_;
+    std::vector<Thread*> threads_;
+
+    Distillery::Mutex mutex_;
+    Distillery::CV timerCV_;  // timer thread waiting for the next expiry
+    Distillery::CV workerCV_; // worker threads waiting for ready tasks
+    Distillery::CV doneCV_;   // waiting for tasks to stop running
+
+    List wheel_[numLevels][numSlots];
+    List ready_;   // due tasks, waiting for a worker
+    List running_; // tasks being fired
+    uint64_t currentTick_;
+    uint64_t wakeupTick_; // when the timer thread wakes up next
+    uint32_t numInWheel_;
+    bool shutdown_;
+};
+};
+
+#endif /* SPL_RUNTIME_WINDOW_WINDOW_TIMER_SERVICE_H */
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <SPL/Runtime/Type/SPLType.h>
+#include <SPL/TestSrc/Utility/TestUtils.h>
+#include <SPL/Toolkit/CSVScanner.h>
+#include <SPL/Toolkit/IOHelper.h>
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+using namespace Distillery;
+
+namespace SPL {
+
+/**
+ * Test of the CSV scanner used by the source operators: a line that the
+ * scanner accepts must give the same values as readCSV, which the
+ * operators fall back to for the lines the scanner does not accept.
+ */
+class CSVScannerTest : public TestBase
+{
+  public:
+    CSVScannerTest() {}
+
+  private:
+    void runTests()
+    {
+        test_integers();
+        test_floats();
+        test_booleans();
+        test_strings();
+        test_fields();
+        test_longLines();
+        test_fallback();
+        test_lineEnd();
+    }
+
+    /// Read the fields of a line with the scanner, as the operators do
+    template<typename T>
+    static bool scan(string const& line, size_t count, bool ignoreExtra, vector<T>& values)
+    {
+        CSVScanner::Line fields;
+        if (!fields.split(line.data(), line.size(), ',', count, ignoreExtra)) {
+            return false;
+        }
+        values.clear();
+        for (size_t i = 0; i < count; ++i) {
+            T value;
+            if (!CSVScanner::read(fields[i], value)) {
+                return false;
+            }
+            values.push_back(value);
+        }
+        return true;
+    }
+
+    /// Read the fields of a line with readCSV, as the operators do when
+    /// the scanner does not accept the line
+    template<typename T>
+    void parse(string const& line, size_t count, vector<T>& values)
+    {
+        istringstream fs(line + "\n");
+        fs.imbue(std::locale::classic());
+        values.clear();
+        for (size_t i = 0; i < count; ++i) {
+            T value;
+            readCSV<T, ','>(fs, value);
+            values.push_back(value);
+            if (i + 1 < count) {
+                unsigned char sep;
+                fs >> skipSpaceTabs >> sep;
+            }
+        }
+        ASSERT_TRUE_MSG("readCSV of \"" << line << "\"", !fs.fail());
+    }
+
+    /**
+     * Check that the scanner accepts a line or not, and that it reads the
+     * same values as readCSV when it does
+     * @param line line, without its terminating character
+     * @param count number of fields expected
+     * @param fast whether the scanner accepts the line
+     * @param ignoreExtra whether the fields after the expected ones are
+     * ignored
+     */
+    template<typename T>
+    void check(string const& line, size_t count, bool fast, bool ignoreExtra = false)
+    {
+        vector<T> scanned;
+        bool accepted = scan(line, count, ignoreExtra, scanned);
+        ASSERT_EQUALS_MSG("scanner accepts \"" << line << "\"", fast, accepted);
+        if (!accepted) {
+            return;
+        }
+        vector<T> expected;
+        parse(line, count, expected);
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQUALS_MSG("\"" << line << "\" field " << i, expected[i], scanned[i]);
+        }
+    }
+
+    void test_integers()
+    {
+        check<int32>("1,-2,3,4", 4, true);
+        check<int32>("  1,\t-2 ,  3  ,4", 4, true);
+        check<int32>("2147483647,-2147483648,0,-0", 4, true);
+        check<int64>("9223372036854775807,-9223372036854775808", 2, true);
+        check<uint64>("18446744073709551615,0", 2, false); // 20 digits
+        check<uint32>("4294967295,0", 2, true);
+        check<int8>("-128,127,0", 3, true);
+        check<uint8>("0,255,7", 3, true);
+        check<int16>("-32768,32767", 2, true);
+
+        // Out of range, signs and other forms are left to readCSV
+        check<int32>("2147483648,1", 2, false);
+        check<int8>("128,1", 2, false);
+        check<uint8>("-1,1", 2, false);
+        check<uint32>("-0,1", 2, false);
+        check<int32>("+1,1", 2, false);
+        check<int32>("0x10,1", 2, false);
+        check<int32>("1.0,1", 2, false);
+        check<int32>("\"1\",1", 2, false);
+    }
+
+    void test_floats()
+    {
+        check<float64>("0.1,1e22,-2.5e-3,3", 4, true);
+        check<float64>("9007199254740992,1e-22,0,-0.0", 4, true);
+        check<float64>(".5,5.,1E+2,12.5e-1", 4, true);
+        check<float64>("0.000000000000000000001,123456.789", 2, true);
+        check<float32>("0.1,16777216,1e10,-3.25", 4, true);
+        check<float32>("1e-10,0.5", 2, true);
+
+        // Values a single operation does not round correctly, or that
+        // readCSV reads in another form
+        check<float64>("9007199254740993,1", 2, false);
+        check<float64>("1e23,1", 2, false);
+        check<float64>("1e-23,1", 2, false);
+        check<float64>("12345678901234567890,1", 2, false);
+        check<float32>("16777217,1", 2, false);
+        check<float32>("1e11,1", 2, false);
+        check<float64>("nan,1", 2, false);
+        check<float64>("-inf,1", 2, false);
+        check<float64>("1e,1", 2, false);
+        check<float64>(".,1", 2, false);
+        check<float64>("0x1p3,1", 2, false);
+    }
+
+    void test_booleans()
+    {
+        check<boolean>("true,false, true ,false", 4, true);
+        check<boolean>("1,0", 2, false);
+        check<boolean>("True,false", 2, false);
+    }
+
+    void test_strings()
+    {
+        // Unquoted strings keep their trailing spaces, as with readCSV
+        check<rstring>("abc,  d e  ,f", 3, true);
+        check<rstring>("\"a b\",'c,d',\"\"", 3, true);
+        check<rstring>("\"a\"  ,  'b'\t,c", 3, true);
+
+        // Escapes, the other quote, unterminated quotes and characters
+        // other than printable ASCII in quotes are left to readCSV
+        check<rstring>("\"it's\",'say \"hi\"'", 2, false);
+        check<rstring>("\"a\\\"b\",c", 2, false);
+        check<rstring>("\"a\\nb\",c", 2, false);
+        check<rstring>("'a\\'b',c", 2, false);
+        check<rstring>("\"abc,d", 2, false);
+        check<rstring>("\"a\"b,c", 2, false);
+        check<rstring>("\"a\tb\",c", 2, false);
+        check<rstring>("\"caf\xc3\xa9\",c", 2, false);
+    }
+
+    /// Empty fields, trailing spaces and the number of fields
+    void test_fields()
+    {
+        check<int32>(",1,,2", 4, true);
+        check<int32>("1,2,3,", 4, true);
+        check<rstring>(",,", 3, true);
+
+        // Too few or too many fields
+        check<int32>("1,2,3", 4, false);
+        check<int32>("1,2,3,4,5", 4, false);
+        check<int32>("1,2,3,4,5", 4, true, true);
+        check<rstring>("a,\"b\",c", 2, true, true);
+
+        // readCSV only allows trailing spaces after the last value when
+        // the values after it are ignored
+        check<int32>("1,2  ", 2, false);
+        check<int32>("1,2  ", 2, true, true);
+        check<rstring>("\"a\",\"b\"  ", 2, false);
+        check<rstring>("\"a\",\"b\"  ", 2, true, true);
+    }
+
+    /// Lines longer than a block of the vectorized scan
+    void test_longLines()
+    {
+        ostringstream ints;
+        for (int i = 0; i < 100; ++i) {
+            ints << (i == 0 ? "" : ",") << i * 1000003 - 50000000;
+        }
+        check<int32>(ints.str(), 100, true);
+
+        // Quotes and separators on both sides of the block boundaries
+        for (size_t pad = 55; pad < 75; ++pad) {
+            string line = string(pad, 'x') + ",\"quoted, " + string(pad, 'y') + "\",z";
+            check<rstring>(line, 3, true);
+            line = string(pad, 'x') + ",\"esc\\\"aped\",z";
+            check<rstring>(line, 3, false);
+        }
+    }
+
+    /// The lines left to readCSV give the values the scanner cannot
+    void test_fallback()
+    {
+        vector<rstring> strings;
+        parse("\"say \\\"hi\\\"\",x", 2, strings);
+        ASSERT_EQUALS(rstring("say \"hi\""), strings[0]);
+        ASSERT_EQUALS(rstring("x"), strings[1]);
+
+        vector<float64> floats;
+        parse("1e23,nan,9007199254740993", 3, floats);
+        ASSERT_EQUALS(1e23, floats[0]);
+        ASSERT_TRUE(std::isnan(floats[1]));
+        ASSERT_EQUALS(9007199254740992.0, floats[2]);
+    }
+
+    /// Line ends, in quotes or not, and the lines skipped before a line
+    void test_lineEnd()
+    {
+        bool terminated;
+        string data = "1,2\n3,4";
+        ASSERT_EQUALS(3UL, CSVScanner::findLineEnd(data.data(), data.size(), ',', terminated));
+        ASSERT_TRUE(terminated);
+        ASSERT_EQUALS(3UL, CSVScanner::findLineEnd(data.data() + 4, 3, ',', terminated));
+        ASSERT_TRUE(!terminated);
+
+        // A new line in quotes does not end the line, even after an
+        // escaped quote
+        data = "\"a\nb\",'c\\'\nd'\r";
+        ASSERT_EQUALS(data.size() - 1,
+                      CSVScanner::findLineEnd(data.data(), data.size(), ',', terminated));
+        ASSERT_TRUE(terminated);
+
+        data = "\n \t\n# comment\n#\n  1,2";
+        ASSERT_EQUALS(data.size() - 3, CSVScanner::skipEmptyLines(data.data(), 0, data.size()));
+    }
+};
+} // end namespace SPL
+
+MAIN_APP(SPL::CSVScannerTest)
@@ -0,0 +1,421 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <SPL/Runtime/Serialization/NativeByteBuffer.h>
+#include <SPL/Runtime/Type/SPLType.h>
+#include <SPL/TestSrc/Utility/TestUtils.h>
+#include <SPL/Toolkit/ExpiringKeys.h>
+
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <vector>
+
+using namespace std;
+using namespace Distillery;
+
+namespace SPL {
+
+/// Fingerprint of a test key: its bits above the low 8 ones, so that the
+/// tests choose the home slot of the keys and which keys collide
+struct HomeHash
+{
+    uint64_t operator()(uint64_t key) const { return key >> 8; }
+};
+
+/// Key with the given fingerprint, told from the other keys with the
+/// same fingerprint by its id
+static uint64_t makeKey(uint64_t fingerprint, uint64_t id)
+{
+    return (fingerprint << 8) | id;
+}
+
+/// Values, here times, that are older than a limit have expired
+struct Before
+{
+    Before(int64 limit) : _limit(limit) {}
+    bool operator()(int64 value) const { return value < _limit; }
+    int64 _limit;
+};
+
+typedef ExpiringKeys::Table<uint64_t, int64, HomeHash> TestTable;
+
+/**
+ * Test of the table of expiring keys of the DeDuplicate operator: lookups
+ * through probe chains that collide and wrap around the slots, removal
+ * from the middle of a chain, requeuing of the keys seen again, growing
+ * and shrinking, and checkpointing.
+ */
+class ExpiringKeysTest : public TestBase
+{
+  public:
+    ExpiringKeysTest() {}
+
+  private:
+    void runTests()
+    {
+        srand(17);
+        test_collisions();
+        test_wraparound();
+        test_eraseInChain();
+        test_requeue();
+        test_shrink();
+        test_random();
+        test_checkpoint();
+        test_fingerprints();
+    }
+
+    /// Number of slots of a table, from its memory usage
+    template<typename Table>
+    static size_t slotCount(Table const& table)
+    {
+        uint64_t entries = table.size() * sizeof(typename Table::Entry);
+        return (table.getMemoryUsage() - entries) / (2 * sizeof(uint64_t));
+    }
+
+    /// Keys of a table, oldest first
+    static vector<uint64_t> keys(TestTable const& table)
+    {
+        vector<uint64_t> result;
+        for (TestTable::const_iterator it = table.begin(); it != table.end(); ++it) {
+            result.push_back(it->key);
+        }
+        return result;
+    }
+
+    void assertFound(TestTable& table, uint64_t key, int64 value)
+    {
+        int64* found = table.find(key);
+        ASSERT_TRUE_MSG("key " << hex << key << dec << " found", found != NULL);
+        ASSERT_EQUALS_MSG("value of key " << hex << key << dec, value, *found);
+    }
+
+    /// Keys with the same home, and with the same fingerprint
+    void test_collisions()
+    {
+        TestTable table;
+        for (uint64_t id = 0; id < 4; ++id) {
+            table.insert(makeKey(3, id), id);
+        }
+        table.insert(makeKey(19, 0), 10); // same home as 3 with 16 slots
+        table.insert(makeKey(4, 0), 11);
+        ASSERT_EQUALS(16UL, slotCount(table));
+
+        for (uint64_t id = 0; id < 4; ++id) {
+            assertFound(table, makeKey(3, id), id);
+        }
+        assertFound(table, makeKey(19, 0), 10);
+        assertFound(table, makeKey(4, 0), 11);
+        ASSERT_TRUE(table.find(makeKey(3, 4)) == NULL);
+        ASSERT_TRUE(table.find(makeKey(19, 1)) == NULL);
+        ASSERT_TRUE(table.find(makeKey(5, 0)) == NULL);
+
+        *table.find(makeKey(3, 2)) = 20;
+        assertFound(table, makeKey(3, 2), 20);
+        ASSERT_EQUALS(6UL, table.size());
+    }
+
+    /// Probe chains that continue from the last slot to the first one
+    void test_wraparound()
+    {
+        TestTable table;
+        table.insert(makeKey(14, 0), 0);
+        table.insert(makeKey(15, 0), 1);
+        table.insert(makeKey(15, 1), 2);
+        table.insert(makeKey(14, 1), 3);
+        table.insert(makeKey(0, 0), 4);
+        table.insert(makeKey(1, 0), 5);
+        // Slots 14, 15, 0, 1, 2 and 3
+        assertFound(table, makeKey(14, 0), 0);
+        assertFound(table, makeKey(15, 0), 1);
+        assertFound(table, makeKey(15, 1), 2);
+        assertFound(table, makeKey(14, 1), 3);
+        assertFound(table, makeKey(0, 0), 4);
+        assertFound(table, makeKey(1, 0), 5);
+        ASSERT_TRUE(table.find(makeKey(15, 2)) == NULL);
+        ASSERT_TRUE(table.find(makeKey(30, 0)) == NULL);
+
+        // Removing the keys at the end of the slots moves the keys that
+        // wrapped around back over the boundary
+        table.expire(Before(2));
+        ASSERT_EQUALS(4UL, table.size());
+        assertFound(table, makeKey(15, 1), 2);
+        assertFound(table, makeKey(14, 1), 3);
+        assertFound(table, makeKey(0, 0), 4);
+        assertFound(table, makeKey(1, 0), 5);
+        ASSERT_TRUE(table.find(makeKey(14, 0)) == NULL);
+        ASSERT_TRUE(table.find(makeKey(15, 0)) == NULL);
+
+        // A key inserted after the removal takes a slot freed by it
+        table.insert(makeKey(15, 2), 6);
+        assertFound(table, makeKey(15, 2), 6);
+        assertFound(table, makeKey(0, 0), 4);
+    }
+
+    /// Removal of a key in the middle of a probe chain keeps the keys after
+    /// it reachable, whether or not they can move back
+    void test_eraseInChain()
+    {
+        TestTable table;
+        table.insert(makeKey(4, 0), 0); // slot 4
+        table.insert(makeKey(3, 0), 1); // slot 3
+        table.insert(makeKey(3, 1), 2); // slot 5
+        table.insert(makeKey(6, 0), 3); // slot 6
+        table.insert(makeKey(4, 1), 4); // slot 7
+        table.insert(makeKey(7, 0), 5); // slot 8
+        table.insert(makeKey(10, 0), 6); // slot 10
+
+        // The key in slot 4 goes: the keys of homes 3, 4 and 7 move back,
+        // the one of home 6 stays
+        table.expire(Before(1));
+        ASSERT_EQUALS(6UL, table.size());
+        assertFound(table, makeKey(3, 0), 1);
+        assertFound(table, makeKey(3, 1), 2);
+        assertFound(table, makeKey(6, 0), 3);
+        assertFound(table, makeKey(4, 1), 4);
+        assertFound(table, makeKey(7, 0), 5);
+        assertFound(table, makeKey(10, 0), 6);
+        ASSERT_TRUE(table.find(makeKey(4, 0)) == NULL);
+
+        // Then the head of the chain
+        table.expire(Before(2));
+        assertFound(table, makeKey(3, 1), 2);
+        assertFound(table, makeKey(6, 0), 3);
+        assertFound(table, makeKey(4, 1), 4);
+        assertFound(table, makeKey(7, 0), 5);
+        ASSERT_TRUE(table.find(makeKey(3, 0)) == NULL);
+
+        // And the rest, in a single call
+        table.expire(Before(6));
+        ASSERT_EQUALS(1UL, table.size());
+        assertFound(table, makeKey(10, 0), 6);
+        ASSERT_TRUE(table.find(makeKey(4, 1)) == NULL);
+        ASSERT_TRUE(table.find(makeKey(7, 0)) == NULL);
+    }
+
+    /// A key seen again since it was queued goes to the back of the ring
+    void test_requeue()
+    {
+        TestTable table;
+        uint64_t a = makeKey(1, 0), b = makeKey(1, 1), c = makeKey(2, 0);
+        table.insert(a, 1);
+        table.insert(b, 2);
+        table.insert(c, 3);
+        *table.find(a) = 5;
+
+        table.expire(Before(3));
+        ASSERT_EQUALS(2UL, table.size());
+        ASSERT_TRUE(table.find(b) == NULL);
+        assertFound(table, a, 5);
+        assertFound(table, c, 3);
+        vector<uint64_t> order = keys(table);
+        ASSERT_EQUALS(c, order[0]);
+        ASSERT_EQUALS(a, order[1]);
+
+        // Requeued again, then seen again after its new place was queued
+        *table.find(a) = 8;
+        table.expire(Before(6));
+        ASSERT_EQUALS(1UL, table.size());
+        assertFound(table, a, 8);
+        table.expire(Before(8));
+        assertFound(table, a, 8);
+        table.expire(Before(9));
+        ASSERT_TRUE(table.empty());
+        ASSERT_TRUE(table.find(a) == NULL);
+    }
+
+    /// The slots grow with the keys, and shrink by half on each expiry
+    /// until a table is at most one eighth full
+    void test_shrink()
+    {
+        TestTable table;
+        for (uint64_t i = 0; i < 1000; ++i) {
+            table.insert(makeKey(i * 7, 0), i);
+        }
+        ASSERT_EQUALS(2048UL, slotCount(table));
+
+        table.expire(Before(990));
+        ASSERT_EQUALS(10UL, table.size());
+        ASSERT_EQUALS(1024UL, slotCount(table));
+        for (int i = 0; i < 10; ++i) {
+            table.expire(Before(990));
+        }
+        ASSERT_EQUALS(64UL, slotCount(table));
+        for (uint64_t i = 990; i < 1000; ++i) {
+            assertFound(table, makeKey(i * 7, 0), i);
+        }
+        ASSERT_TRUE(table.find(makeKey(7, 0)) == NULL);
+
+        for (int i = 0; i < 10; ++i) {
+            table.expire(Before(1000));
+        }
+        ASSERT_TRUE(table.empty());
+        ASSERT_EQUALS(16UL, slotCount(table));
+
+        table.insert(makeKey(7, 0), 1);
+        assertFound(table, makeKey(7, 0), 1);
+        table.clear();
+        ASSERT_TRUE(table.empty());
+        ASSERT_TRUE(table.find(makeKey(7, 0)) == NULL);
+        ASSERT_EQUALS(16UL, slotCount(table));
+    }
+
+    /**
+     * Random updates and expiries over few fingerprints, compared with a
+     * model of the operator: a key is expired when the value it was
+     * queued with has expired, and requeued if its value has not
+     */
+    void test_random()
+    {
+        TestTable table;
+        map<uint64_t, int64> values;
+        deque<pair<uint64_t, int64> > queue;
+        int64 now = 0;
+        for (int step = 0; step < 20000; ++step) {
+            ++now;
+            uint64_t key = makeKey(rand() % 64, rand() % 8);
+            int64* value = table.find(key);
+            map<uint64_t, int64>::iterator it = values.find(key);
+            ASSERT_EQUALS_MSG("key " << key << " at step " << step, it != values.end(),
+                              value != NULL);
+            if (value) {
+                ASSERT_EQUALS(it->second, *value);
+                *value = now;
+                it->second = now;
+            } else {
+                table.insert(key, now);
+                values[key] = now;
+                queue.push_back(make_pair(key, now));
+            }
+
+            // The window varies, so that the table grows and shrinks
+            int64 window = (step / 2000) % 2 ? 400 : 20;
+            Before expired(now - window);
+            table.expire(expired);
+            while (!queue.empty() && expired(queue.front().second)) {
+                pair<uint64_t, int64> oldest = queue.front();
+                queue.pop_front();
+                if (expired(values[oldest.first])) {
+                    values.erase(oldest.first);
+                } else {
+                    queue.push_back(make_pair(oldest.first, values[oldest.first]));
+                }
+            }
+
+            ASSERT_EQUALS_MSG("size at step " << step, values.size(), table.size());
+            TestTable::const_iterator entry = table.begin();
+            for (size_t i = 0; i < queue.size(); ++i, ++entry) {
+                ASSERT_EQUALS(queue[i].first, entry->key);
+            }
+        }
+        for (map<uint64_t, int64>::iterator it = values.begin(); it != values.end(); ++it) {
+            assertFound(table, it->first, it->second);
+        }
+    }
+
+    /// Keys restored from a checkpoint keep their order and values
+    void test_checkpoint()
+    {
+        typedef ExpiringKeys::Table<rstring, int64> StringTable;
+        StringTable table;
+        table.insert("a", 1);
+        table.insert("b", 2);
+        table.insert("c", 3);
+        *table.find("a") = 4;
+        table.expire(Before(3)); // a is requeued, b expires
+
+        NativeByteBuffer buffer;
+        ExpiringKeys::checkpointKeys(buffer, table);
+        StringTable restored;
+        ASSERT_TRUE(ExpiringKeys::resetKeys(buffer, restored));
+        ASSERT_EQUALS(2UL, restored.size());
+        StringTable::const_iterator it = restored.begin();
+        ASSERT_EQUALS(rstring("c"), it->key);
+        ASSERT_EQUALS(3, it->value);
+        ++it;
+        ASSERT_EQUALS(rstring("a"), it->key);
+        ASSERT_EQUALS(4, it->value);
+        ASSERT_EQUALS(4, *restored.find("a"));
+        ASSERT_TRUE(restored.find("b") == NULL);
+
+        // The entries are queued with their values when restored
+        restored.expire(Before(4));
+        ASSERT_EQUALS(1UL, restored.size());
+        ASSERT_TRUE(restored.find("c") == NULL);
+
+        // An empty table
+        NativeByteBuffer empty;
+        ExpiringKeys::checkpointKeys(empty, StringTable());
+        StringTable none;
+        ASSERT_TRUE(ExpiringKeys::resetKeys(empty, none));
+        ASSERT_TRUE(none.empty());
+    }
+
+    /// Checkpoints of fingerprints start with a marker: they are restored
+    /// by tables of fingerprints only, which also restore checkpoints of keys
+    void test_fingerprints()
+    {
+        typedef ExpiringKeys::Table<uint64_t, int64, ExpiringKeys::Identity> FingerprintTable;
+        ExpiringKeys::Fingerprint<rstring> fingerprint;
+        FingerprintTable table;
+        table.insert(fingerprint("a"), 1);
+        table.insert(fingerprint("b"), 2);
+
+        NativeByteBuffer buffer;
+        ExpiringKeys::checkpointFingerprints(buffer, table);
+        ASSERT_EQUALS(ExpiringKeys::fingerprintsMarker, buffer.getUInt32());
+        ASSERT_EQUALS(2U, buffer.getUInt32());
+
+        NativeByteBuffer fingerprints;
+        ExpiringKeys::checkpointFingerprints(fingerprints, table);
+        ExpiringKeys::Table<rstring, int64> keyTable;
+        ASSERT_TRUE(!ExpiringKeys::resetKeys(fingerprints, keyTable));
+        ASSERT_TRUE(keyTable.empty());
+
+        fingerprints.setOCursor(0);
+        FingerprintTable restored;
+        ExpiringKeys::resetFingerprints<rstring>(fingerprints, restored, fingerprint);
+        ASSERT_EQUALS(2UL, restored.size());
+        ASSERT_EQUALS(1, *restored.find(fingerprint("a")));
+        ASSERT_EQUALS(2, *restored.find(fingerprint("b")));
+        ASSERT_EQUALS(fingerprint("a"), restored.begin()->key);
+
+        // A checkpoint of keys, taken with approximate false
+        keyTable.insert("x", 5);
+        keyTable.insert("y", 6);
+        NativeByteBuffer keys;
+        ExpiringKeys::checkpointKeys(keys, keyTable);
+        FingerprintTable fromKeys;
+        ExpiringKeys::resetFingerprints<rstring>(keys, fromKeys, fingerprint);
+        ASSERT_EQUALS(2UL, fromKeys.size());
+        ASSERT_EQUALS(5, *fromKeys.find(fingerprint("x")));
+        ASSERT_EQUALS(6, *fromKeys.find(fingerprint("y")));
+        ASSERT_TRUE(fromKeys.find(fingerprint("a")) == NULL);
+
+        // Keys with the same fingerprint, here the same key twice, keep
+        // the newest value
+        NativeByteBuffer same;
+        same << static_cast<uint32_t>(2) << rstring("x") << static_cast<int64>(5) << rstring("x")
+             << static_cast<int64>(7);
+        FingerprintTable fromSame;
+        ExpiringKeys::resetFingerprints<rstring>(same, fromSame, fingerprint);
+        ASSERT_EQUALS(1UL, fromSame.size());
+        ASSERT_EQUALS(7, *fromSame.find(fingerprint("x")));
+    }
+};
+} // end namespace SPL
+
+MAIN_APP(SPL::ExpiringKeysTest)
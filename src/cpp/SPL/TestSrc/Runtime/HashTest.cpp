@@ -0,0 +1,373 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <SPL/Runtime/Type/SPLType.h>
+#include <SPL/Runtime/Utility/Hash.h>
+#include <SPL/TestSrc/Utility/TestUtils.h>
+
+#include <unicode/unistr.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <time.h>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace Distillery;
+
+namespace SPL {
+
+/// Nanoseconds since an arbitrary point
+static uint64_t nowNanos()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+/// Hash codes of the earlier releases, as computed by the SPL types when
+/// ENABLE_SPL_FAST_HASH is not set
+struct LegacyHash : public Hash::Legacy
+{
+    static size_t hashUChars(UChar const* data, int32_t length)
+    {
+        return icu::UnicodeString(false, reinterpret_cast< ::UChar const*>(data), length)
+          .hashCode();
+    }
+
+    static size_t hashBlob(unsigned char const* data, uint64_t size)
+    {
+        size_t r = 17;
+        std::tr1::hash<size_t> hs;
+        for (uint64_t i = 0; i < size; ++i) {
+            r = combine(r, hs(data[i]));
+        }
+        return r;
+    }
+};
+
+/// Hash codes computed by the SPL types when ENABLE_SPL_FAST_HASH is 1
+struct FastHash : public Hash::Fast
+{
+    static size_t hashUChars(UChar const* data, int32_t length)
+    {
+        return static_cast<size_t>(Hash::hashBytes(data, length * sizeof(UChar)));
+    }
+
+    static size_t hashBlob(unsigned char const* data, uint64_t size)
+    {
+        return static_cast<size_t>(Hash::hashBytes(data, size));
+    }
+};
+
+#if ENABLE_SPL_FAST_HASH
+typedef FastHash ActiveHash;
+#else
+typedef LegacyHash ActiveHash;
+#endif
+
+/**
+ * Hash codes of the SPL types with either set of hash functions, computed
+ * the way the types compute them.  A std::pair stands for a generated
+ * tuple type with two attributes.
+ */
+template<typename Scheme>
+struct Hasher
+{
+    static size_t hash(int32 v) { return std::tr1::hash<int32>()(v); }
+
+    static size_t hash(int64 v) { return std::tr1::hash<int64>()(v); }
+
+    static size_t hash(rstring const& s) { return Scheme::hashChars(s.c_str(), s.size()); }
+
+    static size_t hash(ustring const& s) { return Scheme::hashUChars(s.getBuffer(), s.length()); }
+
+    static size_t hash(blob const& b) { return Scheme::hashBlob(b.getData(), b.getSize()); }
+
+    template<typename T>
+    static size_t hash(list<T> const& l)
+    {
+        size_t r = 17;
+        for (typename list<T>::const_iterator it = l.begin(); it != l.end(); ++it) {
+            r = Scheme::combine(r, hash(*it));
+        }
+        return r;
+    }
+
+    template<typename K>
+    static size_t hash(set<K> const& s)
+    {
+        size_t r = 17;
+        for (typename set<K>::const_iterator it = s.begin(); it != s.end(); ++it) {
+            r = Scheme::combineUnordered(r, hash(*it));
+        }
+        return r;
+    }
+
+    template<typename K, typename V>
+    static size_t hash(map<K, V> const& m)
+    {
+        size_t r = 17;
+        for (typename map<K, V>::const_iterator it = m.begin(); it != m.end(); ++it) {
+            r = Scheme::combineUnordered(r, hash(it->first), hash(it->second));
+        }
+        return r;
+    }
+
+    // As the hashCode of the generated tuple types
+    template<typename A, typename B>
+    static size_t hash(std::pair<A, B> const& t)
+    {
+        size_t s = 17;
+        s = Scheme::combine(s, hash(t.first));
+        s = Scheme::combine(s, hash(t.second));
+        return s;
+    }
+};
+
+/// Distribution and speed of a hash function over a set of keys
+struct HashStats
+{
+    double chiSquare;  // chi-square of the bucket counts, per degree of freedom
+    size_t collisions; // keys with the same full hash code as another key
+    double nanos;      // nanoseconds per key
+};
+
+/**
+ * Benchmark of the hash codes of the SPL types, comparing the hash
+ * functions of the earlier releases with the ones used when
+ * ENABLE_SPL_FAST_HASH is set.
+ *
+ * For each set of keys the test prints, for both sets of hash functions:
+ * - the chi-square of the number of keys per bucket, for a table of
+ *   2^bucketBits buckets indexed by the low bits of the hash code, divided
+ *   by its degrees of freedom: about 1 for a uniform distribution,
+ * - the number of full hash code collisions,
+ * - the time to hash a key.
+ *
+ * It checks that the fast hash functions distribute the keys uniformly and
+ * without collisions, and that the hash codes of the SPL types are the ones
+ * of the active setting.
+ */
+class HashTest : public TestBase
+{
+  public:
+    HashTest() {}
+
+  private:
+    enum
+    {
+        keyCount = 1 << 18,
+        bucketBits = 14,
+        rounds = 10
+    };
+
+    void runTests()
+    {
+        srand(17);
+        test_rstring();
+        test_ustring();
+        test_blob();
+        test_collections();
+        test_tuples();
+    }
+
+    template<typename Scheme, typename T>
+    static HashStats measure(vector<T> const& keys)
+    {
+        HashStats stats;
+        vector<size_t> hashes(keys.size());
+        vector<uint32_t> buckets(1 << bucketBits, 0);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            hashes[i] = Hasher<Scheme>::hash(keys[i]);
+            ++buckets[hashes[i] & ((1 << bucketBits) - 1)];
+        }
+
+        double expected = static_cast<double>(keys.size()) / buckets.size();
+        double chiSquare = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            double d = buckets[i] - expected;
+            chiSquare += d * d / expected;
+        }
+        stats.chiSquare = chiSquare / (buckets.size() - 1);
+
+        std::sort(hashes.begin(), hashes.end());
+        stats.collisions = hashes.end() - std::unique(hashes.begin(), hashes.end());
+
+        size_t sum = 0;
+        uint64_t begin = nowNanos();
+        for (int round = 0; round < rounds; ++round) {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                sum += Hasher<Scheme>::hash(keys[i]);
+            }
+        }
+        stats.nanos = static_cast<double>(nowNanos() - begin) / (rounds * keys.size());
+
+        // Keep the compiler from dropping the loop
+        volatile size_t sink = sum;
+        (void)sink;
+        return stats;
+    }
+
+    static void print(HashStats const& stats)
+    {
+        cout << " chi2/df " << setw(10) << stats.chiSquare << " collisions " << setw(6)
+             << stats.collisions << " ns/key " << setw(7) << stats.nanos;
+    }
+
+    /// Measure both sets of hash functions, and check the fast ones
+    template<typename T>
+    void compare(string const& name, vector<T> const& keys)
+    {
+        HashStats legacy = measure<LegacyHash>(keys);
+        HashStats fast = measure<FastHash>(keys);
+        cout << fixed << setprecision(2) << left << setw(24) << name << right << " legacy:";
+        print(legacy);
+        cout << "  fast:";
+        print(fast);
+        cout << endl;
+
+        // A uniform distribution gives 1 +- 0.03 with 2^14 buckets
+        ASSERT_TRUE_MSG(name << ": chi2/df " << fast.chiSquare, fast.chiSquare < 1.25);
+        ASSERT_EQUALS_MSG(name << ": collisions", 0UL, fast.collisions);
+    }
+
+    /// Check that the SPL type computes the hash codes of the active setting
+    template<typename T>
+    void assertActive(string const& name, vector<T> const& keys)
+    {
+        for (size_t i = 0; i < keys.size(); i += 97) {
+            ASSERT_EQUALS_MSG(name << " key " << i, Hasher<ActiveHash>::hash(keys[i]),
+                              std::tr1::hash<T>()(keys[i]));
+        }
+    }
+
+    static string keyName(char const* prefix, size_t i)
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%s%lu", prefix, static_cast<unsigned long>(i));
+        return buf;
+    }
+
+    static string randomString(size_t size)
+    {
+        string s(size, ' ');
+        for (size_t i = 0; i < size; ++i) {
+            s[i] = static_cast<char>('!' + rand() % 94);
+        }
+        return s;
+    }
+
+    /// Short keys which differ in their last characters, and random keys
+    void test_rstring()
+    {
+        vector<rstring> names, randoms;
+        for (size_t i = 0; i < keyCount; ++i) {
+            names.push_back(keyName("key", i));
+            randoms.push_back(randomString(24));
+        }
+        compare("rstring key<N>", names);
+        compare("rstring random 24", randoms);
+        assertActive("rstring", names);
+        assertActive("rstring", randoms);
+    }
+
+    void test_ustring()
+    {
+        vector<ustring> names;
+        for (size_t i = 0; i < keyCount; ++i) {
+            names.push_back(ustring::fromUTF8(keyName("key", i)));
+        }
+        compare("ustring key<N>", names);
+        assertActive("ustring", names);
+    }
+
+    /// Counters, little-endian, over 8 and 16 bytes
+    void test_blob()
+    {
+        vector<blob> shorts, longs;
+        for (size_t i = 0; i < keyCount; ++i) {
+            unsigned char bytes[16];
+            memset(bytes, 0, sizeof(bytes));
+            for (size_t b = 0; b < sizeof(uint32_t); ++b) {
+                bytes[b] = static_cast<unsigned char>(i >> (8 * b));
+            }
+            shorts.push_back(blob(bytes, 8));
+            longs.push_back(blob(bytes, 16));
+        }
+        compare("blob counter 8", shorts);
+        compare("blob counter 16", longs);
+        assertActive("blob", shorts);
+        assertActive("blob", longs);
+    }
+
+    void test_collections()
+    {
+        vector<list<int32> > intLists;
+        vector<list<rstring> > stringLists;
+        vector<set<int32> > sets;
+        vector<map<rstring, int32> > maps;
+        for (size_t i = 0; i < keyCount; ++i) {
+            list<int32> l;
+            l.push_back(i >> 9);
+            l.push_back(i & 511);
+            intLists.push_back(l);
+
+            list<rstring> ls;
+            ls.push_back(keyName("a", i % 1000));
+            ls.push_back(keyName("b", i / 1000));
+            stringLists.push_back(ls);
+
+            set<int32> s;
+            s.insert(i);
+            s.insert(i + keyCount);
+            sets.push_back(s);
+
+            map<rstring, int32> m;
+            m.insert(std::make_pair(rstring(keyName("k", i)), static_cast<int32>(i & 7)));
+            maps.push_back(m);
+        }
+        compare("list<int32> [i/512,i%512]", intLists);
+        compare("list<rstring>", stringLists);
+        compare("set<int32>", sets);
+        compare("map<rstring,int32>", maps);
+        assertActive("list<int32>", intLists);
+        assertActive("list<rstring>", stringLists);
+        assertActive("set<int32>", sets);
+        assertActive("map<rstring,int32>", maps);
+    }
+
+    /// Tuples of two attributes, as used for partition and join keys
+    void test_tuples()
+    {
+        vector<std::pair<int32, int32> > ints;
+        vector<std::pair<rstring, int64> > mixed;
+        for (size_t i = 0; i < keyCount; ++i) {
+            ints.push_back(std::make_pair(static_cast<int32>(i >> 9), static_cast<int32>(i & 511)));
+            mixed.push_back(std::make_pair(rstring(keyName("user", i % 4096)),
+                                           static_cast<int64>(i / 4096)));
+        }
+        compare("tuple<int32,int32>", ints);
+        compare("tuple<rstring,int64>", mixed);
+    }
+};
+} // end namespace SPL
+
+MAIN_APP(SPL::HashTest)
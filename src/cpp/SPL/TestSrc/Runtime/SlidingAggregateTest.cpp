@@ -0,0 +1,295 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WindowTestCommon.h"
+#include <SPL/Runtime/Operator/Operator.h>
+#include <SPL/Toolkit/SlidingAggregate.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+using namespace Distillery;
+
+namespace SPL {
+
+/// Partial aggregates of the ages of consecutive tuples, as kept by the
+/// Aggregate operator for sliding windows
+struct AgePartial
+{
+    SlidingAggregate::Count<uint64> count;
+    SlidingAggregate::First<int32, int32> first;
+    SlidingAggregate::Last<int32, int32> last;
+    SlidingAggregate::Min<int32, int32> min;
+    SlidingAggregate::Max<int32, int32> max;
+    SlidingAggregate::Sum<int32, int64> sum;
+    SlidingAggregate::Average<float64, float64> average;
+
+    void lift(TType const& tuple)
+    {
+        int32 age = tuple.get_age();
+        count.lift();
+        first.lift(age);
+        last.lift(age);
+        min.lift(age);
+        max.lift(age);
+        sum.lift(age);
+        average.lift(age);
+    }
+
+    void combine(AgePartial const& newer)
+    {
+        count.combine(newer.count);
+        first.combine(newer.first);
+        last.combine(newer.last);
+        min.combine(newer.min);
+        max.combine(newer.max);
+        sum.combine(newer.sum);
+        average.combine(newer.average);
+    }
+};
+
+/**
+ * Aggregates the ages of the tuples of a sliding window both incrementally,
+ * the way the Aggregate operator does, and in full over the window contents
+ * on each trigger, and counts the triggers where they differ.
+ *
+ * As in the operator, the partial of a tuple is pushed when the tuple is
+ * inserted, and the oldest partial is popped when a tuple is evicted.  The
+ * handler also counts the evictions of a tuple other than the oldest one,
+ * which break that assumption.
+ */
+class AgeAggregator : public WindowEvent<TType>
+{
+  public:
+    AgeAggregator()
+      : triggers_(0)
+      , mismatches_(0)
+      , unordered_(0)
+    {}
+
+    void afterTupleInsertionEvent(WindowType& window, TupleType& tuple, PartitionType const&)
+    {
+        inserted(tuple);
+    }
+
+    void beforeTupleEvictionEvent(WindowType& window, TupleType& tuple, PartitionType const&)
+    {
+        evicted(tuple);
+    }
+
+    void onWindowTriggerEvent(WindowType& window, PartitionType const& partition)
+    {
+        triggered(window.getWindowData(partition));
+    }
+
+    void inserted(TType const& tuple)
+    {
+        AgePartial partial;
+        partial.lift(tuple);
+        sliding_.push(partial);
+        order_.push_back(tuple.get_time().getSeconds());
+    }
+
+    void evicted(TType const& tuple)
+    {
+        std::deque<int64>::iterator it = std::find(order_.begin(), order_.end(),
+                                                   tuple.get_time().getSeconds());
+        FASSERT(it != order_.end());
+        if (it != order_.begin()) {
+            ++unordered_;
+        }
+        order_.erase(it);
+        sliding_.pop();
+    }
+
+    template<typename Data>
+    void triggered(Data const& data)
+    {
+        ++triggers_;
+        if (data.empty()) {
+            return;
+        }
+        AgePartial partial;
+        sliding_.query(partial);
+
+        int32 first = data.front().get_age(), last = data.back().get_age();
+        int32 min = first, max = first;
+        int64 sum = 0;
+        for (typename Data::const_iterator it = data.begin(); it != data.end(); ++it) {
+            int32 age = it->get_age();
+            min = std::min(min, age);
+            max = std::max(max, age);
+            sum += age;
+        }
+        float64 average = static_cast<float64>(sum) / data.size();
+
+        bool same = partial.count() == data.size() && partial.first() == first &&
+                    partial.last() == last && partial.min() == min && partial.max() == max &&
+                    partial.sum() == sum && std::fabs(partial.average() - average) < 1e-6;
+        if (!same) {
+            SPCDBG(L_DEBUG,
+                   "Trigger " << triggers_ << ": incremental count=" << partial.count()
+                              << " sum=" << partial.sum() << ", full count=" << data.size()
+                              << " sum=" << sum,
+                   WINLIB_TEST);
+            ++mismatches_;
+        }
+    }
+
+    uint32_t triggers_;   // number of triggers
+    uint32_t mismatches_; // triggers where the incremental and full aggregates differ
+    uint32_t unordered_;  // evictions of a tuple other than the oldest
+
+  private:
+    SlidingAggregate::TwoStacks<AgePartial> sliding_;
+    std::deque<int64> order_; // sequence numbers of the tuples, in insertion order
+};
+
+/**
+ * Compare the incremental aggregation of sliding windows used by the
+ * Aggregate operator with a full re-aggregation of the window contents.
+ *
+ * Count and time based eviction evict the oldest tuple, so the two agree.
+ * Delta based eviction may evict tuples from the middle of the window when
+ * the delta attribute is not monotonic, which is why the operator
+ * aggregates windows with a delta eviction policy in full.
+ */
+class SlidingAggregateTest : public WindowTestBase
+{
+  public:
+    SlidingAggregateTest()
+      : tupleCount(2000)
+    {}
+
+  private:
+    const int tupleCount;
+
+    void runTests()
+    {
+        srand(17);
+        test_count();
+        test_time();
+        test_delta(true);
+        test_delta(false);
+    }
+
+    /// Random age in [0, 100)
+    static int32 randomAge() { return rand() % 100; }
+
+    static TType makeTuple(int64 seq, int32 age)
+    {
+        TType tuple;
+        tuple.get_age() = age;
+        tuple.get_time() = timestamp(seq, 0);
+        return tuple;
+    }
+
+    /// Sliding window with count based eviction, triggered on every tuple
+    void test_count()
+    {
+        SPCDBG_ENTER(WINLIB_TEST);
+        Operator& oper = *((Operator*)NULL);
+        CountWindowPolicy evict(10);
+        CountWindowPolicy trigger(1);
+        SlidingWindow<TType> win(oper, 0, evict, trigger);
+        AgeAggregator aggregator;
+        win.registerAfterTupleInsertionHandler(&aggregator);
+        win.registerBeforeTupleEvictionHandler(&aggregator);
+        win.registerOnWindowTriggerHandler(&aggregator);
+
+        for (int i = 0; i < tupleCount; ++i) {
+            win.insert(makeTuple(i, randomAge()));
+        }
+        ASSERT_EQUALS(static_cast<uint32_t>(tupleCount), aggregator.triggers_);
+        ASSERT_EQUALS(0U, aggregator.unordered_);
+        ASSERT_EQUALS(0U, aggregator.mismatches_);
+        SPCDBG_EXIT(WINLIB_TEST);
+    }
+
+    /**
+     * Sliding window with time based eviction. A time based window runs
+     * its eviction on a thread of the operator, which is not available
+     * here: the test evicts the tuples older than the window size in
+     * arrival order, as TimeStarSlidingWindowImpl does, on a simulated
+     * clock.
+     */
+    void test_time()
+    {
+        SPCDBG_ENTER(WINLIB_TEST);
+        const double size = 2.0;
+        std::deque<TType> data;
+        std::deque<double> arrivals;
+        AgeAggregator aggregator;
+        double now = 0;
+
+        for (int i = 0; i < tupleCount; ++i) {
+            now += (rand() % 100) / 100.0;
+            while (!data.empty() && now - arrivals.front() > size) {
+                aggregator.evicted(data.front());
+                data.pop_front();
+                arrivals.pop_front();
+            }
+            data.push_back(makeTuple(i, randomAge()));
+            arrivals.push_back(now);
+            aggregator.inserted(data.back());
+            aggregator.triggered(data);
+        }
+        ASSERT_EQUALS(static_cast<uint32_t>(tupleCount), aggregator.triggers_);
+        ASSERT_EQUALS(0U, aggregator.unordered_);
+        ASSERT_EQUALS(0U, aggregator.mismatches_);
+        SPCDBG_EXIT(WINLIB_TEST);
+    }
+
+    /**
+     * Sliding window with delta based eviction on the age, triggered on
+     * every tuple.
+     * @param monotonic whether the ages are non-decreasing
+     */
+    void test_delta(bool monotonic)
+    {
+        SPCDBG_ENTER(WINLIB_TEST);
+        Operator& oper = *((Operator*)NULL);
+        DeltaWindowPolicy<TType, TType::age_type, &TType::get_age> evict(5);
+        CountWindowPolicy trigger(1);
+        SlidingWindow<TType> win(oper, 0, evict, trigger);
+        AgeAggregator aggregator;
+        win.registerAfterTupleInsertionHandler(&aggregator);
+        win.registerBeforeTupleEvictionHandler(&aggregator);
+        win.registerOnWindowTriggerHandler(&aggregator);
+
+        int32 age = 0;
+        for (int i = 0; i < tupleCount; ++i) {
+            age = monotonic ? age + rand() % 3 : randomAge();
+            win.insert(makeTuple(i, age));
+        }
+        ASSERT_EQUALS(static_cast<uint32_t>(tupleCount), aggregator.triggers_);
+        if (monotonic) {
+            ASSERT_EQUALS(0U, aggregator.unordered_);
+            ASSERT_EQUALS(0U, aggregator.mismatches_);
+        } else {
+            // Tuples are evicted from the middle of the window: popping the
+            // oldest partial gives a wrong aggregate
+            ASSERT_TRUE(aggregator.unordered_ > 0);
+            ASSERT_TRUE(aggregator.mismatches_ > 0);
+        }
+        SPCDBG_EXIT(WINLIB_TEST);
+    }
+};
+} // end namespace SPL
+
+MAIN_APP(SPL::SlidingAggregateTest)
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WindowTestCommon.h"
+#include <SPL/Runtime/Operator/Operator.h>
+#include <SPL/Toolkit/SortedWindow.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace Distillery;
+
+namespace SPL {
+
+/// Orders the tuples by age only, so that tuples of the same age are equal
+struct AgeCompare
+{
+    bool operator()(TType const& lhs, TType const& rhs) const
+    {
+        return lhs.get_age() < rhs.get_age();
+    }
+};
+
+/// Orders the tuples by age, then by arrival
+static bool stableLess(TType const& lhs, TType const& rhs)
+{
+    if (lhs.get_age() != rhs.get_age()) {
+        return lhs.get_age() < rhs.get_age();
+    }
+    return lhs.get_time() < rhs.get_time();
+}
+
+/**
+ * Keeps the index of a sliding window, as the Sort operator does, and
+ * records the tuples the window evicts.
+ */
+class SortHandler : public WindowEvent<TType>
+{
+  public:
+    typedef SortedWindow::Index<TType, AgeCompare> IndexType;
+
+    SortHandler()
+      : index_(AgeCompare())
+    {}
+
+    void afterTupleInsertionEvent(WindowType& window, TupleType& tuple, PartitionType const&)
+    {
+        index_.push(tuple);
+    }
+
+    void beforeTupleEvictionEvent(WindowType& window, TupleType& tuple, PartitionType const& partition)
+    {
+        // The smallest tuple, which the window must evict
+        WindowType::DataType& data = window.getWindowData(partition);
+        TType smallest = *std::min_element(data.begin(), data.end(), stableLess);
+
+        // The tuple is the front of the data, where the index moves the
+        // smallest tuple
+        index_.popSmallest(data);
+        ASSERT_TRUE(&tuple == &data.front());
+        ASSERT_EQUALS(smallest.get_age(), tuple.get_age());
+        ASSERT_EQUALS(smallest.get_time(), tuple.get_time());
+        evicted_.push_back(tuple);
+    }
+
+    IndexType index_;
+    vector<TType> evicted_;
+};
+
+/**
+ * Test of the index which keeps the sliding windows of the Sort operator
+ * in order, and of the sort of tumbling windows.
+ */
+class SortedWindowTest : public WindowTestBase
+{
+  public:
+    SortedWindowTest() {}
+
+  private:
+    void runTests()
+    {
+        srand(17);
+        test_insertion(100, 20);
+        test_insertion(100, 1000);
+        test_eviction(50, 20);
+        test_eviction(1, 20);
+        test_clear();
+        test_sortRuns();
+    }
+
+    static TType makeTuple(int64 seq, int32 age)
+    {
+        TType tuple;
+        tuple.get_age() = age;
+        tuple.get_time() = timestamp(seq, 0);
+        return tuple;
+    }
+
+    /// Check that the index holds the tuples of the data, in order
+    template<typename Data>
+    void assertSorted(SortHandler::IndexType const& index, Data const& data)
+    {
+        ASSERT_EQUALS(data.size(), index.size());
+        vector<TType> expected(data.begin(), data.end());
+        std::sort(expected.begin(), expected.end(), stableLess);
+        size_t i = 0;
+        for (SortHandler::IndexType::const_iterator it = index.begin(); it != index.end();
+             ++it, ++i) {
+            ASSERT_TRUE(i < expected.size());
+            ASSERT_EQUALS_MSG("age at " << i, expected[i].get_age(), (*it).get_age());
+            ASSERT_EQUALS_MSG("arrival at " << i, expected[i].get_time(), (*it).get_time());
+        }
+        ASSERT_EQUALS(expected.size(), i);
+    }
+
+    /**
+     * Tuples inserted without eviction are indexed in order, and tuples
+     * of the same age in insertion order.
+     * @param count number of tuples
+     * @param ages number of distinct ages
+     */
+    void test_insertion(int count, int ages)
+    {
+        SPCDBG_ENTER(WINLIB_TEST);
+        SortHandler::IndexType index((AgeCompare()));
+        std::deque<TType> data;
+        for (int i = 0; i < count; ++i) {
+            data.push_back(makeTuple(i, rand() % ages));
+            index.push(data.back());
+            assertSorted(index, data);
+        }
+        SPCDBG_EXIT(WINLIB_TEST);
+    }
+
+    /**
+     * Count-based sliding window: each eviction takes the smallest tuple,
+     * and the index keeps the tuples left in the window in order.
+     * @param size window size
+     * @param ages number of distinct ages
+     */
+    void test_eviction(uint32_t size, int ages)
+    {
+        SPCDBG_ENTER(WINLIB_TEST);
+        Operator& oper = *((Operator*)NULL);
+        CountWindowPolicy evict(size);
+        CountWindowPolicy trigger(1);
+        SlidingWindow<TType> win(oper, 0, evict, trigger);
+        SortHandler handler;
+        win.registerAfterTupleInsertionHandler(&handler);
+        win.registerBeforeTupleEvictionHandler(&handler);
+
+        const int count = 2000;
+        for (int i = 0; i < count; ++i) {
+            win.insert(makeTuple(i, rand() % ages));
+            assertSorted(handler.index_, win.getWindowData(0));
+        }
+        ASSERT_EQUALS(static_cast<size_t>(count - size), handler.evicted_.size());
+        SPCDBG_EXIT(WINLIB_TEST);
+    }
+
+    /// A cleared index starts over, and may be copied when empty
+    void test_clear()
+    {
+        SPCDBG_ENTER(WINLIB_TEST);
+        SortHandler::IndexType index((AgeCompare()));
+        std::deque<TType> data;
+        for (int i = 0; i < 10; ++i) {
+            data.push_back(makeTuple(i, rand() % 5));
+            index.push(data.back());
+        }
+        index.popSmallest(data);
+        data.pop_front();
+        index.clear();
+        data.clear();
+        ASSERT_TRUE(index.empty());
+        ASSERT_TRUE(index.begin() == index.end());
+
+        SortHandler::IndexType copy(index);
+        for (int i = 0; i < 10; ++i) {
+            data.push_back(makeTuple(i, rand() % 5));
+            copy.push(data.back());
+        }
+        assertSorted(copy, data);
+        while (!data.empty()) {
+            TType smallest = *std::min_element(data.begin(), data.end(), stableLess);
+            copy.popSmallest(data);
+            ASSERT_EQUALS(smallest.get_time(), data.front().get_time());
+            data.pop_front();
+            assertSorted(copy, data);
+        }
+        SPCDBG_EXIT(WINLIB_TEST);
+    }
+
+    /// Sort of the tumbling windows, by merging runs or with std::sort
+    void test_sortRuns()
+    {
+        SPCDBG_ENTER(WINLIB_TEST);
+        const int size = 1000;
+        for (int shape = 0; shape < 6; ++shape) {
+            vector<int> values;
+            for (int i = 0; i < size; ++i) {
+                switch (shape) {
+                    case 0: // sorted
+                        values.push_back(i);
+                        break;
+                    case 1: // reversed
+                        values.push_back(size - i);
+                        break;
+                    case 2: // a few runs
+                        values.push_back(i % 300);
+                        break;
+                    case 3: // almost sorted
+                        values.push_back(i + rand() % 3);
+                        break;
+                    case 4: // random
+                        values.push_back(rand() % 100);
+                        break;
+                    default: // equal
+                        values.push_back(7);
+                        break;
+                }
+            }
+            vector<int> expected(values);
+            std::sort(expected.begin(), expected.end());
+            SortedWindow::sortRuns(values.begin(), values.end(), std::less<int>());
+            ASSERT_TRUE_MSG("shape " << shape, values == expected);
+        }
+
+        // Empty and single element ranges
+        vector<int> values;
+        SortedWindow::sortRuns(values.begin(), values.end(), std::less<int>());
+        values.push_back(1);
+        SortedWindow::sortRuns(values.begin(), values.end(), std::less<int>());
+        ASSERT_EQUALS(1, values[0]);
+        SPCDBG_EXIT(WINLIB_TEST);
+    }
+};
+} // end namespace SPL
+
+MAIN_APP(SPL::SortedWindowTest)
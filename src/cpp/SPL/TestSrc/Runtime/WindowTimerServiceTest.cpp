@@ -0,0 +1,244 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <SPL/Runtime/Window/WindowTimerService.h>
+#include <SPL/TestSrc/Utility/TestUtils.h>
+
+#include <boost/atomic.hpp>
+
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace Distillery;
+
+namespace SPL {
+
+/// Test tracing aspect
+const static std::string TIMER_TEST = ":::WinTimerTest";
+
+/// Milliseconds since an arbitrary point
+static uint64_t nowMillis()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / (1000 * 1000);
+}
+
+/**
+ * Task which records the times it fires at, and asks to be run again
+ * after each of the delays it was given.
+ */
+class RecordingTask : public WindowTimerTask
+{
+  public:
+    RecordingTask(vector<double> const& delays = vector<double>(), uint32_t fireMillis = 0)
+      : delays_(delays)
+      , fireMillis_(fireMillis)
+      , start_(0)
+      , next_(0)
+      , inFire_(false)
+    {}
+
+    /// Schedule the task and start recording its runs
+    void schedule(WindowTimerService& service, double delay)
+    {
+        start_ = nowMillis();
+        fires_.clear();
+        next_ = 0;
+        service.schedule(*this, delay);
+    }
+
+    bool fireTimer(double& delay)
+    {
+        inFire_ = true;
+        fires_.push_back(nowMillis() - start_);
+        if (fireMillis_ > 0) {
+            usleep(fireMillis_ * 1000);
+        }
+        inFire_ = false;
+        if (next_ == delays_.size()) {
+            return false;
+        }
+        delay = delays_[next_++];
+        return true;
+    }
+
+    /// Times the task fired at, in milliseconds since it was scheduled
+    vector<uint64_t> const& fires() const { return fires_; }
+
+    /// Check if the task is being fired
+    bool inFire() const { return inFire_; }
+
+  private:
+    vector<double> delays_;
+    uint32_t fireMillis_;
+    uint64_t start_;
+    size_t next_;
+    vector<uint64_t> fires_;
+    boost::atomic<bool> inFire_;
+};
+
+/**
+ * Tests of the timer service shared by the time-based windows.
+ */
+class WindowTimerServiceTest : public TestBase
+{
+  public:
+    WindowTimerServiceTest()
+      : service_(2)
+    {}
+
+  private:
+    /// A task may fire up to a tick early, and a loaded host makes it late
+    enum
+    {
+        earlyMillis = 1,
+        lateMillis = 500
+    };
+
+    void runTests()
+    {
+        service_.start();
+        test_levels();
+        test_cancel();
+        test_cancelRunning();
+        test_rearm();
+        test_shutdown();
+        service_.joinThreads();
+    }
+
+    /// Check that a task fired once, after the specified delay
+    void assertFiredAfter(RecordingTask const& task, double delay)
+    {
+        uint64_t millis = static_cast<uint64_t>(delay * 1000);
+        ASSERT_EQUALS_MSG("fires of the task due after " << delay << "s", 1UL,
+                          task.fires().size());
+        uint64_t fired = task.fires()[0];
+        ASSERT_TRUE_MSG("task due after " << delay << "s fired after " << fired << "ms",
+                        fired + earlyMillis >= millis && fired <= millis + lateMillis);
+    }
+
+    /**
+     * Tasks due at the boundaries of the wheel levels: the ones due after
+     * 64 ticks or more are cascaded down from the upper levels before they
+     * fire.
+     */
+    void test_levels()
+    {
+        SPCDBG_ENTER(TIMER_TEST);
+        double delays[] = { 0, 0.005, 0.063, 0.064, 0.065, 0.127, 0.2, 1.0, 4.095, 4.2 };
+        size_t count = sizeof(delays) / sizeof(delays[0]);
+        vector<RecordingTask*> tasks;
+        for (size_t i = 0; i < count; ++i) {
+            tasks.push_back(new RecordingTask());
+            tasks[i]->schedule(service_, delays[i]);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            service_.waitDone(*tasks[i]);
+            assertFiredAfter(*tasks[i], delays[i]);
+            delete tasks[i];
+        }
+        SPCDBG_EXIT(TIMER_TEST);
+    }
+
+    /// Cancelled tasks do not fire, wherever they are in the wheel
+    void test_cancel()
+    {
+        SPCDBG_ENTER(TIMER_TEST);
+        RecordingTask soon, later, idle;
+        soon.schedule(service_, 0.02);
+        later.schedule(service_, 0.1);
+        service_.cancel(later);
+        service_.cancel(soon);
+
+        // Cancelling a task which is not scheduled does nothing
+        service_.cancel(idle);
+        usleep(200 * 1000);
+        ASSERT_EQUALS(0UL, soon.fires().size());
+        ASSERT_EQUALS(0UL, later.fires().size());
+        ASSERT_EQUALS(0UL, idle.fires().size());
+
+        // A cancelled task can be scheduled again
+        soon.schedule(service_, 0.01);
+        service_.waitDone(soon);
+        assertFiredAfter(soon, 0.01);
+        SPCDBG_EXIT(TIMER_TEST);
+    }
+
+    /// Cancelling a running task waits for it, and the task does not run again
+    void test_cancelRunning()
+    {
+        SPCDBG_ENTER(TIMER_TEST);
+        RecordingTask task(vector<double>(100, 0.001), 100);
+        task.schedule(service_, 0);
+        while (!task.inFire()) {
+            usleep(1000);
+        }
+        service_.cancel(task);
+        ASSERT_TRUE(!task.inFire());
+        ASSERT_EQUALS(1UL, task.fires().size());
+        usleep(50 * 1000);
+        ASSERT_EQUALS(1UL, task.fires().size());
+        SPCDBG_EXIT(TIMER_TEST);
+    }
+
+    /// A task runs again after the delays it returns, until it stops
+    void test_rearm()
+    {
+        SPCDBG_ENTER(TIMER_TEST);
+        double delays[] = { 0.02, 0.001, 0.07, 0 };
+        size_t count = sizeof(delays) / sizeof(delays[0]);
+        RecordingTask task(vector<double>(delays, delays + count));
+        for (int round = 0; round < 2; ++round) {
+            task.schedule(service_, 0.01);
+            service_.waitDone(task);
+            vector<uint64_t> const& fires = task.fires();
+            ASSERT_EQUALS(count + 1, fires.size());
+            uint64_t due = 10;
+            for (size_t i = 0; i < fires.size(); ++i) {
+                ASSERT_TRUE_MSG("run " << i << " due after " << due << "ms fired after "
+                                       << fires[i] << "ms",
+                                fires[i] + earlyMillis >= due);
+                if (i < count) {
+                    // The next run is due after the delay, counted from this run
+                    due = fires[i] + static_cast<uint64_t>(delays[i] * 1000);
+                }
+            }
+            ASSERT_TRUE(fires.back() <= 10 + 20 + 1 + 70 + count * lateMillis);
+        }
+        SPCDBG_EXIT(TIMER_TEST);
+    }
+
+    /// After shutdown, tasks are no longer fired nor waited for
+    void test_shutdown()
+    {
+        SPCDBG_ENTER(TIMER_TEST);
+        RecordingTask pending;
+        pending.schedule(service_, 0.1);
+        service_.shutdown();
+        service_.waitDone(pending);
+        usleep(200 * 1000);
+        ASSERT_EQUALS(0UL, pending.fires().size());
+        SPCDBG_EXIT(TIMER_TEST);
+    }
+
+    WindowTimerService service_;
+};
+} // end namespace SPL
+
+MAIN_APP(SPL::WindowTimerServiceTest)
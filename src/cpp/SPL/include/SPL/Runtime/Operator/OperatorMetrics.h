@@ -49,7 +49,15 @@ namespace SPL
             maxItemsQueued,         //!< Largest number of items queued to the port (gauge)
             recentMaxItemsQueued,   //!< Recent largest number of items queued to the port (gauge)
             recentMaxItemsQueuedInterval,  //!< Interval in milliseconds used to determine recentMaxItemsQueued (time)
-            nEnqueueWaits           //!< Number of waits due to a full queue when enqueueing items for the port (counter)
+            nEnqueueWaits,          //!< Number of waits due to a full queue when enqueueing items for the port (counter)
+            queueWaitTime,          //!< Time in milliseconds the port thread waited for items to be queued (counter)
+            nDequeueBatches,        //!< Number of batches of items dequeued by the port thread (counter)
+            queueLatencyP50,        //!< Median time in nanoseconds items spent queued for the port (gauge)
+            queueLatencyP99,        //!< 99th percentile of the time in nanoseconds items spent queued for the port (gauge)
+            queueLatencyP999,       //!< 99.9th percentile of the time in nanoseconds items spent queued for the port (gauge)
+            processLatencyP50,      //!< Median time in nanoseconds spent processing tuples received by the port (gauge)
+            processLatencyP99,      //!< 99th percentile of the time in nanoseconds spent processing tuples received by the port (gauge)
+            processLatencyP999      //!< 99.9th percentile of the time in nanoseconds spent processing tuples received by the port (gauge)
         };
 
         /// Enumerations for output port metrics
@@ -35,7 +35,10 @@ namespace SPL
             nTuplesProcessed,       //!< Number of tuples processed by the port (counter)
             nTupleBytesProcessed,   //!< Number of bytes processed by the port (counter)
             nWindowPunctsProcessed, //!< Number of window punctuations processed by the port (counter)
-            nFinalPunctsProcessed   //!< Number of final punctuations processed by the port (counter)
+            nFinalPunctsProcessed,  //!< Number of final punctuations processed by the port (counter)
+            deliverLatencyP50,      //!< Median time in nanoseconds to deliver received messages to the operators (gauge)
+            deliverLatencyP99,      //!< 99th percentile of the time in nanoseconds to deliver received messages to the operators (gauge)
+            deliverLatencyP999      //!< 99.9th percentile of the time in nanoseconds to deliver received messages to the operators (gauge)
         };
 
         /// Enumerations for output port metrics
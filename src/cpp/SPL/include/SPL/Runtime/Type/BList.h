@@ -30,6 +30,7 @@
 #include <SPL/Runtime/Common/ApplicationRuntimeMessage.h>
 #include <SPL/Runtime/Type/TypeTMPHelper.h>
 #include <SPL/Runtime/Type/TypeHelper.h>
+#include <SPL/Runtime/Utility/Hash.h>
 #endif /*DOXYGEN_SKIP_FOR_USERS*/
 
 PUSH_DLL_PUBLIC
@@ -92,12 +93,11 @@ namespace SPL
         inline static void deserialize (ByteBuffer<BufferType>& buf, std::vector<T>& data,
                                         uint32_t numElems)
         {
-             data.clear();
-             data.reserve(numElems);
-             T x;
+             // Deserialize into the elements already there, which keeps
+             // their storage when a tuple is received again
+             data.resize(numElems);
              for(uint32_t i = 0; i<numElems; ++i) {
-                buf >> x;
-                data.push_back(x);
+                buf >> data[i];
              }
         }
     };
@@ -860,7 +860,7 @@ BLIST_SPECIALIZATION(boolean)
             size_t r = 17;
             std::tr1::hash<T> hs;
             for (size_type i = 0; i < *usedsz_; ++i) {
-                r = 37 * r + hs(this->operator[](i));
+                r = Hash::combine(r, hs(this->operator[](i)));
             }
             return r;
         }
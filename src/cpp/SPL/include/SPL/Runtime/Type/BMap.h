@@ -26,6 +26,7 @@
 #ifndef DOXYGEN_SKIP_FOR_USERS
 #include <SPL/Runtime/Common/ApplicationRuntimeMessage.h>
 #include <SPL/Runtime/Type/TypeTMPHelper.h>
+#include <SPL/Runtime/Utility/Hash.h>
 #endif /*DOXYGEN_SKIP_FOR_USERS*/
 
 PUSH_DLL_PUBLIC
@@ -739,8 +740,7 @@ namespace SPL
             const_iterator bit = this->begin();
             const_iterator eit = this->end();
             for(const_iterator it = bit; it!=eit; ++it) {
-                r = 37 * r + hsk(it->first);
-                r = 37 * r + hsv(it->second);
+                r = Hash::combineUnordered(r, hsk(it->first), hsv(it->second));
             }
             return r;
         }
@@ -25,6 +25,7 @@
 
 #ifndef DOXYGEN_SKIP_FOR_USERS
 #include <SPL/Runtime/Type/TypeTMPHelper.h>
+#include <SPL/Runtime/Utility/Hash.h>
 #endif /*DOXYGEN_SKIP_FOR_USERS*/
 
 
@@ -700,7 +701,7 @@ namespace SPL
             const_iterator bit = this->begin();
             const_iterator eit = this->end();
             for(const_iterator it = bit; it!=eit; ++it) {
-                r = 37 * r + hsk(*it);
+                r = Hash::combineUnordered(r, hsk(*it));
             }
             return r;
         }
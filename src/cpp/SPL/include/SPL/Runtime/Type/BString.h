@@ -30,6 +30,7 @@
 #include <SPL/Runtime/Type/TypeTMPHelper.h>
 #include <SPL/Runtime/Utility/Visibility.h>
 #include <SPL/Runtime/Type/TypeHelper.h>
+#include <SPL/Runtime/Utility/Hash.h>
 #endif /*DOXYGEN_SKIP_FOR_USERS*/
 
 PUSH_DLL_PUBLIC
@@ -1203,9 +1204,7 @@ namespace SPL
 
         size_t hashCode() const
         {
-            const std::collate<char> & c =
-                std::use_facet<std::collate<char> >(std::locale::classic());
-            return c.hash(info_->data_, info_->data_ + info_->usedsz_);
+            return Hash::hashChars(info_->data_, info_->usedsz_);
         }
 
         size_t getSerializedSize() const
@@ -260,11 +260,9 @@ namespace SPL
         /// @param buf serialization buffer to use
         void deserialize(VirtualByteBuffer & buf)
         {
-            deleteData();
-            size_ = buf.getUInt64();
+            allocData(buf.getUInt64());
             uint64_t size(size_);
             uint64_t ms32(std::numeric_limits<int32_t>::max());
-            data_ = new unsigned char[size_];
             unsigned char * data(data_);
             while(size>ms32) {
                 buf.getFixedCharSequence((char *) data, ms32);
@@ -298,11 +296,9 @@ namespace SPL
         template <class BufferType>
         void deserialize(ByteBuffer<BufferType> & buf)
         {
-            deleteData();
-            size_ = buf.getUInt64();
+            allocData(buf.getUInt64());
             uint64_t size(size_);
             uint64_t ms32(std::numeric_limits<int32_t>::max());
-            data_ = new unsigned char[size_];
             unsigned char * data(data_);
             while(size>ms32) {
                 char * ldata = buf.getFixedCharSequence(ms32);
@@ -338,6 +334,9 @@ namespace SPL
         enum { DONT_FREE = 0x8000000000000000ULL };
         void deleteData();
         void copyData(unsigned char const * data, uint64_t size);
+        // Own uninitialized storage of size bytes, keeping the current
+        // storage if it is owned and has that size
+        void allocData(uint64_t size);
 
         uint64_t size_;
         unsigned char * data_;
@@ -180,13 +180,10 @@ namespace SPL
         /// @param buf serialization buffer to use
         void deserialize(VirtualByteBuffer & buf)
         {
-            this->clear();
             int32_t n = SPL::deserializeLength(buf);
-            this->reserve(n);
-            T x;
+            this->resize(n);
             for(int32_t i = 0; i<n; ++i) {
-                buf >> x;
-                this->push_back(x);
+                buf >> this->operator[](i);
             }
         }
 #endif /* DOXYGEN_SKIP_FOR_USERS */
@@ -237,7 +234,7 @@ namespace SPL
             size_t r = 17;
             std::tr1::hash<T> hs;
             for (int32_t i = 0, iu = this->getSize(); i < iu; ++i) {
-                r = 37 * r + hs(this->operator[](i));
+                r = Hash::combine(r, hs(this->operator[](i)));
             }
             return r;
         }
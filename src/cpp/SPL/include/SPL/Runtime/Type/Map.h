@@ -265,8 +265,7 @@ namespace SPL
             typename map<K,V>::const_iterator bit = this->begin();
             typename map<K,V>::const_iterator eit = this->end();
             for(typename map<K,V>::const_iterator it = bit; it!=eit; ++it) {
-                r = 37 * r + hsk(it->first);
-                r = 37 * r + hsv(it->second);
+                r = Hash::combineUnordered(r, hsk(it->first), hsv(it->second));
             }
             return r;
         }
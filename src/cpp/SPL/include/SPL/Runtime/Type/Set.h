@@ -229,7 +229,7 @@ namespace SPL
             typename set<K>::const_iterator bit = this->begin();
             typename set<K>::const_iterator eit = this->end();
             for (typename set<K>::const_iterator it = bit; it != eit; ++it) {
-                r = 37 * r + hsk(*it);
+                r = Hash::combineUnordered(r, hsk(*it));
             }
             return r;
         }
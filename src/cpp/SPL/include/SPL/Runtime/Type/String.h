@@ -27,6 +27,7 @@
 #include <dst-config.h>
 #include <SPL/Runtime/Type/TypeHelper.h>
 #include <SPL/Runtime/Serialization/VirtualByteBuffer.h>
+#include <SPL/Runtime/Utility/Hash.h>
 #include <string>
 #include <locale>
 #include <ext/vstring.h>
@@ -132,9 +133,7 @@ typedef std::string RString;   // original/old definition of base class
         /// @return hash code
         size_t hashCode() const
         {
-            const std::collate<char> & c =
-                std::use_facet<std::collate<char> >(std::locale::classic());
-            return c.hash(this->c_str(), this->c_str() + this->size());
+            return Hash::hashChars(this->c_str(), this->size());
         }
 
         /// Get the size in bytes when serialized
@@ -356,6 +356,27 @@ namespace SPL
         /// Assign the tuple's payload
         /// @param rhs source tuple to assign payload from (if any)
         void assignPayload(Tuple const & rhs);
+
+#ifndef DOXYGEN_SKIP_FOR_USERS
+        /// Deserialize (binary) from a buffer that outlives the use of the
+        /// tuple. The tuple may keep referring to the buffer instead of
+        /// decoding all of its attributes, until it is assigned to or
+        /// deserialized again.
+        /// @param buf serialization buffer to use, which must not change
+        /// while the tuple is used
+        virtual void deserializeInPlace(NativeByteBuffer & buf)
+        {
+            deserialize(buf);
+        }
+
+        /// Get the hash code of some of the attributes: the hash code of
+        /// the attribute if there is one, otherwise the hash codes of the
+        /// attributes combined as in the hash code of a tuple
+        /// @param attributes indices of the attributes
+        /// @param count number of attributes
+        /// @return hash code
+        virtual size_t hashAttributes(uint32_t const * attributes, uint32_t count) const;
+#endif /* DOXYGEN_SKIP_FOR_USERS */
     };
 
     inline bool operator==(const Tuple & lhs, const Tuple & rhs)
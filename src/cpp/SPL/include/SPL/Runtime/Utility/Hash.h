@@ -0,0 +1,249 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_UTILITY_HASH_H
+#define SPL_RUNTIME_UTILITY_HASH_H
+
+/*!
+ * \file Hash.h \brief Hashing of byte sequences, and combining of hash codes.
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <locale>
+#include <stdint.h>
+
+namespace SPL
+{
+    /// Hash functions used by the hash codes of the SPL types.
+    ///
+    /// When ENABLE_SPL_FAST_HASH is defined to 1, byte sequences are hashed
+    /// with a 64-bit multiply-mix hash of the wyhash family, which does not
+    /// depend on the locale, and hash codes are combined with a mixing step.
+    /// Otherwise the hash codes are those of the earlier releases: the
+    /// collate facet of the classic locale for the strings, and 37 * r + h
+    /// for the combination. The hash codes are stable from run to run, but
+    /// not from one setting of ENABLE_SPL_FAST_HASH to the other: all the
+    /// code of an application has to be compiled with the same setting.
+    /// Both sets of hash codes are available, as Hash::Legacy and Hash::Fast,
+    /// to compare them.
+    namespace Hash
+    {
+#ifndef DOXYGEN_SKIP_FOR_USERS
+        namespace Impl
+        {
+            static const uint64_t secret0 = 0xa0761d6478bd642fULL;
+            static const uint64_t secret1 = 0xe7037ed1a0b428dbULL;
+            static const uint64_t secret2 = 0x8ebc6af09c88c6e3ULL;
+            static const uint64_t secret3 = 0x589965cc75374cc3ULL;
+
+            // 64 x 64 -> 128 bit multiplication, returned in a (low) and b (high)
+            inline void mum(uint64_t & a, uint64_t & b)
+            {
+#ifdef __SIZEOF_INT128__
+                __uint128_t r = static_cast<__uint128_t>(a) * b;
+                a = static_cast<uint64_t>(r);
+                b = static_cast<uint64_t>(r >> 64);
+#else
+                uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a),
+                         lb = static_cast<uint32_t>(b);
+                uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+                uint64_t t = rl + (rm0 << 32), c = t < rl;
+                uint64_t lo = t + (rm1 << 32);
+                c += lo < t;
+                a = lo;
+                b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+            }
+
+            inline uint64_t mix(uint64_t a, uint64_t b)
+            {
+                mum(a, b);
+                return a ^ b;
+            }
+
+            inline uint64_t read8(unsigned char const * p)
+            {
+                uint64_t v;
+                memcpy(&v, p, 8);
+                return v;
+            }
+
+            inline uint64_t read4(unsigned char const * p)
+            {
+                uint32_t v;
+                memcpy(&v, p, 4);
+                return v;
+            }
+
+            // 1 to 3 bytes
+            inline uint64_t read3(unsigned char const * p, size_t k)
+            {
+                return (static_cast<uint64_t>(p[0]) << 16) |
+                       (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+            }
+        }
+#endif /*DOXYGEN_SKIP_FOR_USERS*/
+
+        /// Hash a sequence of bytes with the 64-bit hash, whatever the
+        /// setting of ENABLE_SPL_FAST_HASH
+        /// @param data bytes to hash
+        /// @param size number of bytes
+        /// @param seed seed of the hash
+        /// @return hash code
+        inline uint64_t hashBytes(void const * data, size_t size, uint64_t seed = 0)
+        {
+            using namespace Impl;
+            unsigned char const * p = static_cast<unsigned char const *>(data);
+            seed ^= mix(seed ^ secret0, secret1);
+            uint64_t a, b;
+            if (size <= 16) {
+                if (size >= 4) {
+                    size_t d = (size >> 3) << 2;
+                    a = (read4(p) << 32) | read4(p + d);
+                    b = (read4(p + size - 4) << 32) | read4(p + size - 4 - d);
+                } else if (size > 0) {
+                    a = read3(p, size);
+                    b = 0;
+                } else {
+                    a = b = 0;
+                }
+            } else {
+                size_t i = size;
+                if (i > 48) {
+                    uint64_t see1 = seed, see2 = seed;
+                    do {
+                        seed = mix(read8(p) ^ secret1, read8(p + 8) ^ seed);
+                        see1 = mix(read8(p + 16) ^ secret2, read8(p + 24) ^ see1);
+                        see2 = mix(read8(p + 32) ^ secret3, read8(p + 40) ^ see2);
+                        p += 48;
+                        i -= 48;
+                    } while (i > 48);
+                    seed ^= see1 ^ see2;
+                }
+                while (i > 16) {
+                    seed = mix(read8(p) ^ secret1, read8(p + 8) ^ seed);
+                    i -= 16;
+                    p += 16;
+                }
+                // The last 16 bytes, which may overlap the ones already mixed
+                a = read8(p + i - 16);
+                b = read8(p + i - 8);
+            }
+            a ^= secret1;
+            b ^= seed;
+            mum(a, b);
+            return mix(a ^ secret0 ^ size, b ^ secret1);
+        }
+
+        /// Hash codes of the earlier releases, used unless ENABLE_SPL_FAST_HASH
+        /// is defined to 1
+        struct Legacy
+        {
+            static size_t hashChars(char const * data, size_t size)
+            {
+                const std::collate<char> & c =
+                    std::use_facet<std::collate<char> >(std::locale::classic());
+                return c.hash(data, data + size);
+            }
+
+            static size_t combine(size_t r, size_t h) { return 37 * r + h; }
+
+            static size_t combineUnordered(size_t r, size_t h) { return 37 * r + h; }
+
+            static size_t combineUnordered(size_t r, size_t hk, size_t hv)
+            {
+                return 37 * (37 * r + hk) + hv;
+            }
+        };
+
+        /// Hash codes used when ENABLE_SPL_FAST_HASH is defined to 1
+        struct Fast
+        {
+            static size_t hashChars(char const * data, size_t size)
+            {
+                return static_cast<size_t>(hashBytes(data, size));
+            }
+
+            static size_t combine(size_t r, size_t h)
+            {
+                return static_cast<size_t>(Impl::mix(r ^ Impl::secret0, h ^ Impl::secret1));
+            }
+
+            // The elements are mixed twice: once is not enough for elements
+            // which only differ in their high bits to spread over the buckets
+            static size_t combineUnordered(size_t r, size_t h)
+            {
+                using namespace Impl;
+                return r + static_cast<size_t>(mix(mix(h ^ secret2, secret3) ^ secret0, secret1));
+            }
+
+            static size_t combineUnordered(size_t r, size_t hk, size_t hv)
+            {
+                using namespace Impl;
+                return r +
+                       static_cast<size_t>(mix(mix(hk ^ secret2, hv ^ secret3) ^ secret0, secret1));
+            }
+        };
+
+#if ENABLE_SPL_FAST_HASH
+        typedef Fast Active;
+#else
+        typedef Legacy Active;
+#endif
+
+        /// Hash a string of characters
+        /// @param data characters
+        /// @param size number of characters
+        /// @return hash code
+        inline size_t hashChars(char const * data, size_t size)
+        {
+            return Active::hashChars(data, size);
+        }
+
+        /// Combine a hash code into the hash code of a sequence
+        /// @param r hash code of the sequence so far, 17 for an empty one
+        /// @param h hash code to add to the sequence
+        /// @return hash code of the sequence with h added
+        inline size_t combine(size_t r, size_t h)
+        {
+            return Active::combine(r, h);
+        }
+
+        /// Combine a hash code into the hash code of a set, whatever the
+        /// order of its elements
+        /// @param r hash code of the set so far, 17 for an empty one
+        /// @param h hash code of an element
+        /// @return hash code of the set with the element added
+        inline size_t combineUnordered(size_t r, size_t h)
+        {
+            return Active::combineUnordered(r, h);
+        }
+
+        /// Combine the hash codes of an entry into the hash code of a map,
+        /// whatever the order of its entries
+        /// @param r hash code of the map so far, 17 for an empty one
+        /// @param hk hash code of the key of the entry
+        /// @param hv hash code of the value of the entry
+        /// @return hash code of the map with the entry added
+        inline size_t combineUnordered(size_t r, size_t hk, size_t hv)
+        {
+            return Active::combineUnordered(r, hk, hv);
+        }
+    }
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_UTILITY_HASH_H */
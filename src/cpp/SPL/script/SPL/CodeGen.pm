@@ -220,7 +220,8 @@ sub getOutputTupleCppAssignments($$)
       my $attr = $outputPort->getAttributeAt($i);
       if($attr->hasAssignment()) {
         my $exp = $attr->getAssignmentValue();
-        $assignments .= "$tupleName.set_" . $attr->getName() . "(" . $exp->getCppExpression() . "); ";
+        my $value = SPL::CodeGenHelper::ensureValue($attr->getSPLType(), $exp->getCppExpression());
+        $assignments .= "$tupleName.set_" . $attr->getName() . "($value); ";
       }
     }
     return $assignments;
@@ -258,13 +259,14 @@ sub getOutputTupleCppAssignmentsWithSideEffects($$$)
       my $attr = $outputPort->getAttributeAt($i);
       if($attr->hasAssignment()) {
         my $exp = $attr->getAssignmentValue();
+        my $value = SPL::CodeGenHelper::ensureValue($attr->getSPLType(), $exp->getCppExpression());
         if ($exp->hasStreamAttributes() || $exp->hasSideEffects()) {
           if ($sideEffects) {
-             $assignments .= "$tupleName.set_" . $attr->getName() . "(" . $exp->getCppExpression() . "); ";
+             $assignments .= "$tupleName.set_" . $attr->getName() . "($value); ";
            }
         }
         elsif (!$sideEffects) {
-             $assignments .= "$tupleName.set_" . $attr->getName() . "(" . $exp->getCppExpression() . "); ";
+             $assignments .= "$tupleName.set_" . $attr->getName() . "($value); ";
         }
       }
     }
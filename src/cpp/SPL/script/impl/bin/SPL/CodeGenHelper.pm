@@ -1675,6 +1675,66 @@ sub genTupleClear($)
    --$indent;
 }
 
+sub isLazyTupleAttributeType($);
+sub genLazySkip($$);
+
+## @fn list lazyTupleAttributes($model)
+# Get the attributes of a tuple that a PE decodes on first access, rather
+# than when it receives the tuple.  Only wide tuples have any: for the others,
+# the bookkeeping costs more than decoding all the attributes.
+# @param model The tuple's model.
+# @return the lazy attributes, in order
+sub lazyTupleAttributes($)
+{
+   my ($model) = @_;
+   my @lazy;
+   return @lazy if $model->getNumberOfAttributes() < 16;
+   foreach my $attr (@{$model->getAttributes()}) {
+      push @lazy, $attr if isLazyTupleAttributeType($attr->getSPLType());
+   }
+   return @lazy;
+}
+
+## @fn bool isLazyTupleAttributeType($type)
+# Check if a serialized value of this type can be skipped without decoding it
+# @param type %SPL type
+# @return true if the type is rstring, blob, or an unbounded list of a
+# fixed-size primitive type or of such a type
+sub isLazyTupleAttributeType($)
+{
+   my ($type) = @_;
+   return 1 if SPL::CodeGen::Type::isRString($type) || SPL::CodeGen::Type::isBlob($type);
+   return 0 unless SPL::CodeGen::Type::isList($type);
+   my $elementType = SPL::CodeGen::Type::getElementType($type);
+   return $elementType =~ /^(u?int(8|16|32|64)|float(32|64)|boolean)$/ ||
+          isLazyTupleAttributeType($elementType);
+}
+
+## @fn void genLazySkip($type, $depth)
+# Generate the code to skip a serialized value in the NativeByteBuffer buf
+# @param type %SPL type, for which isLazyTupleAttributeType() is true
+# @param depth nesting depth of the value, for the names of the loop variables
+sub genLazySkip($$)
+{
+   my ($type, $depth) = @_;
+   if (SPL::CodeGen::Type::isRString($type)) {
+      emitALine "{ uint32_t n = SPL::deserializeLength(buf); buf.setOCursor(buf.getOCursor() + n); }";
+   } elsif (SPL::CodeGen::Type::isBlob($type)) {
+      emitALine "{ uint64_t n = buf.getUInt64(); buf.setOCursor(buf.getOCursor() + n); }";
+   } else {
+      my $elementType = SPL::CodeGen::Type::getElementType($type);
+      if (!isLazyTupleAttributeType($elementType)) {
+         emitALine "{ uint64_t n = SPL::deserializeLength(buf); buf.setOCursor(buf.getOCursor() + n * sizeof(SPL::$elementType)); }";
+      } else {
+         emitALine "for (uint32_t i$depth = 0, n$depth = SPL::deserializeLength(buf); i$depth < n$depth; ++i$depth) {";
+         ++$indent;
+         genLazySkip($elementType, $depth + 1);
+         --$indent;
+         emitALine "}";
+      }
+   }
+}
+
 ## @fn void consistentRegionInitList($model)
 # Given an operator's model, emits an initializer for each variable required to
 # control Drain and Reset punctuation forwarding
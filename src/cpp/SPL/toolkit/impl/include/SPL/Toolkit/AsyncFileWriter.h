@@ -0,0 +1,291 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_ASYNC_FILE_WRITER_H
+#define SPL_RUNTIME_ASYNC_FILE_WRITER_H
+
+#include <SPL/Runtime/Common/Metric.h>
+#include <SPL/Runtime/Utility/CV.h>
+#include <SPL/Runtime/Utility/Mutex.h>
+
+#include <boost/iostreams/categories.hpp>
+#include <boost/noncopyable.hpp>
+#include <cerrno>
+#include <cstring>
+#include <ios>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace SPL
+{
+    /**
+     * Double-buffered writer of a file descriptor, which writes to the
+     * file on a background thread.
+     *
+     * The producer appends to one buffer while the background thread
+     * writes the other one to the file. When the buffer of the producer is
+     * full, the buffers are swapped; the producer only waits (stalls) if
+     * the background thread has not finished writing the other buffer yet.
+     * A flush hands the buffer of the producer over to the background
+     * thread, without waiting for it to be written, and sync() waits until
+     * all the data is in the file.
+     *
+     * The background thread is the caller of run(). Until it starts, and
+     * after it stops, the producer writes to the file itself.
+     */
+    class AsyncFileWriter : private boost::noncopyable
+    {
+    public:
+        /**
+         * Constructor
+         * @param bufferSize size of each of the two buffers
+         * @param bytesWritten metric of the number of bytes written to files
+         * @param bytesQueued metric of the number of bytes waiting to be written
+         * @param stallTime metric of the time the producer waited for the
+         * background thread, in milliseconds
+         */
+        AsyncFileWriter(size_t bufferSize, Metric & bytesWritten, Metric & bytesQueued,
+                        Metric & stallTime)
+          : _bufferSize(bufferSize), _fd(-1), _busy(false), _flushRequested(false),
+            _running(false), _shutdown(false), _error(0), _offset(0), _stallNanos(0),
+            _bytesWritten(bytesWritten), _bytesQueued(bytesQueued), _stallTime(stallTime)
+        {
+            _filling.reserve(_bufferSize);
+            _draining.reserve(_bufferSize);
+        }
+
+        /**
+         * Start writing to a file, once the previous one is closed
+         * @param fd file descriptor, positioned where to write
+         * @param offset current offset in the file
+         */
+        void open(int fd, uint64_t offset)
+        {
+            AutoMutex am(_mutex);
+            _fd = fd;
+            _offset = offset;
+            _error = 0;
+        }
+
+        /// Append data, which is written to the file later
+        void write(char const * data, size_t size)
+        {
+            AutoMutex am(_mutex);
+            if (_error != 0) {
+                int error = _error;
+                _error = 0;
+                throw std::ios_base::failure(strerror(error));
+            }
+            _filling.insert(_filling.end(), data, data + size);
+            _offset += size;
+            if (_filling.size() >= _bufferSize) {
+                handOff();
+            }
+            _bytesQueued.setValueNoLock(_filling.size() + _draining.size());
+        }
+
+        /// Hand the data appended so far over to the background thread
+        void flush()
+        {
+            AutoMutex am(_mutex);
+            if (_filling.empty()) {
+                return;
+            }
+            if (_busy) {
+                // Taken by the background thread when it is done
+                _flushRequested = true;
+            } else {
+                handOff();
+            }
+        }
+
+        /// Wait until all the data appended so far is written to the file
+        void sync()
+        {
+            AutoMutex am(_mutex);
+            if (!_filling.empty()) {
+                handOff();
+            }
+            while (_busy) {
+                _cv.wait(_mutex);
+            }
+            _bytesQueued.setValueNoLock(0);
+        }
+
+        /**
+         * Write all the data, and close the file
+         * @return 0, or the error number of the last failed write
+         */
+        int close()
+        {
+            sync();
+            AutoMutex am(_mutex);
+            ::close(_fd);
+            _fd = -1;
+            int error = _error;
+            _error = 0;
+            return error;
+        }
+
+        /// Offset in the file after the data appended so far
+        uint64_t getOffset() const { return _offset; }
+
+        /**
+         * Set the offset of the file after it was moved
+         * @pre sync() was called, and the file descriptor was positioned
+         */
+        void setOffset(uint64_t offset)
+        {
+            AutoMutex am(_mutex);
+            _offset = offset;
+        }
+
+        /// Write the buffers handed over, until shutdown() is called
+        void run()
+        {
+            AutoMutex am(_mutex);
+            _running = true;
+            while (!_shutdown || _busy) {
+                if (!_busy) {
+                    _cv.wait(_mutex);
+                    continue;
+                }
+                // The producer does not touch _draining while it is busy
+                int fd = _fd;
+                _mutex.unlock();
+                int error = writeAll(fd, _draining);
+                _mutex.lock();
+                if (error != 0) {
+                    _error = error;
+                }
+                _draining.clear();
+                _busy = false;
+                if (_flushRequested && !_filling.empty()) {
+                    std::swap(_filling, _draining);
+                    _busy = true;
+                }
+                _flushRequested = false;
+                _bytesQueued.setValueNoLock(_filling.size() + _draining.size());
+                _cv.broadcast();
+            }
+            _running = false;
+        }
+
+        /// Make run() return, once the buffers handed over are written
+        void shutdown()
+        {
+            AutoMutex am(_mutex);
+            _shutdown = true;
+            _cv.broadcast();
+        }
+
+    private:
+        // Give the buffer of the producer to the background thread, waiting
+        // for it to be done with the other one; called with the mutex held
+        void handOff()
+        {
+            if (_busy) {
+                struct timespec start, end;
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                while (_busy) {
+                    _cv.wait(_mutex);
+                }
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                _stallNanos += (end.tv_sec - start.tv_sec) * 1000000000LL + end.tv_nsec - start.tv_nsec;
+                _stallTime.setValueNoLock(_stallNanos / 1000000);
+            }
+            _flushRequested = false;
+            if (_running) {
+                std::swap(_filling, _draining);
+                _busy = true;
+                _cv.broadcast();
+            } else {
+                int error = writeAll(_fd, _filling);
+                if (error != 0) {
+                    _error = error;
+                }
+                _filling.clear();
+            }
+        }
+
+        // Write a buffer to the file
+        int writeAll(int fd, std::vector<char> const & buffer)
+        {
+            size_t done = 0;
+            while (done < buffer.size()) {
+                ssize_t n = ::write(fd, &buffer[done], buffer.size() - done);
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return errno;
+                }
+                done += n;
+            }
+            _bytesWritten.incrementValueNoLock(done);
+            return 0;
+        }
+
+        Mutex _mutex;
+        CV _cv;
+        size_t _bufferSize;
+        std::vector<char> _filling;  // appended to by the producer
+        std::vector<char> _draining; // written by the background thread
+        int _fd;
+        bool _busy;           // _draining is being written
+        bool _flushRequested; // hand _filling over once _draining is written
+        bool _running;
+        bool _shutdown;
+        int _error;
+        uint64_t _offset;
+        int64_t _stallNanos;
+        Metric & _bytesWritten;
+        Metric & _bytesQueued;
+        Metric & _stallTime;
+    };
+
+    /// Sink device for boost iostreams that appends to an AsyncFileWriter
+    class AsyncFileWriterSink
+    {
+    public:
+        typedef char char_type;
+        struct category
+          : boost::iostreams::sink_tag
+          , boost::iostreams::flushable_tag
+        {};
+
+        AsyncFileWriterSink(AsyncFileWriter & writer) : _writer(&writer) {}
+
+        std::streamsize write(char const * data, std::streamsize size)
+        {
+            _writer->write(data, size);
+            return size;
+        }
+
+        bool flush()
+        {
+            _writer->flush();
+            return true;
+        }
+
+    private:
+        AsyncFileWriter * _writer;
+    };
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_ASYNC_FILE_WRITER_H */
@@ -0,0 +1,566 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_CSV_SCANNER_H
+#define SPL_RUNTIME_CSV_SCANNER_H
+
+#include <SPL/Runtime/Type/SPLType.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace SPL
+{
+    /**
+     * Fast path for reading CSV lines, used by the source operators before
+     * they fall back to SPL::readCSV on the same line.
+     *
+     * A line is split into fields with a vectorized scan, which marks the
+     * separators, quotes and backslashes of 64 bytes at a time, and the
+     * fields are converted without going through a stream. The fast path
+     * only accepts what it can convert to the same value as readCSV:
+     * unquoted fields, quoted fields without escapes, and plain decimal
+     * numbers. For anything else (escapes, nan, numbers that do not fit,
+     * a wrong number of fields, ...) it returns false, and the caller
+     * parses the line with readCSV, which reports the errors.
+     */
+    namespace CSVScanner
+    {
+        /// Span of a field in a line
+        struct Field
+        {
+            char const * begin; // first character, after the leading spaces and tabs
+            char const * end;   // separator or end of the line
+            char const * trim;  // end, before the trailing spaces and tabs
+            bool quoted;        // begin and trim - 1 are the quotes
+        };
+
+        /**
+         * Finds where a CSV line ends, as readCSV does: at a new line or a
+         * carriage return, unless it is in quotes. Fields in quotes may
+         * span several lines, as string literals do for readCSV.
+         */
+        class LineScanner
+        {
+        public:
+            LineScanner(unsigned char separator)
+              : _separator(separator), _fieldStart(true), _quote(0), _last(0)
+            {}
+
+            /// Take the next character, and tell whether it ends the line
+            bool atEnd(int c)
+            {
+                if (_quote != 0) {
+                    if (c == _quote && _last != '\\') {
+                        _quote = 0;
+                    }
+                    _last = (c == '\\' && _last == '\\') ? ' ' : c;
+                } else if (c == '\n' || c == '\r') {
+                    return true;
+                } else if (c == _separator) {
+                    _fieldStart = true;
+                } else if (_fieldStart && (c == '"' || c == '\'')) {
+                    _quote = c;
+                    _last = c;
+                    _fieldStart = false;
+                } else if (c != ' ' && c != '\t') {
+                    _fieldStart = false;
+                }
+                return false;
+            }
+
+        private:
+            int _separator;
+            bool _fieldStart;
+            int _quote; // quote of the current field, if it is in quotes
+            int _last;  // last character in quotes, unless it was escaped
+        };
+
+        /**
+         * Read a line from a stream. The terminating character is consumed
+         * but not stored.
+         * @param fs stream to read from
+         * @param line line read
+         * @param separator field separator
+         * @return true if the line was terminated, false if the end of the
+         * stream was reached first, in which case eofbit is set on the stream
+         */
+        inline bool readLine(std::istream & fs, std::string & line, unsigned char separator)
+        {
+            line.clear();
+            std::streambuf * sb = fs.rdbuf();
+            LineScanner scanner(separator);
+            char buffer[256];
+            size_t n = 0;
+            for (;;) {
+                int c = sb->sbumpc();
+                if (c == EOF) {
+                    line.append(buffer, n);
+                    fs.setstate(std::ios_base::eofbit);
+                    return false;
+                }
+                if (scanner.atEnd(c)) {
+                    line.append(buffer, n);
+                    return true;
+                }
+                buffer[n++] = static_cast<char>(c);
+                if (n == sizeof(buffer)) {
+                    line.append(buffer, n);
+                    n = 0;
+                }
+            }
+        }
+
+        /**
+         * Find the end of a line in a buffer
+         * @param data line
+         * @param size size of the buffer from the line
+         * @param separator field separator
+         * @param terminated set to true if the line has a terminating
+         * character, and false if it ends with the buffer
+         * @return size of the line, without its terminating character
+         */
+        inline size_t findLineEnd(char const * data, size_t size, unsigned char separator,
+                                  bool & terminated)
+        {
+            LineScanner scanner(separator);
+            for (size_t i = 0; i < size; ++i) {
+                if (scanner.atEnd(static_cast<unsigned char>(data[i]))) {
+                    terminated = true;
+                    return i;
+                }
+            }
+            terminated = false;
+            return size;
+        }
+
+        /**
+         * Skip the empty lines and the comments (lines starting with #) in
+         * a buffer, as the source operators do before a CSV line
+         * @return position of the next line, or size
+         */
+        inline size_t skipEmptyLines(char const * data, size_t pos, size_t size)
+        {
+            for (;;) {
+                while (pos < size && (data[pos] == ' ' || data[pos] == '\t' ||
+                                      data[pos] == '\r' || data[pos] == '\n')) {
+                    ++pos;
+                }
+                if (pos == size || data[pos] != '#') {
+                    return pos;
+                }
+                char const * eol = static_cast<char const *>(memchr(data + pos, '\n', size - pos));
+                pos = eol ? eol - data + 1 : size;
+            }
+        }
+
+        /// Fields of a line, kept across lines to reuse their storage
+        class Line
+        {
+        public:
+            /**
+             * Split a line into fields
+             * @param data line, without its terminating character
+             * @param size size of the line
+             * @param separator field separator
+             * @param count number of fields expected
+             * @param ignoreExtra true if the fields after the expected ones
+             * are ignored, rather than making the line fail
+             * @return true if the line has the expected fields, all of which
+             * are unquoted or quoted without escapes
+             */
+            bool split(char const * data, size_t size, unsigned char separator,
+                       size_t count, bool ignoreExtra)
+            {
+                _fields.clear();
+                mark(data, size, separator);
+                size_t pos = 0;
+                for (;;) {
+                    while (pos < size && (data[pos] == ' ' || data[pos] == '\t')) {
+                        ++pos;
+                    }
+                    Field field;
+                    field.begin = data + pos;
+                    field.quoted = pos < size && (data[pos] == '"' || data[pos] == '\'');
+                    size_t end;
+                    if (field.quoted) {
+                        // The closing quote is the next quote or backslash,
+                        // which must be the same quote
+                        size_t close = next(_quotes, pos + 1, size);
+                        if (close == size || data[close] != data[pos]) {
+                            return false;
+                        }
+                        end = close + 1;
+                        field.trim = data + end;
+                        while (end < size && (data[end] == ' ' || data[end] == '\t')) {
+                            ++end;
+                        }
+                        if (end == size ? (field.trim != data + size && !ignoreExtra)
+                                        : static_cast<unsigned char>(data[end]) != separator) {
+                            return false;
+                        }
+                    } else {
+                        end = next(_separators, pos, size);
+                        size_t trim = end;
+                        // As readCSV, allow trailing spaces after a value
+                        // only if another one follows, or it is ignored
+                        if (end < size || ignoreExtra) {
+                            while (trim > pos && (data[trim - 1] == ' ' || data[trim - 1] == '\t')) {
+                                --trim;
+                            }
+                        }
+                        field.trim = data + trim;
+                    }
+                    field.end = data + end;
+                    _fields.push_back(field);
+                    if (_fields.size() == count) {
+                        return end == size || ignoreExtra;
+                    }
+                    if (end == size) {
+                        return false;
+                    }
+                    pos = end + 1;
+                }
+            }
+
+            Field const & operator[](size_t i) const { return _fields[i]; }
+            size_t size() const { return _fields.size(); }
+
+        private:
+            // Set a bit for each separator, and for each quote or backslash
+            void mark(char const * data, size_t size, unsigned char separator)
+            {
+                size_t blocks = (size + 63) / 64;
+                _separators.resize(blocks);
+                _quotes.resize(blocks);
+                size_t i = 0;
+                for (size_t b = 0; i + 64 <= size; ++b, i += 64) {
+                    markBlock(data + i, separator, _separators[b], _quotes[b]);
+                }
+                if (i < size) {
+                    char tail[64];
+                    memset(tail, 0, sizeof(tail));
+                    memcpy(tail, data + i, size - i);
+                    markBlock(tail, separator, _separators[blocks - 1], _quotes[blocks - 1]);
+                    // Do not mark the zeros after the line
+                    uint64_t valid = (static_cast<uint64_t>(1) << (size - i)) - 1;
+                    _separators[blocks - 1] &= valid;
+                    _quotes[blocks - 1] &= valid;
+                }
+            }
+
+            static void markBlock(char const * data, unsigned char separator, uint64_t & separators,
+                                  uint64_t & quotes)
+            {
+#if defined(__AVX2__)
+                __m256i sep = _mm256_set1_epi8(static_cast<char>(separator));
+                __m256i dquote = _mm256_set1_epi8('"');
+                __m256i squote = _mm256_set1_epi8('\'');
+                __m256i backslash = _mm256_set1_epi8('\\');
+                separators = 0;
+                quotes = 0;
+                for (int i = 0; i < 64; i += 32) {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + i));
+                    uint32_t s = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, sep));
+                    uint32_t q = _mm256_movemask_epi8(_mm256_or_si256(
+                      _mm256_or_si256(_mm256_cmpeq_epi8(v, dquote), _mm256_cmpeq_epi8(v, squote)),
+                      _mm256_cmpeq_epi8(v, backslash)));
+                    separators |= static_cast<uint64_t>(s) << i;
+                    quotes |= static_cast<uint64_t>(q) << i;
+                }
+#elif defined(__SSE2__)
+                __m128i sep = _mm_set1_epi8(static_cast<char>(separator));
+                __m128i dquote = _mm_set1_epi8('"');
+                __m128i squote = _mm_set1_epi8('\'');
+                __m128i backslash = _mm_set1_epi8('\\');
+                separators = 0;
+                quotes = 0;
+                for (int i = 0; i < 64; i += 16) {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + i));
+                    uint32_t s = _mm_movemask_epi8(_mm_cmpeq_epi8(v, sep));
+                    uint32_t q = _mm_movemask_epi8(
+                      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, dquote), _mm_cmpeq_epi8(v, squote)),
+                                   _mm_cmpeq_epi8(v, backslash)));
+                    separators |= static_cast<uint64_t>(s) << i;
+                    quotes |= static_cast<uint64_t>(q) << i;
+                }
+#else
+                separators = 0;
+                quotes = 0;
+                for (int i = 0; i < 64; ++i) {
+                    unsigned char c = data[i];
+                    uint64_t bit = static_cast<uint64_t>(1) << i;
+                    if (c == separator) {
+                        separators |= bit;
+                    }
+                    if (c == '"' || c == '\'' || c == '\\') {
+                        quotes |= bit;
+                    }
+                }
+#endif
+            }
+
+            // Position of the first marked character from pos, or size
+            static size_t next(std::vector<uint64_t> const & marks, size_t pos, size_t size)
+            {
+                size_t b = pos / 64;
+                if (b >= marks.size()) {
+                    return size;
+                }
+                uint64_t bits = marks[b] & (~static_cast<uint64_t>(0) << (pos % 64));
+                while (bits == 0) {
+                    if (++b == marks.size()) {
+                        return size;
+                    }
+                    bits = marks[b];
+                }
+                return b * 64 + __builtin_ctzll(bits);
+            }
+
+            std::vector<Field> _fields;
+            std::vector<uint64_t> _separators;
+            std::vector<uint64_t> _quotes;
+        };
+
+        /// Parse a decimal integer that fills [begin, end)
+        template <typename T>
+        inline bool parseInteger(char const * begin, char const * end, T & value)
+        {
+            bool negative = false;
+            if (begin != end && *begin == '-') {
+                if (!std::numeric_limits<T>::is_signed) {
+                    return false;
+                }
+                negative = true;
+                ++begin;
+            }
+            if (begin == end || end - begin > 19) {
+                return false;
+            }
+            uint64_t v = 0;
+            for (; begin != end; ++begin) {
+                unsigned d = static_cast<unsigned char>(*begin) - '0';
+                if (d > 9) {
+                    return false;
+                }
+                v = v * 10 + d;
+            }
+            uint64_t max = static_cast<uint64_t>(std::numeric_limits<T>::max());
+            if (v > max + (negative ? 1 : 0)) {
+                return false;
+            }
+            value = static_cast<T>(negative ? 0 - v : v);
+            return true;
+        }
+
+        /**
+         * Parse a decimal floating point number that fills [begin, end),
+         * when it is exactly a mantissa times a power of 10 that are both
+         * representable in T, so that a single operation rounds it
+         * correctly.
+         */
+        template <typename T>
+        inline bool parseFloat(char const * begin, char const * end, T & value)
+        {
+            // Mantissa and power of 10 limits for an exact conversion
+            uint64_t const maxMantissa =
+              static_cast<uint64_t>(1) << std::numeric_limits<T>::digits;
+            int const maxExponent = std::numeric_limits<T>::digits > 24 ? 22 : 10;
+            static T const powers[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                        1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+            bool negative = false;
+            if (begin != end && *begin == '-') {
+                negative = true;
+                ++begin;
+            }
+            uint64_t mantissa = 0;
+            int exponent = 0;
+            int digits = 0;
+            bool any = false;
+            for (; begin != end && static_cast<unsigned>(*begin - '0') <= 9; ++begin) {
+                any = true;
+                if (mantissa != 0 || *begin != '0') {
+                    if (++digits > 19) {
+                        return false;
+                    }
+                    mantissa = mantissa * 10 + (*begin - '0');
+                }
+            }
+            if (begin != end && *begin == '.') {
+                for (++begin; begin != end && static_cast<unsigned>(*begin - '0') <= 9; ++begin) {
+                    any = true;
+                    if (mantissa != 0 || *begin != '0') {
+                        if (++digits > 19) {
+                            return false;
+                        }
+                        mantissa = mantissa * 10 + (*begin - '0');
+                    }
+                    --exponent;
+                }
+            }
+            if (!any) {
+                return false;
+            }
+            if (begin != end && (*begin == 'e' || *begin == 'E')) {
+                ++begin;
+                bool negativeExponent = false;
+                if (begin != end && (*begin == '-' || *begin == '+')) {
+                    negativeExponent = *begin == '-';
+                    ++begin;
+                }
+                if (begin == end || end - begin > 4) {
+                    return false;
+                }
+                int e = 0;
+                for (; begin != end; ++begin) {
+                    unsigned d = static_cast<unsigned char>(*begin) - '0';
+                    if (d > 9) {
+                        return false;
+                    }
+                    e = e * 10 + d;
+                }
+                exponent += negativeExponent ? -e : e;
+            }
+            if (begin != end || mantissa > maxMantissa) {
+                return false;
+            }
+            if (mantissa == 0) {
+                // readCSV drops the sign of a negative zero
+                value = 0;
+                return true;
+            }
+            if (exponent < -maxExponent || exponent > maxExponent) {
+                return false;
+            }
+#if defined(__FLT_EVAL_METHOD__) && __FLT_EVAL_METHOD__ != 0
+            // With extended precision (x87), the operation rounds twice
+            return false;
+#endif
+            T v = static_cast<T>(mantissa);
+            v = exponent < 0 ? v / powers[-exponent] : v * powers[exponent];
+            value = negative ? -v : v;
+            return true;
+        }
+
+        /// Convert a non-empty field to an integer value
+        template <typename T>
+        inline bool convert(Field const & field, T & value)
+        {
+            return !field.quoted && parseInteger(field.begin, field.trim, value);
+        }
+
+        inline bool convert(Field const & field, float32 & value)
+        {
+            return !field.quoted && parseFloat(field.begin, field.trim, value);
+        }
+
+        inline bool convert(Field const & field, float64 & value)
+        {
+            return !field.quoted && parseFloat(field.begin, field.trim, value);
+        }
+
+        inline bool convert(Field const & field, int8 & value)
+        {
+            int8_t v;
+            if (field.quoted || !parseInteger(field.begin, field.trim, v)) {
+                return false;
+            }
+            value = v;
+            return true;
+        }
+
+        inline bool convert(Field const & field, uint8 & value)
+        {
+            uint8_t v;
+            if (field.quoted || !parseInteger(field.begin, field.trim, v)) {
+                return false;
+            }
+            value = v;
+            return true;
+        }
+
+        inline bool convert(Field const & field, boolean & value)
+        {
+            size_t size = field.trim - field.begin;
+            if (field.quoted) {
+                return false;
+            } else if (size == 4 && memcmp(field.begin, "true", 4) == 0) {
+                value = true;
+            } else if (size == 5 && memcmp(field.begin, "false", 5) == 0) {
+                value = false;
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        inline bool convert(Field const & field, rstring & value)
+        {
+            if (!field.quoted) {
+                // As readCSV, keep the trailing spaces
+                value.assign(field.begin, field.end);
+                return true;
+            }
+            // Only printable ASCII is taken as is between quotes
+            for (char const * p = field.begin + 1; p != field.trim - 1; ++p) {
+                if (*p < ' ' || *p > '~') {
+                    return false;
+                }
+            }
+            value.assign(field.begin + 1, field.trim - 1);
+            return true;
+        }
+
+        /// Read a field into an attribute, which is empty if the field is
+        template <typename T>
+        inline bool read(Field const & field, T & value)
+        {
+            if (field.begin == field.end) {
+                value = T();
+                return true;
+            }
+            return convert(field, value);
+        }
+
+        /// Read a field into an attribute, which is set to a default value
+        /// if the field is empty
+        template <typename T>
+        inline bool read(Field const & field, T & value, T const & defaultValue)
+        {
+            if (field.begin == field.end) {
+                value = defaultValue;
+                return true;
+            }
+            return convert(field, value);
+        }
+    } // namespace CSVScanner
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_CSV_SCANNER_H */
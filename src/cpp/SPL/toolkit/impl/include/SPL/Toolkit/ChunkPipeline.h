@@ -0,0 +1,224 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_CHUNK_PIPELINE_H
+#define SPL_RUNTIME_CHUNK_PIPELINE_H
+
+#include <SPL/Runtime/Utility/CV.h>
+#include <SPL/Runtime/Utility/Mutex.h>
+
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace SPL
+{
+    /**
+     * Parse the lines of a buffer ahead of its reader, on worker threads.
+     *
+     * The buffer is cut into chunks of about the same size, on line
+     * boundaries. The workers parse the chunks, a bounded number of them
+     * ahead of the reader, into records. The reader looks the records up
+     * by their offset, in order: this is the reorder buffer that hands
+     * them out in the order of the buffer whatever the order in which the
+     * chunks were parsed.
+     *
+     * A chunk starts after the first line terminator it contains, so a
+     * worker may not know whether it starts in a multi-line record. The
+     * reader only takes a record that starts where it expects the next
+     * record to be, and reads the lines it finds no record for itself.
+     *
+     * The Parser provides
+     *   size_t parseChunk(std::vector<Record> & records, char const * data,
+     *                     size_t size, size_t begin, size_t end) const;
+     * which parses the records that start in [begin, end) of data, where
+     * begin is the start of a line, and returns how many there are. The
+     * records are reused from chunk to chunk. A Record has a begin member
+     * with its offset in the buffer.
+     */
+    template <typename Parser, typename Record>
+    class ChunkPipeline : private boost::noncopyable
+    {
+        struct Chunk
+        {
+            Chunk() : count(0), ready(false) {}
+            std::vector<Record> records;
+            size_t count;
+            bool ready;
+        };
+
+    public:
+        /**
+         * Constructor
+         * @param parser parser of the chunks
+         * @param chunkSize size of a chunk, in bytes
+         * @param window number of chunks parsed ahead of the reader
+         */
+        ChunkPipeline(Parser const & parser, size_t chunkSize, size_t window)
+          : _parser(parser), _chunkSize(chunkSize), _chunks(window), _data(NULL), _size(0),
+            _count(0), _next(0), _front(0), _busy(0), _current(NULL), _record(0),
+            _shutdown(false)
+        {}
+
+        /**
+         * Start parsing a buffer
+         * @pre the pipeline is stopped
+         */
+        void start(char const * data, size_t size)
+        {
+            AutoMutex am(_mutex);
+            _data = data;
+            _size = size;
+            _count = (size + _chunkSize - 1) / _chunkSize;
+            _next = 0;
+            _front = 0;
+            _current = NULL;
+            _record = 0;
+            _cv.broadcast();
+        }
+
+        /// Stop parsing the buffer, once the chunks being parsed are done
+        void stop()
+        {
+            AutoMutex am(_mutex);
+            _count = 0;
+            while (_busy > 0) {
+                _cv.wait(_mutex);
+            }
+            for (size_t i = 0; i < _chunks.size(); ++i) {
+                _chunks[i].ready = false;
+            }
+            _current = NULL;
+        }
+
+        /// Make the workers return, and the reader find no more records
+        void shutdown()
+        {
+            AutoMutex am(_mutex);
+            _shutdown = true;
+            _cv.broadcast();
+        }
+
+        /// Parse chunks, until shutdown() is called; run by each worker
+        void work()
+        {
+            AutoMutex am(_mutex);
+            while (!_shutdown) {
+                if (_next >= _count || _next >= _front + _chunks.size()) {
+                    _cv.wait(_mutex);
+                    continue;
+                }
+                size_t index = _next++;
+                Chunk & chunk = _chunks[index % _chunks.size()];
+                ++_busy;
+                _mutex.unlock();
+                try {
+                    chunk.count = _parser.parseChunk(chunk.records, _data, _size,
+                                                     lineStart(index), lineStart(index + 1));
+                } catch (...) {
+                    // The reader reads these lines itself
+                    chunk.count = 0;
+                }
+                _mutex.lock();
+                chunk.ready = true;
+                --_busy;
+                _cv.broadcast();
+            }
+        }
+
+        /**
+         * Find the record that starts at an offset, and drop the records
+         * before it; only the reader calls this
+         * @param offset offset of the next record the reader expects
+         * @return the record, valid until the next call, or NULL if there
+         * is none at that offset
+         */
+        Record * find(uint64_t offset)
+        {
+            for (;;) {
+                if (_current) {
+                    while (_record < _current->count && _current->records[_record].begin < offset) {
+                        ++_record;
+                    }
+                    if (_record < _current->count) {
+                        Record & record = _current->records[_record];
+                        return record.begin == offset ? &record : NULL;
+                    }
+                }
+                if (!advance()) {
+                    return NULL;
+                }
+            }
+        }
+
+    private:
+        // Release the current chunk, and wait for the next one
+        bool advance()
+        {
+            AutoMutex am(_mutex);
+            if (_current) {
+                _current->ready = false;
+                _current = NULL;
+                ++_front;
+                _cv.broadcast();
+            }
+            if (_front >= _count) {
+                return false;
+            }
+            Chunk & chunk = _chunks[_front % _chunks.size()];
+            while (!chunk.ready && !_shutdown) {
+                _cv.wait(_mutex);
+            }
+            if (_shutdown) {
+                return false;
+            }
+            _current = &chunk;
+            _record = 0;
+            return true;
+        }
+
+        // Start of the first line of a chunk
+        size_t lineStart(size_t index) const
+        {
+            size_t pos = index * _chunkSize;
+            if (pos == 0 || pos >= _size) {
+                return pos < _size ? pos : _size;
+            }
+            while (pos < _size && _data[pos - 1] != '\n' && _data[pos - 1] != '\r') {
+                ++pos;
+            }
+            return pos;
+        }
+
+        Parser const & _parser;
+        size_t _chunkSize;
+        std::vector<Chunk> _chunks; // chunk i is in _chunks[i % size]
+        Mutex _mutex;
+        CV _cv;
+        char const * _data;
+        size_t _size;
+        size_t _count;   // number of chunks in the buffer
+        size_t _next;    // next chunk to parse
+        size_t _front;   // chunk of the reader
+        size_t _busy;    // number of chunks being parsed
+        Chunk * _current; // chunk of the reader, once it is ready
+        size_t _record;  // next record of the reader in _current
+        bool _shutdown;
+    };
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_CHUNK_PIPELINE_H */
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_DIRECTORY_WATCHER_H
+#define SPL_RUNTIME_DIRECTORY_WATCHER_H
+
+#include <boost/noncopyable.hpp>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <vector>
+
+namespace SPL
+{
+    /**
+     * Watch a directory for files that are written or moved into it, with
+     * inotify.
+     *
+     * The watcher reports the files closed after being written
+     * (IN_CLOSE_WRITE) and the files moved into the directory
+     * (IN_MOVED_TO), but not the sub-directories. When the kernel drops
+     * events because its queue is full, or when the directory is removed
+     * or replaced, which drops the watch, the watcher says so, and its user
+     * has to watch the directory again and list it to find the files it
+     * missed.
+     */
+    class DirectoryWatcher : private boost::noncopyable
+    {
+    public:
+        DirectoryWatcher() : _fd(-1)
+        {
+            _wakeup[0] = _wakeup[1] = -1;
+        }
+
+        ~DirectoryWatcher()
+        {
+            close();
+        }
+
+        /**
+         * Start watching a directory
+         * @param directory path of the directory
+         * @return false if the directory cannot be watched, with errno set
+         */
+        bool watch(std::string const & directory)
+        {
+            close();
+            _fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (_fd < 0 || ::pipe2(_wakeup, O_NONBLOCK | O_CLOEXEC) != 0 ||
+                ::inotify_add_watch(_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+                int error = errno;
+                close();
+                errno = error;
+                return false;
+            }
+            return true;
+        }
+
+        /// Stop watching the directory
+        void close()
+        {
+            if (_fd >= 0) {
+                ::close(_fd);
+            }
+            if (_wakeup[0] >= 0) {
+                ::close(_wakeup[0]);
+                ::close(_wakeup[1]);
+            }
+            _fd = _wakeup[0] = _wakeup[1] = -1;
+        }
+
+        /**
+         * Wait for files to be written or moved into the directory
+         * @param timeout maximum time to wait, in seconds
+         * @param names appended with the names of the files, relative to
+         * the directory, possibly more than once
+         * @return false if events were lost, or the directory is no longer
+         * watched, as after it is removed or replaced: call watch() again
+         * before listing the directory
+         */
+        bool wait(double timeout, std::vector<std::string> & names)
+        {
+            struct pollfd fds[2];
+            fds[0].fd = _fd;
+            fds[0].events = POLLIN;
+            fds[1].fd = _wakeup[0];
+            fds[1].events = POLLIN;
+            int ms = timeout < INT_MAX / 1000 ? static_cast<int>(timeout * 1000) : INT_MAX;
+            if (::poll(fds, 2, ms < 0 ? 0 : ms) < 0) {
+                return errno == EINTR;
+            }
+            if (fds[1].revents & POLLIN) {
+                char buffer[64];
+                while (::read(_wakeup[0], buffer, sizeof(buffer)) > 0) {
+                }
+            }
+            return (fds[0].revents & POLLIN) ? readEvents(names) : true;
+        }
+
+        /// Make wait() return now; may be called from any thread
+        void wakeup()
+        {
+            if (_wakeup[1] >= 0) {
+                char c = 0;
+                ssize_t n = ::write(_wakeup[1], &c, 1);
+                (void)n; // the pipe is full if it fails: wait() returns anyway
+            }
+        }
+
+    private:
+        // Read the pending events
+        bool readEvents(std::vector<std::string> & names)
+        {
+            bool complete = true;
+            char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+            for (;;) {
+                ssize_t n = ::read(_fd, buffer, sizeof(buffer));
+                if (n <= 0) {
+                    return complete && (n == 0 || errno == EAGAIN || errno == EINTR);
+                }
+                for (char * p = buffer; p < buffer + n;) {
+                    struct inotify_event * event = reinterpret_cast<struct inotify_event *>(p);
+                    if (event->mask & (IN_Q_OVERFLOW | IN_IGNORED)) {
+                        // Events were dropped, or the directory is gone
+                        complete = false;
+                    } else if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+                        names.push_back(event->name);
+                    }
+                    p += sizeof(struct inotify_event) + event->len;
+                }
+            }
+        }
+
+        int _fd;
+        int _wakeup[2]; // pipe that wakeup() writes to
+    };
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_DIRECTORY_WATCHER_H */
@@ -0,0 +1,367 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_EXPIRING_KEYS_H
+#define SPL_RUNTIME_EXPIRING_KEYS_H
+
+#include <SPL/Runtime/Serialization/NativeByteBuffer.h>
+#include <SPL/Runtime/Utility/Hash.h>
+
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <tr1/functional>
+#include <vector>
+#include <stdint.h>
+
+namespace SPL
+{
+    namespace ExpiringKeys
+    {
+        /// Fingerprint of a key, from its std::tr1::hash, whose bits are
+        /// spread so that its low bits can index a table
+        template <typename Key>
+        struct Fingerprint
+        {
+            uint64_t operator()(Key const & key) const
+            {
+                size_t h = std::tr1::hash<Key>()(key);
+                return Hash::hashBytes(&h, sizeof(h));
+            }
+        };
+
+        /// Fingerprint of a key that is already a 64-bit hash
+        struct Identity
+        {
+            uint64_t operator()(uint64_t key) const { return key; }
+        };
+
+        /// Fingerprint of a key from its serialized form, for keys kept
+        /// only as their fingerprints
+        template <typename Key>
+        class SerializedFingerprint
+        {
+        public:
+            uint64_t operator()(Key const & key)
+            {
+                _buffer.setICursor(0);
+                key.serialize(_buffer);
+                return Hash::hashBytes(_buffer.getPtr(), _buffer.getICursor());
+            }
+
+        private:
+            NativeByteBuffer _buffer;
+        };
+
+        /**
+         * Set of keys, each with the value (time, tuple number, attribute)
+         * it was last seen with, from which the keys are expired in the
+         * order they were inserted.
+         *
+         * The entries are kept in a ring, oldest first, which the keys
+         * leave when they expire. They are found through an open-addressing
+         * hash table with linear probing, whose slots hold the fingerprint
+         * of the key and the position of its entry in the ring. This takes
+         * no allocation per key, and one copy of each key.
+         *
+         * Updating the value of a key leaves its entry in place. When the
+         * entry reaches the front of the ring, and its previous value has
+         * expired but not the updated one, it is moved to the back instead
+         * of being removed.
+         */
+        template <typename Key, typename Value, typename Hash = Fingerprint<Key> >
+        class Table
+        {
+        public:
+            struct Entry
+            {
+                Entry() {}
+                Entry(Key const & k, Value const & v) : key(k), value(v), queued(v) {}
+                Key key;
+                Value value;  // value the key was last seen with
+                Value queued; // value the entry was queued in the ring with
+            };
+
+        private:
+            struct Slot
+            {
+                uint64_t fingerprint;
+                uint64_t position; // position in the ring, plus the number of pops
+            };
+
+            typedef std::deque<Entry> RingType;
+
+            enum
+            {
+                minCapacity = 16
+            };
+            static uint64_t emptySlot() { return ~static_cast<uint64_t>(0); }
+
+        public:
+            typedef typename RingType::const_iterator const_iterator;
+
+            Table() : _popped(0) { _slots.resize(minCapacity, makeSlot(0, emptySlot())); }
+
+            /**
+             * Find a key
+             * @param key key to find
+             * @return value the key was last seen with, or NULL if the key is
+             * not in the table
+             */
+            Value * find(Key const & key)
+            {
+                uint64_t fingerprint = _hash(key);
+                size_t mask = _slots.size() - 1;
+                for (size_t i = fingerprint & mask;; i = (i + 1) & mask) {
+                    Slot const & slot = _slots[i];
+                    if (slot.position == emptySlot()) {
+                        return NULL;
+                    }
+                    if (slot.fingerprint == fingerprint) {
+                        Entry & entry = _ring[slot.position - _popped];
+                        if (entry.key == key) {
+                            return &entry.value;
+                        }
+                    }
+                }
+            }
+
+            /**
+             * Insert a key, as the newest one
+             * @pre the key is not in the table
+             */
+            void insert(Key const & key, Value const & value)
+            {
+                if ((_ring.size() + 1) * 4 > _slots.size() * 3) {
+                    rehash(_slots.size() * 2);
+                }
+                place(makeSlot(_hash(key), _popped + _ring.size()));
+                _ring.push_back(Entry(key, value));
+            }
+
+            /**
+             * Remove the keys that have expired, oldest first
+             * @param expired predicate that tells whether a value has expired
+             */
+            template <typename Expired>
+            void expire(Expired const & expired)
+            {
+                while (!_ring.empty()) {
+                    Entry & oldest = _ring.front();
+                    if (!expired(oldest.queued)) {
+                        break;
+                    }
+                    size_t i = locate(oldest.key, _popped);
+                    if (expired(oldest.value)) {
+                        erase(i);
+                    } else {
+                        // Seen again since it was queued: queue it again
+                        _slots[i].position = _popped + _ring.size();
+                        oldest.queued = oldest.value;
+                        _ring.push_back(oldest);
+                    }
+                    _ring.pop_front();
+                    ++_popped;
+                }
+                if (_slots.size() > minCapacity && _ring.size() * 8 < _slots.size()) {
+                    rehash(_slots.size() / 2);
+                }
+            }
+
+            /// Iterate over the entries, oldest first
+            const_iterator begin() const { return _ring.begin(); }
+            const_iterator end() const { return _ring.end(); }
+
+            size_t size() const { return _ring.size(); }
+            bool empty() const { return _ring.empty(); }
+
+            /// Bytes used by the entries and the slots, not counting the
+            /// memory that the keys refer to
+            uint64_t getMemoryUsage() const
+            {
+                return _ring.size() * sizeof(Entry) + _slots.capacity() * sizeof(Slot);
+            }
+
+            void clear()
+            {
+                RingType().swap(_ring);
+                std::vector<Slot>(minCapacity, makeSlot(0, emptySlot())).swap(_slots);
+                _popped = 0;
+            }
+
+        private:
+            static Slot makeSlot(uint64_t fingerprint, uint64_t position)
+            {
+                Slot slot;
+                slot.fingerprint = fingerprint;
+                slot.position = position;
+                return slot;
+            }
+
+            // Put a slot in the first free place from its home
+            void place(Slot const & slot)
+            {
+                size_t mask = _slots.size() - 1;
+                size_t i = slot.fingerprint & mask;
+                while (_slots[i].position != emptySlot()) {
+                    i = (i + 1) & mask;
+                }
+                _slots[i] = slot;
+            }
+
+            // Find the slot of the entry at the given position
+            size_t locate(Key const & key, uint64_t position) const
+            {
+                size_t mask = _slots.size() - 1;
+                size_t i = _hash(key) & mask;
+                while (_slots[i].position != position) {
+                    assert(_slots[i].position != emptySlot());
+                    i = (i + 1) & mask;
+                }
+                return i;
+            }
+
+            // Empty a slot, shifting back the slots that follow it in the
+            // same probe sequence, so that no tombstone is needed
+            void erase(size_t i)
+            {
+                size_t mask = _slots.size() - 1;
+                for (size_t j = (i + 1) & mask; _slots[j].position != emptySlot();
+                     j = (j + 1) & mask) {
+                    size_t home = _slots[j].fingerprint & mask;
+                    // Move slot j to i, unless its home is cyclically in (i, j]
+                    bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+                    if (!stays) {
+                        _slots[i] = _slots[j];
+                        i = j;
+                    }
+                }
+                _slots[i].position = emptySlot();
+            }
+
+            void rehash(size_t capacity)
+            {
+                std::vector<Slot> slots(capacity, makeSlot(0, emptySlot()));
+                _slots.swap(slots);
+                for (size_t i = 0, n = slots.size(); i < n; ++i) {
+                    if (slots[i].position != emptySlot()) {
+                        place(slots[i]);
+                    }
+                }
+            }
+
+            RingType _ring;
+            std::vector<Slot> _slots; // the size is a power of 2
+            uint64_t _popped;
+            Hash _hash;
+        };
+
+        /// Written in place of the number of keys by the checkpoints of a
+        /// table of fingerprints
+        const uint32_t fingerprintsMarker = 0xffffffff;
+
+        /**
+         * Checkpoint the entries of a table of keys
+         * @param ckpt checkpoint, or buffer, to write to
+         * @param table table to checkpoint
+         */
+        template <typename Stream, typename Key, typename Value, typename Hash>
+        void checkpointKeys(Stream & ckpt, Table<Key, Value, Hash> const & table)
+        {
+            uint32_t size = table.size();
+            ckpt << size;
+            typedef typename Table<Key, Value, Hash>::const_iterator Iterator;
+            for (Iterator it = table.begin(); it != table.end(); ++it) {
+                ckpt << it->key;
+                ckpt << it->value;
+            }
+        }
+
+        /**
+         * Checkpoint the entries of a table of fingerprints, after a marker
+         * that tells them from keys
+         * @param ckpt checkpoint, or buffer, to write to
+         * @param table table to checkpoint
+         */
+        template <typename Stream, typename Value>
+        void checkpointFingerprints(Stream & ckpt, Table<uint64_t, Value, Identity> const & table)
+        {
+            uint32_t marker = fingerprintsMarker;
+            ckpt << marker;
+            checkpointKeys(ckpt, table);
+        }
+
+        /**
+         * Restore the entries of a table of keys, oldest first
+         * @param ckpt checkpoint, or buffer, to read from
+         * @param table empty table to restore
+         * @return false if the checkpoint holds fingerprints, from which the
+         * keys cannot be recovered
+         */
+        template <typename Stream, typename Key, typename Value, typename Hash>
+        bool resetKeys(Stream & ckpt, Table<Key, Value, Hash> & table)
+        {
+            uint32_t size = 0;
+            ckpt >> size;
+            if (size == fingerprintsMarker) {
+                return false;
+            }
+            Key key;
+            Value value;
+            for (uint32_t i = 0; i < size; ++i) {
+                ckpt >> key;
+                ckpt >> value;
+                table.insert(key, value);
+            }
+            return true;
+        }
+
+        /**
+         * Restore the entries of a table of fingerprints, oldest first, from a
+         * checkpoint of fingerprints or of keys
+         * @param ckpt checkpoint, or buffer, to read from
+         * @param table empty table to restore
+         * @param fingerprint fingerprint of the keys, for a checkpoint of keys
+         */
+        template <typename Key, typename Stream, typename Value, typename Fingerprinter>
+        void resetFingerprints(Stream & ckpt,
+                               Table<uint64_t, Value, Identity> & table,
+                               Fingerprinter & fingerprint)
+        {
+            uint32_t size = 0;
+            ckpt >> size;
+            if (size == fingerprintsMarker) {
+                resetKeys(ckpt, table);
+                return;
+            }
+            Key key;
+            Value value;
+            for (uint32_t i = 0; i < size; ++i) {
+                ckpt >> key;
+                ckpt >> value;
+                // Keys with the same fingerprint keep the newest value
+                uint64_t f = fingerprint(key);
+                if (Value * found = table.find(f)) {
+                    *found = value;
+                } else {
+                    table.insert(f, value);
+                }
+            }
+        }
+    } // namespace ExpiringKeys
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_EXPIRING_KEYS_H */
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_MAPPED_FILE_H
+#define SPL_RUNTIME_MAPPED_FILE_H
+
+#include <boost/iostreams/categories.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace SPL
+{
+    /**
+     * Handling of the SIGBUS raised by a read of a mapping past the end of
+     * its file, when the file is truncated after it is mapped.
+     *
+     * The mappings are registered with a handler which, for a fault in one
+     * of them, flags the mapping as truncated and replaces its pages from
+     * the faulting one on with zero-filled pages, so that the read returns.
+     * A fault elsewhere is passed to the handler installed before.
+     */
+    namespace MappedFileGuard
+    {
+        struct Region
+        {
+            char * volatile begin;
+            char * volatile end;
+            volatile sig_atomic_t * truncated;
+        };
+
+        enum { maxRegions = 64 };
+
+        inline Region * regions()
+        {
+            static Region r[maxRegions];
+            return r;
+        }
+
+        inline struct sigaction & previousAction()
+        {
+            static struct sigaction action;
+            return action;
+        }
+
+        inline long & pageSize()
+        {
+            static long size = 0;
+            return size;
+        }
+
+        inline void onSigbus(int sig, siginfo_t * info, void * context)
+        {
+            char * addr = static_cast<char *>(info->si_addr);
+            Region * r = regions();
+            for (int i = 0; i < maxRegions; ++i) {
+                char * begin = r[i].begin;
+                char * end = r[i].end;
+                if (begin == NULL || addr < begin || addr >= end) {
+                    continue;
+                }
+                // The flag is set before the pages are replaced, so that a
+                // reader which sees a zero-filled page sees it set
+                *r[i].truncated = 1;
+                __sync_synchronize();
+                char * page = begin + (addr - begin) / pageSize() * pageSize();
+                if (::mmap(page, end - page, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                           -1, 0) != MAP_FAILED) {
+                    return;
+                }
+                break;
+            }
+            struct sigaction const & previous = previousAction();
+            if (previous.sa_flags & SA_SIGINFO) {
+                previous.sa_sigaction(sig, info, context);
+            } else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+                previous.sa_handler(sig);
+            } else {
+                // The read faults again on return, with the default action
+                ::signal(sig, SIG_DFL);
+            }
+        }
+
+        inline void installOnce()
+        {
+            pageSize() = ::sysconf(_SC_PAGESIZE);
+            struct sigaction action;
+            action.sa_sigaction = onSigbus;
+            action.sa_flags = SA_SIGINFO;
+            sigemptyset(&action.sa_mask);
+            ::sigaction(SIGBUS, &action, &previousAction());
+        }
+
+        /**
+         * Register a mapping
+         * @return false if too many mappings are registered
+         */
+        inline bool add(char * begin, size_t size, volatile sig_atomic_t * truncated)
+        {
+            static pthread_once_t once = PTHREAD_ONCE_INIT;
+            pthread_once(&once, installOnce);
+            Region * r = regions();
+            for (int i = 0; i < maxRegions; ++i) {
+                if (__sync_bool_compare_and_swap(&r[i].begin, (char *)NULL, begin)) {
+                    r[i].truncated = truncated;
+                    __sync_synchronize();
+                    r[i].end = begin + size;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Unregister a mapping, before it is unmapped
+        inline void remove(char * begin)
+        {
+            Region * r = regions();
+            for (int i = 0; i < maxRegions; ++i) {
+                if (r[i].begin == begin) {
+                    r[i].end = NULL;
+                    __sync_synchronize();
+                    r[i].begin = NULL;
+                    return;
+                }
+            }
+        }
+    }; // namespace MappedFileGuard
+
+    /**
+     * Read-only memory mapping of a whole file, for reading it
+     * sequentially.
+     *
+     * The kernel is told that the file is read sequentially, so that it
+     * reads ahead aggressively and drops the pages already read, and that
+     * it may back the mapping with huge pages where the file system
+     * supports it. The mapping covers the size of the file when it is
+     * mapped: data appended later is not seen. If the file is truncated
+     * while it is mapped, the pages past its new end read as zeros rather
+     * than raising SIGBUS, and truncated() is true from then on: the data
+     * read once it is true may come from these pages.
+     */
+    class MappedFile : private boost::noncopyable
+    {
+    public:
+        MappedFile() : _data(NULL), _size(0), _truncated(0) {}
+
+        /**
+         * Map a file
+         * @param fd file descriptor, which may be closed once the file is mapped
+         * @return false if the file is not a regular file, or cannot be mapped
+         */
+        bool map(int fd)
+        {
+            unmap();
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+                return false;
+            }
+            if (st.st_size == 0) {
+                return true; // nothing to map
+            }
+            void * data = ::mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED) {
+                return false;
+            }
+            if (!MappedFileGuard::add(static_cast<char *>(data), st.st_size, &_truncated)) {
+                ::munmap(data, st.st_size);
+                return false;
+            }
+            _data = static_cast<char *>(data);
+            _size = st.st_size;
+            // Only hints: errors are ignored
+            ::madvise(data, _size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+            ::madvise(data, _size, MADV_HUGEPAGE);
+#endif
+            return true;
+        }
+
+        /// Unmap the file, if it is mapped
+        void unmap()
+        {
+            if (_data) {
+                MappedFileGuard::remove(_data);
+                ::munmap(_data, _size);
+            }
+            _data = NULL;
+            _size = 0;
+            _truncated = 0;
+        }
+
+        ~MappedFile() { unmap(); }
+
+        char const * data() const { return _data; }
+        size_t size() const { return _size; }
+
+        /// Has the file been found truncated since it was mapped?
+        bool truncated() const
+        {
+            __sync_synchronize();
+            return _truncated != 0;
+        }
+
+    private:
+        char * _data;
+        size_t _size;
+        volatile sig_atomic_t _truncated;
+    };
+
+    /**
+     * Direct source device for boost iostreams over a MappedFile, which
+     * reads it without copying. The MappedFile must outlive the device.
+     */
+    class MappedFileSource
+    {
+    public:
+        typedef char char_type;
+        struct category
+          : boost::iostreams::input_seekable
+          , boost::iostreams::device_tag
+          , boost::iostreams::direct_tag
+        {};
+
+        MappedFileSource(MappedFile const & file) : _file(&file) {}
+
+        std::pair<char *, char *> input_sequence()
+        {
+            char * data = const_cast<char *>(_file->data());
+            return std::make_pair(data, data + _file->size());
+        }
+
+    private:
+        MappedFile const * _file;
+    };
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_MAPPED_FILE_H */
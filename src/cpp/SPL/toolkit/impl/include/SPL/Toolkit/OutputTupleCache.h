@@ -0,0 +1,76 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_OUTPUT_TUPLE_CACHE_H
+#define SPL_RUNTIME_OUTPUT_TUPLE_CACHE_H
+
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+
+namespace SPL
+{
+    /**
+     * Output tuple of an operator, reused from one submission to the next
+     * instead of constructing a tuple for each.
+     *
+     * Setting the attributes of the reused tuple keeps the storage of its
+     * strings, lists and blobs when it is large enough, so once the tuple
+     * is warm, populating it usually allocates no memory. The tuple is only
+     * lent to the downstream operators while it is submitted: those that
+     * keep it, such as the windows, keep a copy.
+     *
+     * The tuple is leased to one submission at a time. While it is leased,
+     * to another thread or to a submission that comes back to the operator
+     * through a loop in the graph, a new lease gets no tuple, and the
+     * operator constructs one as it would without the cache.
+     */
+    template <typename T>
+    class OutputTupleCache : private boost::noncopyable
+    {
+    public:
+        OutputTupleCache() : _leased(0) {}
+
+        /// Lease of the tuple of a cache, for the scope of the lease
+        class Lease : private boost::noncopyable
+        {
+        public:
+            Lease(OutputTupleCache & cache)
+              : _cache(cache),
+                _tuple(__sync_bool_compare_and_swap(&cache._leased, 0, 1) ? &cache._tuple : NULL)
+            {}
+
+            ~Lease()
+            {
+                if (_tuple) {
+                    __sync_lock_release(&_cache._leased);
+                }
+            }
+
+            /// @return the tuple, or NULL if it is leased already
+            T * get() const { return _tuple; }
+
+        private:
+            OutputTupleCache & _cache;
+            T * _tuple;
+        };
+
+    private:
+        T _tuple;
+        volatile int _leased;
+    };
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_OUTPUT_TUPLE_CACHE_H */
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_READ_COPY_UPDATE_H
+#define SPL_RUNTIME_READ_COPY_UPDATE_H
+
+#include <SPL/Runtime/Utility/BackoffSpinner.h>
+
+#include <boost/atomic/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <stdint.h>
+
+namespace SPL
+{
+    /**
+     * Read-copy-update holder for a value that is read much more often
+     * than it is updated.
+     *
+     * Readers get the current snapshot of the value without locking or
+     * waiting. A writer copies the value, changes the copy, and publishes
+     * it; the previous snapshot is deleted after a grace period, once the
+     * readers that may use it are done. Readers register in one of two
+     * counters, and the writer waits for each of them to drain in turn,
+     * after pointing the new readers to the other one (as in sleepable
+     * RCU). Writers must be serialized by the caller, and wait for the
+     * readers, so they are meant to be rare.
+     */
+    template <typename T>
+    class ReadCopyUpdate : private boost::noncopyable
+    {
+    public:
+        /// Read access to the current snapshot, for the lifetime of the reader
+        class Reader : private boost::noncopyable
+        {
+        public:
+            Reader(ReadCopyUpdate const & rcu)
+              : _rcu(rcu), _phase(rcu._phase.load())
+            {
+                _rcu._readers[_phase].fetch_add(1);
+                _value = _rcu._current.load();
+            }
+
+            ~Reader() { _rcu._readers[_phase].fetch_sub(1); }
+
+            T const & operator*() const { return *_value; }
+            T const * operator->() const { return _value; }
+
+        private:
+            ReadCopyUpdate const & _rcu;
+            uint32_t _phase;
+            T const * _value;
+        };
+
+        ReadCopyUpdate() : _current(new T()), _phase(0)
+        {
+            _readers[0].store(0);
+            _readers[1].store(0);
+        }
+
+        ~ReadCopyUpdate() { delete _current.load(); }
+
+        /// Get the current snapshot; only for writers
+        T const & get() const { return *_current.load(); }
+
+        /**
+         * Publish a new snapshot, and delete the previous one once no reader
+         * uses it.
+         * @param value new snapshot, which this object takes ownership of
+         */
+        void update(T * value)
+        {
+            T * previous = _current.exchange(value);
+            synchronize();
+            delete previous;
+        }
+
+    private:
+        // Wait for the readers that started before the update
+        void synchronize()
+        {
+            for (int i = 0; i < 2; ++i) {
+                uint32_t phase = _phase.load();
+                _phase.store(1 - phase);
+                BackoffSpinner spinner;
+                while (_readers[phase].load() != 0) {
+                    spinner.wait();
+                }
+            }
+        }
+
+        boost::atomic<T *> _current;
+        boost::atomic<uint32_t> _phase;
+        mutable boost::atomic<uint32_t> _readers[2];
+    };
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_READ_COPY_UPDATE_H */
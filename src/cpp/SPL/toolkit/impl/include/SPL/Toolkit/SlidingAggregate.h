@@ -0,0 +1,229 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_SLIDING_AGGREGATE_H
+#define SPL_RUNTIME_SLIDING_AGGREGATE_H
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#include <stdint.h>
+
+namespace SPL
+{
+    namespace SlidingAggregate
+    {
+        /*
+         * Helper classes to implement Sliding Aggregates incrementally.
+         * Each class holds the partial aggregate of a range of consecutive
+         * tuples: lift() sets it to the aggregate of a single tuple, and
+         * combine() appends the partial aggregate of the range that
+         * immediately follows.
+         * AttributeType is the type of the attribute being aggregated.
+         * ResultType is the type of the result of the Aggregate
+         */
+
+        /// Result: the number of items in the partition
+        template <typename ResultType>
+        class Count
+        {
+        public:
+            Count() : _count(0) {}
+            void lift() { _count = 1; }
+            void combine(Count const & newer) { _count += newer._count; }
+            ResultType operator ()() const { return _count; }
+
+        private:
+            ResultType _count;
+        };
+
+        /// Result: First item in the partition
+        template <typename AttributeType, typename ResultType>
+        class First
+        {
+        public:
+            void lift(AttributeType const & a) { _value = a; }
+            void combine(First const & newer) {}
+            const ResultType & operator ()() const { return _value; }
+
+        private:
+            ResultType _value;
+        };
+
+        /// Result: Last item in the partition
+        template <typename AttributeType, typename ResultType>
+        class Last
+        {
+        public:
+            void lift(AttributeType const & a) { _value = a; }
+            void combine(Last const & newer) { _value = newer._value; }
+            const ResultType & operator ()() const { return _value; }
+
+        private:
+            ResultType _value;
+        };
+
+        /// Result: Any item in the partition - use the last one (to get same answer as non
+        // incremental version)
+        template <typename AttributeType, typename ResultType>
+        class Any : public Last<AttributeType, ResultType> {
+        };
+
+        /// Result: Minimum value in the partition
+        template <typename AttributeType, typename ResultType>
+        class Min
+        {
+        public:
+            void lift(AttributeType const & a) { _value = a; }
+            void combine(Min const & newer) { _value = std::min(_value, newer._value); }
+            const ResultType & operator ()() const { return _value; }
+
+        private:
+            ResultType _value;
+        };
+
+        /// Result: Maximum value in the partition
+        template <typename AttributeType, typename ResultType>
+        class Max
+        {
+        public:
+            void lift(AttributeType const & a) { _value = a; }
+            void combine(Max const & newer) { _value = std::max(_value, newer._value); }
+            const ResultType & operator ()() const { return _value; }
+
+        private:
+            ResultType _value;
+        };
+
+        /// Result: Sum of all values
+        template <typename AttributeType, typename ResultType>
+        class Sum
+        {
+        public:
+            void lift(AttributeType const & a) { _sum = a; }
+            void combine(Sum const & newer) { _sum += newer._sum; }
+            const ResultType operator ()() const { return _sum; }
+
+        private:
+            ResultType _sum;
+        };
+
+        /// Result: Average of all values (floating point only)
+        template <typename AttributeType, typename ResultType>
+        class Average
+        {
+        public:
+            Average() : _average(0), _count(0) {}
+            void lift(AttributeType const & a)
+            {
+                _average = a;
+                _count = 1;
+            }
+            void combine(Average const & newer)
+            {
+                _count += newer._count;
+                _average += (newer._average - _average) *
+                            (static_cast<ResultType>(newer._count) / static_cast<ResultType>(_count));
+            }
+            const ResultType operator ()() const { return _average; }
+
+        private:
+            ResultType _average;
+            int64_t _count;
+        };
+
+        /**
+         * Two-stacks sliding window aggregation: tuples are pushed at the
+         * back and popped from the front, and the aggregate of all the
+         * tuples is available in O(1). Pushes and pops are O(1) amortized:
+         * when the front stack runs out, the back stack is flipped onto it
+         * once, computing the aggregate of each suffix.
+         *
+         * Partial is a set of the helper classes above, with a combine()
+         * that combines each of them. Since partials are combined in a
+         * different order than a left-to-right pass over the window, a
+         * floating point sum may differ in its last bits.
+         */
+        template <typename Partial>
+        class TwoStacks
+        {
+        public:
+            /// Append the partial aggregate of the newest tuple
+            void push(Partial const & partial)
+            {
+                if (_back.empty()) {
+                    _backAggregate = partial;
+                } else {
+                    _backAggregate.combine(partial);
+                }
+                _back.push_back(partial);
+            }
+
+            /// Remove the oldest tuple
+            void pop()
+            {
+                if (_front.empty()) {
+                    flip();
+                }
+                assert(!_front.empty());
+                _front.pop_back();
+            }
+
+            /// Get the aggregate of all the tuples, if any
+            void query(Partial & result) const
+            {
+                if (_front.empty()) {
+                    result = _backAggregate;
+                } else {
+                    result = _front.back();
+                    if (!_back.empty()) {
+                        result.combine(_backAggregate);
+                    }
+                }
+            }
+
+            bool empty() const { return _front.empty() && _back.empty(); }
+
+            void clear()
+            {
+                _front.clear();
+                _back.clear();
+            }
+
+        private:
+            void flip()
+            {
+                _front.reserve(_back.size());
+                for (size_t i = _back.size(); i-- > 0;) {
+                    if (_front.empty()) {
+                        _front.push_back(_back[i]);
+                    } else {
+                        Partial suffix(_back[i]);
+                        suffix.combine(_front.back());
+                        _front.push_back(suffix);
+                    }
+                }
+                _back.clear();
+            }
+
+            std::vector<Partial> _front; // suffix aggregates, the oldest tuple's last
+            std::vector<Partial> _back;  // newest tuples, oldest first
+            Partial _backAggregate;      // aggregate of _back
+        };
+    } // namespace SlidingAggregate
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_SLIDING_AGGREGATE_H */
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_SORTED_WINDOW_H
+#define SPL_RUNTIME_SORTED_WINDOW_H
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <set>
+#include <stdint.h>
+
+namespace SPL
+{
+    namespace SortedWindow
+    {
+        /**
+         * Order-statistics index over the data of a count-based sliding
+         * window partition, to keep it sorted in O(log n).
+         *
+         * The window pushes tuples at the back of its data and evicts them
+         * from the front. The index keeps the tuples in a balanced tree
+         * ordered by Compare (stable for equal tuples), together with the
+         * position of each tuple in the data. Before an eviction, the
+         * smallest tuple is swapped into the front position, so that the
+         * window evicts the tuples in order. The data itself is thus not
+         * sorted: iterate over the index instead.
+         */
+        template <typename T, typename Compare>
+        class Index
+        {
+            struct Entry
+            {
+                Entry(T const & t, uint64_t p) : tuple(t), pos(p) {}
+                T tuple;
+                mutable uint64_t pos; // position in the data, plus the number of pops
+            };
+
+            struct EntryCompare
+            {
+                EntryCompare(Compare const & c) : compare(c) {}
+                bool operator()(Entry const & lhs, Entry const & rhs) const
+                {
+                    return compare(lhs.tuple, rhs.tuple);
+                }
+                mutable Compare compare;
+            };
+
+            typedef std::multiset<Entry, EntryCompare> SetType;
+
+        public:
+            /// Iterator over the tuples, in order
+            class const_iterator
+            {
+            public:
+                const_iterator(typename SetType::const_iterator it) : _it(it) {}
+                T const & operator*() const { return _it->tuple; }
+                const_iterator & operator++()
+                {
+                    ++_it;
+                    return *this;
+                }
+                bool operator==(const_iterator const & other) const { return _it == other._it; }
+                bool operator!=(const_iterator const & other) const { return _it != other._it; }
+
+            private:
+                typename SetType::const_iterator _it;
+            };
+
+            Index(Compare const & compare) : _set(EntryCompare(compare)), _popped(0) {}
+
+            Index(Index const & other)
+              : _set(other._set.key_comp()), _popped(0)
+            {
+                assert(other.empty());
+            }
+
+            /// Add the tuple just pushed at the back of the data
+            void push(T const & tuple)
+            {
+                _slots.push_back(_set.insert(Entry(tuple, _popped + _slots.size())));
+            }
+
+            /**
+             * Move the smallest tuple to the front of the data, and remove it
+             * from the index. Call this before the window pops the front.
+             * @param data window data, which holds the same tuples as the index
+             */
+            template <typename Data>
+            void popSmallest(Data & data)
+            {
+                assert(!_slots.empty() && data.size() == _slots.size());
+                typename SetType::iterator smallest = _set.begin();
+                size_t pos = smallest->pos - _popped;
+                if (pos != 0) {
+                    typename SetType::iterator front = _slots.front();
+                    front->pos = smallest->pos;
+                    std::swap(data[0], data[pos]);
+                    std::swap(_slots[0], _slots[pos]);
+                }
+                _set.erase(smallest);
+                _slots.pop_front();
+                ++_popped;
+            }
+
+            const_iterator begin() const { return const_iterator(_set.begin()); }
+            const_iterator end() const { return const_iterator(_set.end()); }
+            size_t size() const { return _slots.size(); }
+            bool empty() const { return _slots.empty(); }
+
+            void clear()
+            {
+                _set.clear();
+                _slots.clear();
+                _popped = 0;
+            }
+
+        private:
+            SetType _set;
+            std::deque<typename SetType::iterator> _slots; // the tuples, in data order
+            uint64_t _popped;
+        };
+
+        /**
+         * Sort a range with a merge of its ascending runs when there are few
+         * of them, as for tuples that arrive almost in order, and with
+         * std::sort otherwise.
+         */
+        template <typename Iterator, typename Compare>
+        void sortRuns(Iterator begin, Iterator end, Compare compare)
+        {
+            size_t size = end - begin;
+            if (size < 2) {
+                return;
+            }
+            // Find the runs, giving up if they are too short to pay off
+            std::deque<Iterator> runs;
+            runs.push_back(begin);
+            size_t maxRuns = size / 16 + 1;
+            for (Iterator it = begin + 1; it != end; ++it) {
+                if (compare(*it, *(it - 1))) {
+                    if (runs.size() == maxRuns) {
+                        std::sort(begin, end, compare);
+                        return;
+                    }
+                    runs.push_back(it);
+                }
+            }
+            // Merge pairs of adjacent runs until one is left
+            runs.push_back(end);
+            while (runs.size() > 2) {
+                std::deque<Iterator> merged;
+                size_t i = 0;
+                for (; i + 2 < runs.size(); i += 2) {
+                    std::inplace_merge(runs[i], runs[i + 1], runs[i + 2], compare);
+                    merged.push_back(runs[i]);
+                }
+                if (i + 1 < runs.size()) {
+                    merged.push_back(runs[i]);
+                }
+                merged.push_back(end);
+                runs.swap(merged);
+            }
+        }
+    } // namespace SortedWindow
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_SORTED_WINDOW_H */
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPL_RUNTIME_TUPLE_POOL_H
+#define SPL_RUNTIME_TUPLE_POOL_H
+
+#include <SPL/Runtime/Utility/Mutex.h>
+
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace SPL
+{
+    /**
+     * Pool of tuples of one type, for operators that keep copies of the
+     * tuples they receive.
+     *
+     * A copy is made into a tuple that was released to the pool, when there
+     * is one, instead of a new tuple. Assigning a tuple keeps the storage
+     * of the strings and collections it already has when they are large
+     * enough, so once the pool is warm a copy usually allocates no memory.
+     * At most maxFree released tuples are kept; the others are deleted.
+     *
+     * The pool may be used by several threads.
+     */
+    template <typename T>
+    class TuplePool : private boost::noncopyable
+    {
+    public:
+        /**
+         * Constructor
+         * @param maxFree maximum number of released tuples kept for reuse
+         */
+        TuplePool(size_t maxFree = 1024) : _maxFree(maxFree) {}
+
+        ~TuplePool()
+        {
+            for (size_t i = 0; i < _free.size(); ++i) {
+                delete _free[i];
+            }
+        }
+
+        /**
+         * Copy a tuple
+         * @param tuple tuple to copy
+         * @return the copy, to give back with release()
+         */
+        T * copy(T const & tuple)
+        {
+            T * t = NULL;
+            {
+                AutoMutex am(_mutex);
+                if (!_free.empty()) {
+                    t = _free.back();
+                    _free.pop_back();
+                }
+            }
+            if (!t) {
+                return new T(tuple);
+            }
+            *t = tuple;
+            return t;
+        }
+
+        /**
+         * Give back a tuple that is no longer used
+         * @param tuple tuple obtained with copy(), or allocated with new
+         */
+        void release(T * tuple)
+        {
+            {
+                AutoMutex am(_mutex);
+                if (_free.size() < _maxFree) {
+                    _free.push_back(tuple);
+                    return;
+                }
+            }
+            delete tuple;
+        }
+
+    private:
+        Mutex _mutex;
+        size_t _maxFree;
+        std::vector<T *> _free;
+    };
+}; // namespace SPL
+
+#endif /*SPL_RUNTIME_TUPLE_POOL_H */
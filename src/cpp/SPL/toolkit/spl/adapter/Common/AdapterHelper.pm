@@ -375,4 +375,31 @@ sub verifySecureModel($)
     }
 }
 
+## @fn bool useCSVScanner($model, $format, $hasDelayField, $genAttrs)
+# This function tells whether a source reads CSV lines with the fast path
+# of SPL::CSVScanner first, falling back to SPL::readCSV for the lines that
+# it does not handle. This is the case when all the attributes read have a
+# type that it converts.
+# @param model Operator Instance Model
+# @param format format of the data read
+# @param hasDelayField true if the lines start with a delay
+# @param genAttrs reference to the list of attributes read
+sub useCSVScanner($$$$)
+{
+    my ($model, $format, $hasDelayField, $genAttrs) = @_;
+    my $opKind = $model->getContext()->getKind();
+    return 0 if $format ne "csv" || $hasDelayField;
+    if ($opKind eq "spl.utility::Parse") {
+        # With a consistent region, Parse relies on the state of its
+        # stream to tell incomplete lines when draining
+        return 0 if $model->getContext()->getOptionalContext("ConsistentRegion");
+    } elsif ($opKind ne "spl.adapter::FileSource" && $opKind ne "spl.adapter::TCPSource") {
+        return 0;
+    }
+    foreach my $attr (@{$genAttrs}) {
+        return 0 unless $attr->getSPLType() =~ /^(boolean|u?int(8|16|32|64)|float(32|64)|rstring)$/;
+    }
+    return 1;
+}
+
 1;
@@ -94,13 +94,42 @@ sub verify($)
                          $hotFile->getSourceLocation()) if $hotFile && $moveFileToDirectory;
     SPL::CodeGen::exitln(SPL::Msg::STDTK_FILESOURCE_OPTION_CONFLICT("deleteFile", "moveFileToDirectory"),
                          $moveFileToDirectory->getSourceLocation()) if $deleteFile && $moveFileToDirectory;
+    my $memoryMapped = $model->getParameterByName("memoryMapped");
+    my $parsingThreads = $model->getParameterByName("parsingThreads");
+    SPL::CodeGen::exitln(SPL::Msg::STDTK_FILESOURCE_OPTION_CONFLICT("hotFile", "memoryMapped"),
+                         $hotFile->getSourceLocation()) if $hotFile && $memoryMapped;
+    SPL::CodeGen::exitln(SPL::Msg::STDTK_FILESOURCE_OPTION_CONFLICT("hotFile", "parsingThreads"),
+                         $hotFile->getSourceLocation()) if $hotFile && $parsingThreads;
     SPL::CodeGen::exitln(SPL::Msg::STDTK_FILESOURCE_HOTFILE_BLOCK_WITHOUT_BLOCKSIZE())
                          if $hotFile && $format eq "block" && !$model->getParameterByName("blockSize");
     SPL::CodeGen::exitln(SPL::Msg::STDTK_PARAMETER_INVALID_IN_CR("deleteFile"),$model->getContext()->getSourceLocation()) if $crContext && $deleteFile;
     my $hotFileValue = $hotFile ? $hotFile->getValueAt(0)->getSPLExpression() eq "true" : 0;
     SPL::CodeGen::exitln(SPL::Msg::STDTK_PARAMETER_INVALID_IN_CR("hotFile"),$model->getContext()->getSourceLocation()) if $crContext && $hotFileValue;
     SPL::CodeGen::exitln(SPL::Msg::STDTK_PARAMETER_INVALID_IN_CR("moveFileToDirectory"),$model->getContext()->getSourceLocation()) if $crContext && $moveFileToDirectory;
+    SPL::CodeGen::exitln(SPL::Msg::STDTK_PARAMETER_INVALID_IN_CR("parsingThreads"),$model->getContext()->getSourceLocation()) if $crContext && $parsingThreads;
     SPL::CodeGen::exitln(SPL::Msg::STDTK_FILESOURCE_WITH_INPUT_PORT_CANNOT_BE_CR_START(),$model->getContext()->getSourceLocation()) if $isStart && $model->getNumberOfInputPorts() != 0;
 }
 
+# Tell whether the lines are parsed on threads ahead of the operator thread,
+# which is when parsingThreads is specified and the lines are read with the
+# CSV scanner, without any filter between the file and the scanner
+sub parallelParsing($)
+{
+    my ($model) = @_;
+    return 0 unless $model->getParameterByName("parsingThreads");
+    return 0 if $model->getParameterByName("compression") || $model->getParameterByName("encoding");
+
+    my $format = $model->getParameterByName("format");
+    $format = $format ? $format->getValueAt(0)->getSPLExpression() : "csv";
+    my $hasDelayField = $model->getParameterByName("hasDelayField");
+    $hasDelayField = $hasDelayField ? $hasDelayField->getValueAt(0)->getSPLExpression() eq "true" : 0;
+    my $outputPort = $model->getOutputPortAt(0);
+    my @genAttrs;
+    for (my $i = 0; $i < $outputPort->getNumberOfAttributes(); $i++) {
+        my $attr = $outputPort->getAttributeAt($i);
+        push @genAttrs, $attr if !$attr->hasAssignment();
+    }
+    return AdapterHelper::useCSVScanner($model, $format, $hasDelayField, \@genAttrs);
+}
+
 1;
@@ -96,6 +96,46 @@ sub hasCustom($)
     return 0;
 }
 
+# Can a sliding window be aggregated incrementally, as tuples are inserted
+# and evicted?  This holds when every output function can be computed by
+# combining the partial results of consecutive tuples, and when the window
+# evicts its oldest tuples first.  A delta eviction policy may evict tuples
+# from the middle of the window when the delta attribute is not monotonic.
+sub canAggregateIncrementally($)
+{
+    my ($model) = @_;
+    my $outputPort = $model->getOutputPortAt(0);
+    my $window = $model->getInputPortAt(0)->getWindow();
+    return 0 if $window->isTumbling() || $window->isTimeInterval();
+    return 0 if $window->getEvictionPolicyType() == $SPL::Operator::Instance::Window::DELTA;
+    return 0 if $model->getParameterByName("groupBy");
+    for (my $i = 0; $i < $outputPort->getNumberOfAttributes(); $i++) {
+        my $attr = $outputPort->getAttributeAt($i);
+        next if !$attr->hasAssignmentWithOutputFunction();
+        my $agg = $attr->getAssignmentOutputFunctionName();
+        my $paramValues = $attr->getAssignmentOutputFunctionParameterValues();
+        my $numArgs = scalar(@{$paramValues});
+        if ($agg eq 'Count') {
+            return 0 if $numArgs != 0;
+            next;
+        }
+        return 0 if $numArgs != 1;
+        next if $agg eq 'First' || $agg eq 'Last' || $agg eq 'Any';
+        my $type = $paramValues->[0]->getSPLType();
+        if ($agg eq 'Min' || $agg eq 'Max') {
+            return 0 if !SPL::CodeGen::Type::isOrdered($type);
+        } elsif ($agg eq 'Sum') {
+            return 0 if !SPL::CodeGen::Type::isIntegral($type) && !SPL::CodeGen::Type::isFloat($type);
+        } elsif ($agg eq 'Average') {
+            return 0 if !SPL::CodeGen::Type::isFloat($type) ||
+                        !SPL::CodeGen::Type::isFloat($attr->getSPLType());
+        } else {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 sub scalarAggregate ($)
 {
     my ($attr) = @_;
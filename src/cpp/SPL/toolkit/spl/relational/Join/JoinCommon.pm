@@ -189,4 +189,35 @@ sub verify($)
     }
 }
 
+# C++ type of the tuples kept in the window of an input port.  With an
+# equality index, they carry their place in the index.
+sub getWindowTupleCppType($$)
+{
+    my ($model, $port) = @_;
+    return "IPort${port}Type*" unless $model->getParameterByName("equalityLHS");
+    return $port == 0 ? "IndexedLHSType*" : "IndexedRHSType*";
+}
+
+# C++ type and getter of the attribute of a delta eviction policy, or an
+# empty list for other policies
+sub getDeltaEvictionAttribute($)
+{
+    my ($window) = @_;
+    return () unless $window->getEvictionPolicyType() == $SPL::Operator::Instance::Window::DELTA;
+    my $attribute = $window->getEvictionPolicyAttribute();
+    my $getter = $attribute->getCppExpression();
+    $getter =~ s/^[^\.]*\.//; # iport$0.get_age() -> get_age()
+    return ($attribute->getCppType(), $getter);
+}
+
+# Name of the member of the window tuple type that the delta eviction
+# policy of the window of an input port uses, or '' for the default one
+sub getWindowDeltaGetter($$)
+{
+    my ($model, $port) = @_;
+    return '' unless $model->getParameterByName("equalityLHS");
+    my $window = $model->getInputPortAt($port)->getWindow();
+    return getDeltaEvictionAttribute($window) ? "getEvictionAttribute" : '';
+}
+
 1;
@@ -50,6 +50,7 @@ ConnectionHandshake::ConnectionHandshake(const DataSender::Id& senderId,
   , nsLabel_(label)
   , requiredConnection_(required)
   , senderId_(senderId)
+  , compression_(false)
 {
     SPCDBG(L_DEBUG,
            "Created Connection Handshake (" << instanceId_ << ":" << nsLabel_
@@ -61,6 +62,7 @@ ConnectionHandshake::ConnectionHandshake(const DataSender::Id& senderId,
 // Serialization constructor with exception if the connection handshake
 // is for the incorrect receiver.
 ConnectionHandshake::ConnectionHandshake(SerializationBuffer& s, const std::string& label)
+  : compression_(false)
 {
     uint32_t recvdMagic = s.getUInt32();
     if (recvdMagic != handshakeMagic) {
@@ -102,6 +104,14 @@ ConnectionHandshake::ConnectionHandshake(SerializationBuffer& s, const std::stri
     senderId_.peId = s.getUInt64();
     senderId_.outPortId = s.getUInt64();
     senderId_.peRestartCount = s.getUInt64();
+    // Senders which do not propose a shared memory ring nor compression
+    // omit the fields
+    if (s.getNRemainingBytes() > 0) {
+        shmRing_ = s.getSTLString();
+    }
+    if (s.getNRemainingBytes() > 0) {
+        compression_ = s.getBool();
+    }
 }
 
 // Serialize the ConnectionHandshake object
@@ -117,11 +127,68 @@ void ConnectionHandshake::serialize(SerializationBuffer& s) const
     s.addUInt64(senderId_.peId);
     s.addUInt64(senderId_.outPortId);
     s.addUInt64(senderId_.peRestartCount);
+    if (!shmRing_.empty() || compression_) {
+        s.addSTLString(shmRing_);
+    }
+    if (compression_) {
+        s.addBool(compression_);
+    }
 }
 
 // Destructor
 ConnectionHandshake::~ConnectionHandshake() {}
 
+// Constructor
+ConnectionHandshakeReply::ConnectionHandshakeReply(const connHandshakeCode reply,
+                                                   const bool compression)
+  : replyCode(reply)
+  , compression_(compression)
+{}
+
+// Serialization constructor with exception if the connection handshake
+// reply indicated an incorrect receiver.
+ConnectionHandshakeReply::ConnectionHandshakeReply(SerializationBuffer& s)
+  : compression_(false)
+{
+    uint32_t recvdMagic = s.getUInt32();
+    if (recvdMagic != handshakeMagic) {
+        HexString hexs(recvdMagic);
+        // Unexpected Magic code {0} received while establishing connection
+        THROW_CHAR(ConnectionHandshake, "Bad Connection Handshake Reply Magic",
+                   TRANSConnectionHandshakeMagic, hexs.c_str());
+    }
+    replyCode = s.getUInt32();
+    if (replyCode == BAD_INSTANCE) {
+        THROW(UnexpectedInstance, "Connection rejected: unexpected instance ID");
+    }
+    if (replyCode == BAD_LABEL) {
+        THROW(UnexpectedLabel, "Connection rejected: unexpected input port label");
+    }
+    // Receivers which do not accept compression omit the field
+    if (s.getNRemainingBytes() > 0) {
+        compression_ = s.getBool();
+    }
+}
+
+// Serialize the ConnectionHandshakeReply object
+void ConnectionHandshakeReply::serialize(SerializationBuffer& s) const
+{
+    s.addUInt32(handshakeMagic);
+    s.addUInt32(replyCode);
+    if (compression_) {
+        s.addBool(compression_);
+    }
+}
+
+// Get the reply code
+ConnectionHandshakeReply::connHandshakeCode ConnectionHandshakeReply::getReplyCode() const
+{
+    return static_cast<connHandshakeCode>(replyCode);
+}
+
+// Destructor
+ConnectionHandshakeReply::~ConnectionHandshakeReply() {}
+
 IMPL_EXCEPTION(Distillery, ConnectionHandshake, Utils);
 IMPL_EXCEPTION(Distillery, UnexpectedInstance, ConnectionHandshake);
 IMPL_EXCEPTION(Distillery, UnexpectedLabel, ConnectionHandshake);
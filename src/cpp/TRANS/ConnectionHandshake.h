@@ -96,6 +96,32 @@ class ConnectionHandshake
      */
     const DataSender::Id& getSenderId() const { return senderId_; }
 
+    /**
+     * Get the name of the shared memory ring proposed by the sender.
+     * @return the ring name, empty if the sender did not propose a ring
+     */
+    const std::string& getShmRing() const { return shmRing_; }
+
+    /**
+     * Propose a shared memory ring as the data path of this connection.
+     * The receiver must answer with a ConnectionHandshakeReply.
+     * @param name name of the ring created by the sender
+     */
+    void setShmRing(const std::string& name) { shmRing_ = name; }
+
+    /**
+     * Determine if the sender proposed to compress the data.
+     * @return true if the sender proposed compression
+     */
+    bool getCompression() const { return compression_; }
+
+    /**
+     * Propose to compress the data of this connection.
+     * The receiver must answer with a ConnectionHandshakeReply.
+     * @param compression true to propose compression
+     */
+    void setCompression(bool compression) { compression_ = compression; }
+
     /** Destructor */
     ~ConnectionHandshake();
 
@@ -110,6 +136,10 @@ class ConnectionHandshake
     bool requiredConnection_;
     // Sender Id
     DataSender::Id senderId_;
+    // Shared memory ring proposed by the sender; optional
+    std::string shmRing_;
+    // Compression proposed by the sender; optional, serialized last
+    bool compression_;
 };
 
 /// This class represents and verifies a connection handshake reply.
@@ -123,12 +153,15 @@ class ConnectionHandshakeReply
         /// Unexpected Instance
         BAD_INSTANCE,
         /// Unexpected Port Label
-        BAD_LABEL
+        BAD_LABEL,
+        /// Connection Handshake OK, proposed shared memory ring not used
+        RING_REFUSED
     };
 
     /// Constructor
     /// @param reply The reply code for this connection handshake
-    ConnectionHandshakeReply(const connHandshakeCode reply);
+    /// @param compression The receiver accepts the proposed compression
+    ConnectionHandshakeReply(const connHandshakeCode reply, const bool compression = false);
 
     /// Serialization constructor with exception if the connection handshake
     /// reply indicated an incorrect receiver.
@@ -144,6 +177,10 @@ class ConnectionHandshakeReply
     /// @return the connection handshake reply code
     connHandshakeCode getReplyCode() const;
 
+    /// Determine if the receiver accepted the proposed compression
+    /// @return true if the sender must compress the data
+    bool getCompression() const { return compression_; }
+
     /// Destructor
     ~ConnectionHandshakeReply();
 
@@ -152,6 +189,8 @@ class ConnectionHandshakeReply
     uint32_t replyCode;
     /// Magic number to verify its a transport message
     const static uint32_t handshakeMagic = 0x03FCFEE;
+    /// The receiver accepted compression; optional, serialized last
+    bool compression_;
 };
 
 DECL_EXCEPTION(UTILS_NAMESPACE, ConnectionHandshake, Utils);
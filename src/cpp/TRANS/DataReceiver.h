@@ -89,6 +89,7 @@ class DataReceiver
           , ns_label(NULL)
           , recipients()
           , operator_ns_label(NULL)
+          , singleThreaded(false)
         {}
         /// Function for processing input
         Callback* callback;
@@ -99,6 +100,10 @@ class DataReceiver
         /// Required number of senders that will connect
         std::set<std::string> recipients;
         const char* operator_ns_label;
+        /// The callback must not run concurrently with the callbacks of the
+        /// other ports, e.g. because it feeds an operator which is single
+        /// threaded on its inputs
+        bool singleThreaded;
     } port_data_t;
 
   public:
@@ -91,6 +91,33 @@ class DataSender
         unsigned int receiverPortIndex;    ///< Compile-time port index of the receiver end
         unsigned int congestionFactor;     ///< Connection congestion factor with
         ///< values 0 (no congestion) to 100 (blocked)
+        uint64_t nBatchesFlushed;          ///< Number of send buffer flushes (0 if not batching)
+        uint64_t nMessagesBatched;         ///< Number of messages written through the send buffer
+        uint64_t nFlushesOnSize;           ///< Flushes caused by the send buffer size threshold
+        uint64_t nFlushesOnDeadline;       ///< Flushes caused by the send buffer latency deadline
+        uint64_t nFlushesOnPunct;          ///< Flushes requested by the client (punctuation)
+        uint64_t nMessagesQueued;          ///< Messages waiting for the asynchronous writer
+        uint64_t nMessagesDropped;         ///< Messages the asynchronous writer could not write
+        uint64_t nBytesBeforeCompression;  ///< Bytes submitted to compression
+        uint64_t nBytesAfterCompression;   ///< Bytes written for the submitted bytes
+        uint64_t compressionTime;          ///< CPU time spent compressing (microseconds)
+
+        OutputCongestion()
+          : receiverPEId(0)
+          , receiverPortId(0)
+          , receiverPortIndex(0)
+          , congestionFactor(0)
+          , nBatchesFlushed(0)
+          , nMessagesBatched(0)
+          , nFlushesOnSize(0)
+          , nFlushesOnDeadline(0)
+          , nFlushesOnPunct(0)
+          , nMessagesQueued(0)
+          , nMessagesDropped(0)
+          , nBytesBeforeCompression(0)
+          , nBytesAfterCompression(0)
+          , compressionTime(0)
+        {}
     };
 
     /// Sender Id (unique in the context of a Streams instance).
@@ -214,6 +241,14 @@ class DataSender
                        bool alwaysRetryAfterReconnect = true,
                        bool resetReconnectionState = false) = 0;
 
+    /**
+     * Write out any data the sender has buffered for its connections.
+     * Clients call this at message boundaries which must not be delayed,
+     * for example after sending a punctuation.  Senders which do not
+     * buffer data ignore the call.
+     */
+    virtual void flush() {}
+
     /**
      * Shutdown
      */
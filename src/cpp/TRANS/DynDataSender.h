@@ -72,6 +72,9 @@ class DynDataSender : public DataSender
                        bool alwaysRetryAfterReconnect = true,
                        bool resetReconnectionState = false);
 
+    /// Write out the data buffered by the underlying sender
+    virtual void flush();
+
     /// Add a connection to a receiver
     /// @param portDesc description of the remote port to connect to
     /// @return a unique connection id
@@ -167,6 +170,11 @@ inline void DynDataSender::write(const std::vector<DataSender::ConnectionId>& id
     _unprotected_sender->write(ids, data, size, alwaysRetryAfterReconnect, resetReconnectionState);
 }
 
+inline void DynDataSender::flush()
+{
+    _unprotected_sender->flush();
+}
+
 inline size_t DynDataSender::getNumberOfSubscribers() const
 {
     return _unprotected_sender->getNumberOfSubscribers();
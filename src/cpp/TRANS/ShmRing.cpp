@@ -0,0 +1,260 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <TRANS/ShmRing.h>
+#include <TRC/DistilleryDebug.h>
+#include <TRC/RuntimeTrcAspects.h>
+#include <UTILS/Formatter.h>
+#include <UTILS/SupportFunctions.h>
+
+#include <boost/atomic.hpp>
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <sstream>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+UTILS_NAMESPACE_USE
+DEBUG_NAMESPACE_USE
+using namespace std;
+
+#define SHM_DIR "/dev/shm/"
+#define CACHE_LINE_SIZE 64
+
+// Interval between two checks of a full ring
+static const uint32_t POLL_USEC = 20;
+
+// Layout of the beginning of the segment. The reader and writer positions
+// are on separate cache lines. Positions increase monotonically; the ring
+// offset is the position modulo the capacity.
+struct ShmRing::Header
+{
+    uint32_t magic;
+    uint32_t capacity;
+    char pad0[CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+    boost::atomic<uint64_t> head; // next position to read
+    char pad1[CACHE_LINE_SIZE - sizeof(boost::atomic<uint64_t>)];
+    boost::atomic<uint64_t> tail; // next position to write
+    char pad2[CACHE_LINE_SIZE - sizeof(boost::atomic<uint64_t>)];
+    boost::atomic<uint32_t> parked; // 1 if the reader waits for a wakeup
+    boost::atomic<uint32_t> closed; // 1 if the reader stopped reading
+    char pad3[CACHE_LINE_SIZE - 2 * sizeof(boost::atomic<uint32_t>)];
+
+    static const uint32_t MAGIC = 0x52494E47; // "RING"
+};
+
+ShmRing* ShmRing::create(uint32_t capacity)
+{
+    uint32_t cap = CACHE_LINE_SIZE;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+
+    // Name unique on the host: pid and a per-process sequence number
+    static boost::atomic<uint32_t> sequence(0);
+    ostringstream ss;
+    ss << "streams-ring-" << getpid() << "-" << sequence.fetch_add(1);
+    string name = ss.str();
+    string path = SHM_DIR + name;
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        THROW(ShmRing, "Unable to create " << QT(path) << ": " << ErrnoFormat(errno));
+    }
+    size_t mapSize = sizeof(Header) + cap;
+    if (ftruncate(fd, mapSize) != 0) {
+        int errNo = errno;
+        ::close(fd);
+        ::unlink(path.c_str());
+        THROW(ShmRing, "Unable to size " << QT(path) << ": " << ErrnoFormat(errNo));
+    }
+    void* addr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        int errNo = errno;
+        ::unlink(path.c_str());
+        THROW(ShmRing, "Unable to map " << QT(path) << ": " << ErrnoFormat(errNo));
+    }
+
+    Header* hdr = new (addr) Header;
+    hdr->capacity = cap;
+    hdr->head.store(0, boost::memory_order_relaxed);
+    hdr->tail.store(0, boost::memory_order_relaxed);
+    hdr->parked.store(0, boost::memory_order_relaxed);
+    hdr->closed.store(0, boost::memory_order_relaxed);
+    hdr->magic = Header::MAGIC;
+
+    SPCDBG(L_DEBUG, "Created ring " << QT(name) << " of " << cap << " bytes", CORE_TRANS_TCP);
+    return new ShmRing(name, hdr, mapSize);
+}
+
+ShmRing* ShmRing::attach(const string& name)
+{
+    // The name comes from the remote end: accept only plain file names
+    if (name.empty() || name.find('/') != string::npos) {
+        THROW(ShmRing, "Invalid ring name " << QT(name));
+    }
+    string path = SHM_DIR + name;
+
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd == -1) {
+        THROW(ShmRing, "Unable to open " << QT(path) << ": " << ErrnoFormat(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        THROW(ShmRing, "Invalid ring segment " << QT(path));
+    }
+    size_t mapSize = st.st_size;
+    void* addr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        THROW(ShmRing, "Unable to map " << QT(path) << ": " << ErrnoFormat(errno));
+    }
+
+    Header* hdr = static_cast<Header*>(addr);
+    if (hdr->magic != Header::MAGIC || sizeof(Header) + hdr->capacity != mapSize) {
+        munmap(addr, mapSize);
+        THROW(ShmRing, "Invalid ring segment " << QT(path));
+    }
+
+    SPCDBG(L_DEBUG, "Attached ring " << QT(name) << " of " << hdr->capacity << " bytes",
+           CORE_TRANS_TCP);
+    return new ShmRing(name, hdr, mapSize);
+}
+
+ShmRing::ShmRing(const string& name, Header* hdr, size_t mapSize)
+  : name_(name)
+  , hdr_(hdr)
+  , data_(reinterpret_cast<unsigned char*>(hdr) + sizeof(Header))
+  , mapSize_(mapSize)
+  , mask_(hdr->capacity - 1)
+{}
+
+ShmRing::~ShmRing()
+{
+    munmap(hdr_, mapSize_);
+}
+
+void ShmRing::unlink()
+{
+    string path = SHM_DIR + name_;
+    if (::unlink(path.c_str()) != 0 && errno != ENOENT) {
+        SPCDBG(L_WARN, "Unable to remove " << QT(path) << ": " << ErrnoFormat(errno),
+               CORE_TRANS_TCP);
+    }
+}
+
+size_t ShmRing::writev(const struct iovec* iov, int iovcnt)
+{
+    if (hdr_->closed.load(boost::memory_order_relaxed)) {
+        return 0;
+    }
+    uint64_t tail = hdr_->tail.load(boost::memory_order_relaxed);
+    uint64_t room = hdr_->capacity - (tail - hdr_->head.load(boost::memory_order_acquire));
+
+    size_t written = 0;
+    for (int i = 0; i < iovcnt && room > 0; i++) {
+        const unsigned char* src = static_cast<const unsigned char*>(iov[i].iov_base);
+        size_t len = min<uint64_t>(iov[i].iov_len, room);
+        while (len > 0) {
+            uint64_t offset = tail & mask_;
+            size_t chunk = min<uint64_t>(len, hdr_->capacity - offset);
+            memcpy(data_ + offset, src, chunk);
+            src += chunk;
+            len -= chunk;
+            tail += chunk;
+            room -= chunk;
+            written += chunk;
+        }
+    }
+
+    // Publish the data before checking the reader's parked flag
+    if (written > 0) {
+        hdr_->tail.store(tail, boost::memory_order_seq_cst);
+    }
+    return written;
+}
+
+bool ShmRing::needsWakeup()
+{
+    return hdr_->parked.exchange(0, boost::memory_order_seq_cst) != 0;
+}
+
+uint32_t ShmRing::waitWritable(uint32_t usec)
+{
+    uint32_t waited = 0;
+    while (waited < usec) {
+        uint64_t used = hdr_->tail.load(boost::memory_order_relaxed) -
+                        hdr_->head.load(boost::memory_order_acquire);
+        if (used < hdr_->capacity) {
+            break;
+        }
+        usleep(POLL_USEC);
+        waited += POLL_USEC;
+    }
+    return waited;
+}
+
+size_t ShmRing::read(void* data, size_t size)
+{
+    uint64_t head = hdr_->head.load(boost::memory_order_relaxed);
+    uint64_t avail = hdr_->tail.load(boost::memory_order_acquire) - head;
+
+    unsigned char* dst = static_cast<unsigned char*>(data);
+    size_t len = min<uint64_t>(size, avail);
+    size_t done = 0;
+    while (done < len) {
+        uint64_t offset = head & mask_;
+        size_t chunk = min<uint64_t>(len - done, hdr_->capacity - offset);
+        memcpy(dst + done, data_ + offset, chunk);
+        done += chunk;
+        head += chunk;
+    }
+
+    if (done > 0) {
+        hdr_->head.store(head, boost::memory_order_release);
+    }
+    return done;
+}
+
+bool ShmRing::park()
+{
+    hdr_->parked.store(1, boost::memory_order_seq_cst);
+    if (hdr_->tail.load(boost::memory_order_seq_cst) !=
+        hdr_->head.load(boost::memory_order_relaxed)) {
+        hdr_->parked.store(0, boost::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void ShmRing::close()
+{
+    hdr_->closed.store(1, boost::memory_order_relaxed);
+}
+
+bool ShmRing::empty() const
+{
+    return hdr_->tail.load(boost::memory_order_acquire) ==
+           hdr_->head.load(boost::memory_order_relaxed);
+}
+
+IMPL_EXCEPTION(Distillery, ShmRing, TCPCommon);
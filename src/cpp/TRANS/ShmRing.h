@@ -0,0 +1,136 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRANS_SHM_RING_H_
+#define TRANS_SHM_RING_H_
+
+#include <TRANS/TCPCommon.h>
+#include <UTILS/DistilleryException.h>
+#include <UTILS/UTILSTypes.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <string>
+#include <sys/uio.h>
+
+UTILS_NAMESPACE_BEGIN
+
+/**
+ * @internal
+ *
+ * Single producer, single consumer byte ring in a memory-mapped /dev/shm
+ * segment, used as the data path of a TCP connection between two PEs
+ * running on the same host.  The ring carries the same byte stream as the
+ * socket would (message header followed by the payload), so the receiver
+ * parses it with the regular message framing.
+ *
+ * The TCP socket of the connection stays open: it carries the connection
+ * handshake, detects the loss of the peer, and wakes up a reader parked in
+ * epoll_wait().  The writer sends a one byte wakeup on the socket only
+ * when the reader announced it was about to park.
+ */
+class ShmRing : private boost::noncopyable
+{
+  public:
+    /**
+     * Create and map a new segment with a unique name.
+     * @param capacity ring capacity in bytes, rounded up to a power of 2
+     * @return the new ring; the caller owns it
+     * @throw ShmRingException if the segment cannot be created
+     */
+    static ShmRing* create(uint32_t capacity);
+
+    /**
+     * Map a segment created by another process.
+     * @param name segment name returned by name() in the creating process
+     * @return the ring; the caller owns it
+     * @throw ShmRingException if the segment cannot be mapped
+     */
+    static ShmRing* attach(const std::string& name);
+
+    /// Unmap the segment
+    ~ShmRing();
+
+    /// Return the segment name
+    const std::string& name() const { return name_; }
+
+    /// Remove the segment name; the memory is released when both ends unmap it
+    void unlink();
+
+    /**
+     * Copy as many bytes as fit from the specified buffers into the ring.
+     * @return the number of bytes written, 0 if the ring is full or closed
+     * @note writer only
+     */
+    size_t writev(const struct iovec* iov, int iovcnt);
+
+    /**
+     * Determine if the reader must be woken up after a write, and clear
+     * the reader's parked flag.
+     * @note writer only
+     */
+    bool needsWakeup();
+
+    /**
+     * Wait until there is room in the ring or the timeout expires.
+     * @param usec timeout (microseconds)
+     * @return the time waited (microseconds)
+     * @note writer only
+     */
+    uint32_t waitWritable(uint32_t usec);
+
+    /**
+     * Copy up to @c size bytes from the ring.
+     * @return the number of bytes read, 0 if the ring is empty
+     * @note reader only
+     */
+    size_t read(void* data, size_t size);
+
+    /**
+     * Announce that the reader is about to wait for a wakeup.
+     * @return true if the ring is empty and the reader may wait; false if
+     * data arrived in the meantime and the reader must keep reading
+     * @note reader only
+     */
+    bool park();
+
+    /**
+     * Stop accepting data: subsequent writes fail as if the ring was full,
+     * which makes the writer check the connection socket.
+     * @note reader only
+     */
+    void close();
+
+    /// Determine if the ring holds no data
+    bool empty() const;
+
+  private:
+    struct Header;
+
+    ShmRing(const std::string& name, Header* hdr, size_t mapSize);
+
+    std::string name_;
+    Header* hdr_;
+    unsigned char* data_;
+    size_t mapSize_;
+    uint64_t mask_;
+};
+
+DECL_EXCEPTION(UTILS_NAMESPACE, ShmRing, TCPCommon);
+
+UTILS_NAMESPACE_END
+
+#endif // !TRANS_SHM_RING_H_
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <TRANS/TCPAsyncWriter.h>
+#include <TRANS/TCPConnection.h>
+#include <TRANS/TCPSender.h>
+#include <TRC/DistilleryDebug.h>
+#include <TRC/RuntimeTrcAspects.h>
+
+#include <new>
+#include <string.h>
+
+UTILS_NAMESPACE_USE
+DEBUG_NAMESPACE_USE
+using namespace std;
+
+// Interval between two checks of the connection state by a waiting thread
+static const long WAIT_SLICE_NSEC = 100 * 1000 * 1000;
+
+SharedMessage* SharedMessage::create(const void* data, uint32_t size)
+{
+    void* mem = ::operator new(sizeof(SharedMessage) + size);
+    SharedMessage* msg = new (mem) SharedMessage(size);
+    memcpy(msg + 1, data, size);
+    return msg;
+}
+
+void Distillery::intrusive_ptr_add_ref(SharedMessage* msg)
+{
+    msg->refs_.fetch_add(1, boost::memory_order_relaxed);
+}
+
+void Distillery::intrusive_ptr_release(SharedMessage* msg)
+{
+    if (msg->refs_.fetch_sub(1, boost::memory_order_release) == 1) {
+        boost::atomic_thread_fence(boost::memory_order_acquire);
+        msg->~SharedMessage();
+        ::operator delete(msg);
+    }
+}
+
+TCPAsyncWriter::TCPAsyncWriter(TCPConnection& conn, uint32_t capacity)
+  : conn_(conn)
+  , capacity_(capacity)
+  , depth_(0)
+  , dropped_(0)
+  , stopped_(false)
+{
+    create();
+}
+
+TCPAsyncWriter::~TCPAsyncWriter()
+{
+    {
+        AutoMutex am(mutex_);
+        stopped_ = true;
+        notEmpty_.broadcast();
+        notFull_.broadcast();
+    }
+    join();
+    if (!queue_.empty()) {
+        SPCDBG(L_DEBUG,
+               "Discarding " << queue_.size() << " queued messages for "
+                             << QT(conn_.destinationPortLabel()),
+               CORE_TRANS_TCP);
+    }
+}
+
+void TCPAsyncWriter::enqueue(const SharedMessageRef& msg,
+                             bool alwaysRetryAfterReconnect,
+                             bool resetReconnectionState)
+{
+    Item item;
+    item.msg = msg;
+    item.alwaysRetryAfterReconnect = alwaysRetryAfterReconnect;
+    item.resetReconnectionState = resetReconnectionState;
+    push(item);
+}
+
+void TCPAsyncWriter::enqueueFlush()
+{
+    Item item;
+    item.alwaysRetryAfterReconnect = false;
+    item.resetReconnectionState = false;
+    push(item);
+}
+
+void TCPAsyncWriter::push(const Item& item)
+{
+    timespec delay = { 0, WAIT_SLICE_NSEC };
+    AutoMutex am(mutex_);
+    while (!stopped_ && !conn_.isClosed() && queue_.size() >= capacity_) {
+        notFull_.waitFor(mutex_, delay);
+    }
+    if (stopped_ || conn_.isClosed()) {
+        THROW(ConnectionRemoved, "Abandoning a write because the connection is closed.");
+    }
+    if (!error_.empty()) {
+        // Report the failure to the sender, as a synchronous write would have
+        std::string error;
+        error.swap(error_);
+        THROW(WriteFailed, "Asynchronous write to " << QT(conn_.destinationPortLabel())
+                                                    << " failed: " << error);
+    }
+    queue_.push_back(item);
+    depth_.fetch_add(1, boost::memory_order_relaxed);
+    notEmpty_.signal();
+}
+
+bool TCPAsyncWriter::drain(uint32_t millis)
+{
+    timespec delay = { 0, WAIT_SLICE_NSEC };
+    streams_time_t deadline = TCPCommon::sysTimeMillis() + millis;
+    AutoMutex am(mutex_);
+    while (depth_.load(boost::memory_order_relaxed) > 0) {
+        if (stopped_ || conn_.isClosed() || TCPCommon::sysTimeMillis() >= deadline) {
+            return false;
+        }
+        notFull_.waitFor(mutex_, delay);
+    }
+    return true;
+}
+
+void* TCPAsyncWriter::run(void* threadArgs)
+{
+    SPCDBG(L_DEBUG, "Asynchronous writer for " << QT(conn_.destinationPortLabel()) << " started",
+           CORE_TRANS_TCP);
+    Item item;
+    bool written = false;
+    while (true) {
+        {
+            AutoMutex am(mutex_);
+            if (written) {
+                item.msg.reset();
+                depth_.fetch_sub(1, boost::memory_order_relaxed);
+            }
+            while (queue_.empty() && !stopped_) {
+                notEmpty_.wait(mutex_);
+            }
+            if (stopped_) {
+                break;
+            }
+            item = queue_.front();
+            queue_.pop_front();
+            // Wake up the senders waiting for room and the threads draining the queue
+            notFull_.broadcast();
+        }
+        write(item);
+        written = true;
+    }
+    SPCDBG(L_DEBUG, "Asynchronous writer for " << QT(conn_.destinationPortLabel()) << " stopped",
+           CORE_TRANS_TCP);
+    return NULL;
+}
+
+void TCPAsyncWriter::write(const Item& item)
+{
+    try {
+        if (!item.msg) {
+            conn_.flush(TCPConnection::FLUSH_ON_PUNCT);
+            return;
+        }
+        const SharedMessage& msg = *item.msg;
+        if (write_batch::accepts(msg.size(), item.alwaysRetryAfterReconnect,
+                                 item.resetReconnectionState)) {
+            conn_.append(msg.header(), msg.data(), msg.size(), item.alwaysRetryAfterReconnect,
+                         item.resetReconnectionState);
+        } else {
+            conn_.write(msg.header(), msg.data(), msg.size(), item.alwaysRetryAfterReconnect,
+                        item.resetReconnectionState);
+        }
+    } catch (const ConnectionRemovedException& ex) {
+        // The sender deletes the connection on its next write; drop what is queued
+        AutoMutex am(mutex_);
+        uint64_t dropped = queue_.size() + (item.msg ? 1 : 0);
+        dropped_.fetch_add(dropped, boost::memory_order_relaxed);
+        depth_.fetch_sub(queue_.size(), boost::memory_order_relaxed);
+        queue_.clear();
+        notFull_.broadcast();
+    } catch (const OptionalConnectIncompleteException& ex) {
+        // As with a synchronous write, the message is not sent to an
+        // optional connection which is not connected yet
+        SPCDBG(L_TRACE, ex.getExplanation() << ". Dropping message", CORE_TRANS_TCP);
+        if (item.msg) {
+            dropped_.fetch_add(1, boost::memory_order_relaxed);
+        }
+    } catch (const DistilleryException& ex) {
+        fail(item, ex.getExplanation());
+    } catch (const std::exception& ex) {
+        fail(item, ex.what());
+    }
+}
+
+void TCPAsyncWriter::fail(const Item& item, const std::string& explanation)
+{
+    SPCDBG(L_ERROR,
+           "Asynchronous write to " << QT(conn_.destinationPortLabel())
+                                    << " failed: " << explanation,
+           CORE_TRANS_TCP);
+    if (item.msg) {
+        dropped_.fetch_add(1, boost::memory_order_relaxed);
+    }
+    AutoMutex am(mutex_);
+    error_ = explanation.empty() ? "unknown error" : explanation;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRANS_TCP_ASYNC_WRITER_H_
+#define TRANS_TCP_ASYNC_WRITER_H_
+
+#include <TRANS/TCPCommon.h>
+#include <UTILS/CV.h>
+#include <UTILS/Mutex.h>
+#include <UTILS/Thread.h>
+#include <UTILS/UTILSTypes.h>
+
+#include <boost/atomic.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <deque>
+#include <string>
+
+UTILS_NAMESPACE_BEGIN
+
+class TCPConnection;
+
+/**
+ * @internal
+ *
+ * Message copied once by a sender and shared by the asynchronous writers of
+ * all the connections it is sent to.  The payload follows the object in the
+ * same allocation; the object is freed when the last reference goes away.
+ */
+class SharedMessage : private boost::noncopyable
+{
+  public:
+    /**
+     * Copy the specified payload into a new message.
+     * @param data  payload
+     * @param size  payload size
+     * @return the new message, with no reference
+     */
+    static SharedMessage* create(const void* data, uint32_t size);
+
+    /// Return the message header
+    const socket_header_t& header() const { return hdr_; }
+
+    /// Return the payload
+    const void* data() const { return this + 1; }
+
+    /// Return the payload size
+    uint32_t size() const { return size_; }
+
+  private:
+    explicit SharedMessage(uint32_t size)
+      : refs_(0)
+      , hdr_(size)
+      , size_(size)
+    {}
+
+    friend void intrusive_ptr_add_ref(SharedMessage* msg);
+    friend void intrusive_ptr_release(SharedMessage* msg);
+
+    boost::atomic<uint32_t> refs_;
+    socket_header_t hdr_;
+    uint32_t size_;
+};
+
+void intrusive_ptr_add_ref(SharedMessage* msg);
+void intrusive_ptr_release(SharedMessage* msg);
+
+typedef boost::intrusive_ptr<SharedMessage> SharedMessageRef;
+
+/**
+ * @internal
+ *
+ * Bounded queue of messages and the thread which writes them to one
+ * connection.  A sender queues a message to the writer of each of its
+ * connections and returns; the submitting thread waits only when the queue
+ * of a connection is full.
+ *
+ * The writer calls the connection's regular write methods, so reconnection,
+ * congestion blocking and batching behave as with synchronous writes.  A
+ * failed write is reported to the sender on its next enqueue or flush, as
+ * a synchronous write would have reported it; the messages that could not
+ * be written are counted as dropped.
+ */
+class TCPAsyncWriter
+  : public Thread
+  , private boost::noncopyable
+{
+  public:
+    /**
+     * Constructor; starts the writer thread.
+     * @param conn  connection to write to
+     * @param capacity  maximum number of queued messages
+     */
+    TCPAsyncWriter(TCPConnection& conn, uint32_t capacity);
+
+    /// Destructor; stops the writer thread and discards the queued messages
+    ~TCPAsyncWriter();
+
+    /**
+     * Queue a message, waiting while the queue is full.
+     * @throw ConnectionRemovedException if the connection has been closed
+     * @throw WriteFailedException if the writer failed to write an earlier
+     * message or flush since the last call; the message is not queued
+     */
+    void enqueue(const SharedMessageRef& msg,
+                 bool alwaysRetryAfterReconnect,
+                 bool resetReconnectionState);
+
+    /**
+     * Queue a flush of the connection send buffer behind the queued messages.
+     * @throw ConnectionRemovedException if the connection has been closed
+     * @throw WriteFailedException if the writer failed to write an earlier
+     * message or flush since the last call
+     */
+    void enqueueFlush();
+
+    /**
+     * Wait until the writer has written all queued messages, or the
+     * timeout expires.
+     * @param millis  timeout (milliseconds)
+     * @return true if the queue was drained
+     */
+    bool drain(uint32_t millis);
+
+    /// Return the number of queued messages
+    uint32_t getQueueDepth() const { return depth_.load(boost::memory_order_relaxed); }
+
+    /// Return the maximum number of queued messages
+    uint32_t getCapacity() const { return capacity_; }
+
+    /// Return the number of messages the writer could not write
+    uint64_t getDroppedCount() const { return dropped_.load(boost::memory_order_relaxed); }
+
+    /** @Override Thread::run */
+    void* run(void* threadArgs);
+
+  private:
+    struct Item
+    {
+        SharedMessageRef msg; ///< NULL for a flush request
+        bool alwaysRetryAfterReconnect;
+        bool resetReconnectionState;
+    };
+
+    void push(const Item& item);
+    void write(const Item& item);
+    void fail(const Item& item, const std::string& explanation);
+
+    TCPConnection& conn_;
+    const uint32_t capacity_;
+    std::deque<Item> queue_;
+    boost::atomic<uint32_t> depth_; ///< queued messages, including the one being written
+    boost::atomic<uint64_t> dropped_;
+    bool stopped_;
+    std::string error_; ///< explanation of the last failed write, not reported yet
+    Mutex mutex_;
+    CV notEmpty_;
+    CV notFull_;
+};
+
+UTILS_NAMESPACE_END
+
+#endif // !TRANS_TCP_ASYNC_WRITER_H_
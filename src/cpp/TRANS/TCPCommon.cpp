@@ -30,6 +30,7 @@ DEBUG_NAMESPACE_USE
 
 // Initialize MAGIC message header values
 const uint32_t socket_header_t::hostByteOrderedMagic_ = 0xDEADDEAD;
+const uint32_t socket_header_t::COMPRESSED_FLAG;
 
 // Write a message with a tcp transport header to a socket
 void TCPCommon::writeSocketWithHeader(InetSocket* socket, const void* data, const uint32_t size)
@@ -45,7 +45,14 @@ class socket_header_t
     bool isValid() const { return ntohl(magic_) == hostByteOrderedMagic_; }
 
     /// Return the message size
-    uint32_t messageSize() const { return ntohl(size_); }
+    uint32_t messageSize() const { return ntohl(size_) & ~COMPRESSED_FLAG; }
+
+    /// Determine if the message is a compressed frame
+    /// @see TCPDeflater
+    bool isCompressed() const { return (ntohl(size_) & COMPRESSED_FLAG) != 0; }
+
+    /// Size flag marking a compressed frame
+    static const uint32_t COMPRESSED_FLAG = 0x80000000;
 
     /// Return a string representation of the object.
     /// @return string representation
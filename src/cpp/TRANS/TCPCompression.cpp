@@ -0,0 +1,126 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <TRANS/TCPCompression.h>
+#include <TRC/DistilleryDebug.h>
+#include <TRC/RuntimeTrcAspects.h>
+
+#include <netinet/in.h>
+#include <string.h>
+
+UTILS_NAMESPACE_USE
+DEBUG_NAMESPACE_USE
+using namespace std;
+
+// Size of the frame header and the uncompressed block size
+static const uint32_t FRAME_PREFIX_SIZE = sizeof(socket_header_t) + sizeof(uint32_t);
+
+TCPDeflater::TCPDeflater(int level)
+  : frameSize_(0)
+{
+    memset(&stream_, 0, sizeof(stream_));
+    // Raw deflate stream: the frame carries the block size, no need for a checksum
+    int rc = deflateInit2(&stream_, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (rc != Z_OK) {
+        THROW(TCPCommon, "Unable to initialize the compression stream: " << zError(rc));
+    }
+}
+
+TCPDeflater::~TCPDeflater()
+{
+    deflateEnd(&stream_);
+}
+
+bool TCPDeflater::compress(const struct iovec* iov, int iovcnt, uint32_t size)
+{
+    if (size <= FRAME_PREFIX_SIZE) {
+        return false;
+    }
+    if (frame_.size() < size) {
+        frame_.resize(size);
+    }
+
+    // Give up as soon as the frame would not be smaller than the block
+    deflateReset(&stream_);
+    stream_.next_out = &frame_[FRAME_PREFIX_SIZE];
+    stream_.avail_out = size - FRAME_PREFIX_SIZE;
+    for (int i = 0; i < iovcnt; i++) {
+        bool last = i == iovcnt - 1;
+        if (iov[i].iov_len == 0 && !last) {
+            continue;
+        }
+        stream_.next_in = static_cast<Bytef*>(iov[i].iov_base);
+        stream_.avail_in = iov[i].iov_len;
+        int rc = deflate(&stream_, last ? Z_FINISH : Z_NO_FLUSH);
+        if (last ? rc != Z_STREAM_END : (rc != Z_OK || stream_.avail_in > 0)) {
+            return false;
+        }
+    }
+
+    frameSize_ = FRAME_PREFIX_SIZE + stream_.total_out;
+    socket_header_ta::serialize(&frame_[0], (frameSize_ - sizeof(socket_header_t)) |
+                                              socket_header_t::COMPRESSED_FLAG);
+    uint32_t blockSize = htonl(size);
+    memcpy(&frame_[sizeof(socket_header_t)], &blockSize, sizeof(blockSize));
+    return true;
+}
+
+TCPInflater::TCPInflater()
+{
+    memset(&stream_, 0, sizeof(stream_));
+    int rc = inflateInit2(&stream_, -MAX_WBITS);
+    if (rc != Z_OK) {
+        THROW(TCPCommon, "Unable to initialize the decompression stream: " << zError(rc));
+    }
+}
+
+TCPInflater::~TCPInflater()
+{
+    inflateEnd(&stream_);
+}
+
+unsigned char* TCPInflater::decompress(const unsigned char* data,
+                                       uint32_t size,
+                                       uint32_t& blockSize)
+{
+    uint32_t netSize;
+    if (size < sizeof(netSize)) {
+        return NULL;
+    }
+    memcpy(&netSize, data, sizeof(netSize));
+    blockSize = ntohl(netSize);
+    if (blockSize == 0 || blockSize > MAX_BLOCK_SIZE) {
+        return NULL;
+    }
+    if (block_.size() < blockSize) {
+        block_.resize(blockSize);
+    }
+
+    inflateReset(&stream_);
+    stream_.next_in = const_cast<Bytef*>(data + sizeof(netSize));
+    stream_.avail_in = size - sizeof(netSize);
+    stream_.next_out = &block_[0];
+    stream_.avail_out = blockSize;
+    int rc = inflate(&stream_, Z_FINISH);
+    if (rc != Z_STREAM_END || stream_.total_out != blockSize) {
+        SPCDBG(L_DEBUG,
+               "Decompression failed: rc=" << rc << ", " << stream_.total_out << " out of "
+                                           << blockSize << " bytes",
+               CORE_TRANS_TCP);
+        return NULL;
+    }
+    return &block_[0];
+}
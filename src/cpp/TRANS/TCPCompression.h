@@ -0,0 +1,113 @@
+/*
+ * Copyright 2021 IBM Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRANS_TCP_COMPRESSION_H_
+#define TRANS_TCP_COMPRESSION_H_
+
+#include <TRANS/TCPCommon.h>
+#include <UTILS/UTILSTypes.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <sys/uio.h>
+#include <vector>
+#include <zlib.h>
+
+UTILS_NAMESPACE_BEGIN
+
+/**
+ * @internal
+ *
+ * Compresses blocks of messages for a connection which negotiated
+ * compression with its receiver.
+ *
+ * A compressed frame is a message header flagged as compressed, followed by
+ * the uncompressed size of the block (4 bytes, network byte order) and the
+ * deflate stream of the block.  The block holds one or more complete
+ * messages, each with its own header, so the receiver delivers the content
+ * of a frame with the regular message framing.  Blocks are compressed
+ * independently of each other.
+ */
+class TCPDeflater : private boost::noncopyable
+{
+  public:
+    /**
+     * Constructor.
+     * @param level  zlib compression level, 1 (fastest) to 9 (smallest)
+     */
+    explicit TCPDeflater(int level);
+
+    /// Destructor
+    ~TCPDeflater();
+
+    /**
+     * Compress a block of messages into a frame.
+     * @param iov  block of messages
+     * @param iovcnt  number of elements in @c iov
+     * @param size  total size of the block
+     * @return true if the frame is smaller than the block; the frame is
+     * then available through frame() and frameSize() until the next call
+     */
+    bool compress(const struct iovec* iov, int iovcnt, uint32_t size);
+
+    /// Return the last compressed frame, header included
+    const unsigned char* frame() const { return &frame_[0]; }
+
+    /// Return the size of the last compressed frame, header included
+    uint32_t frameSize() const { return frameSize_; }
+
+  private:
+    z_stream stream_;
+    std::vector<unsigned char> frame_;
+    uint32_t frameSize_;
+};
+
+/**
+ * @internal
+ *
+ * Decompresses the frames received on a connection which negotiated
+ * compression with its sender.
+ */
+class TCPInflater : private boost::noncopyable
+{
+  public:
+    /// Constructor
+    TCPInflater();
+
+    /// Destructor
+    ~TCPInflater();
+
+    /**
+     * Decompress the payload of a compressed frame.
+     * @param data  frame payload (uncompressed size followed by the deflate stream)
+     * @param size  size of the frame payload
+     * @param[out] blockSize  size of the decompressed block
+     * @return the block of messages, valid until the next call; NULL if the
+     * payload is corrupted
+     */
+    unsigned char* decompress(const unsigned char* data, uint32_t size, uint32_t& blockSize);
+
+    /// Largest block a frame may announce
+    static const uint32_t MAX_BLOCK_SIZE = 256 * 1024 * 1024;
+
+  private:
+    z_stream stream_;
+    std::vector<unsigned char> block_;
+};
+
+UTILS_NAMESPACE_END
+
+#endif // !TRANS_TCP_COMPRESSION_H_
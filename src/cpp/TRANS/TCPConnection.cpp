@@ -19,12 +19,19 @@
 #include <TRANS/TCPConnection.h>
 #include <TRANS/TCPInstance.h>
 #include <TRANS/TCPSender.h>
+#include <TRANS/TransportUtils.h>
 #include <TRC/RuntimeTrcAspects.h>
 #include <UTILS/Formatter.h>
 #include <UTILS/HostInfo.h>
 #include <UTILS/RuntimeMessages.h>
 #include <UTILS/SBuffer.h>
 #include <UTILS/SupportFunctions.h>
+#include <UTILS/auto_array.h>
+
+#include <algorithm>
+#include <cassert>
+#include <sys/socket.h>
+#include <time.h>
 
 UTILS_NAMESPACE_USE;
 NAM_NAMESPACE_USE;
@@ -39,8 +46,27 @@ const int TCPConnection::WINDOW_LENGTH_SEC;
 const long TCPConnection::BLOCK_TIMEOUT_USEC;
 static const double MICROSEC_PER_SEC = 1e6;
 
+// Rings are proposed again after a refusal once this delay has passed; the
+// delay doubles with each consecutive refusal, up to 2^8 times
+static const streams_time_interval_t RING_RETRY_MICROS = 1000000;
+static const uint32_t RING_RETRY_MAX_SHIFT = 8;
+
 bool TCPConnection::blockingWrites = TransportUtils::configureBlockingWrites();
 bool TCPConnection::lockQueueOnWrite = TransportUtils::configureHeartbeatOn();
+uint32_t TCPConnection::batchSize = TransportUtils::configureBatchSize();
+streams_time_interval_t TCPConnection::batchLatency = TransportUtils::configureBatchLatency();
+uint32_t TCPConnection::shmRingSize = TransportUtils::configureShmRingSize();
+uint32_t TCPConnection::asyncQueueSize = TransportUtils::configureAsyncQueueSize();
+uint32_t TCPConnection::compressionLevel = TransportUtils::configureCompressionLevel();
+uint32_t TCPConnection::compressionThreshold = TransportUtils::configureCompressionThreshold();
+
+// Return the CPU time used by the calling thread (microseconds)
+static inline streams_time_t threadCpuTimeMicros()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
 
 /////////////////////////////////////////////////////////////////////////////
 // Private inlines
@@ -196,6 +222,10 @@ TCPConnection::TCPConnection(const DataSender::PortDescription& pd,
   , blockOnCongestion_(pd.blockOnCongestion)
   , callback_(pd.callback)
   , helper_(helper)
+  , ringRefusals_(0)
+  , ringRetryTime_(0)
+  , compressing_(false)
+  , compressionRefused_(false)
   , state_(ConnectionState::INITIAL)
   , closed_(false)
   , hasConnected_(false)
@@ -207,15 +237,30 @@ TCPConnection::TCPConnection(const DataSender::PortDescription& pd,
   , hasReconnected_(false)
   , autoRetryAfterFailure_(true)
   , lastWrite_(0)
+  , batchBytes_(0)
+  , batchMessages_(0)
+  , batchStarted_(0)
+  , nBatchesFlushed_(0)
+  , nMessagesBatched_(0)
+  , nFlushesOnSize_(0)
+  , nFlushesOnDeadline_(0)
+  , nFlushesOnPunct_(0)
+  , nBytesBeforeCompression_(0)
+  , nBytesAfterCompression_(0)
+  , compressionTime_(0)
   , currWindow_(0)
   , flipped_(0)
   , savedCongestion_(0)
+  , pins_(1)
 {
     SPCDBG(L_INFO, "Enter " << pd << " required=" << required, CORE_TRANS_TCP);
     if (ns_label_.isErrorPEId()) {
         SPCDBG(L_ERROR, "Cannot parse a PE and Port Id from port label " << QT(label()),
                CORE_TRANS_TCP);
     }
+    if (asyncQueueSize > 0) {
+        asyncWriter_.reset(new TCPAsyncWriter(*this, asyncQueueSize));
+    }
 }
 
 TCPConnection::TCPConnection(const string& server,
@@ -233,6 +278,10 @@ TCPConnection::TCPConnection(const string& server,
   , blockOnCongestion_(true)
   , callback_(cb)
   , helper_(helper)
+  , ringRefusals_(0)
+  , ringRetryTime_(0)
+  , compressing_(false)
+  , compressionRefused_(false)
   , state_(ConnectionState::INITIAL)
   , closed_(false)
   , hasConnected_(false)
@@ -244,15 +293,37 @@ TCPConnection::TCPConnection(const string& server,
   , hasReconnected_(false)
   , autoRetryAfterFailure_(true)
   , lastWrite_(0)
+  , batchBytes_(0)
+  , batchMessages_(0)
+  , batchStarted_(0)
+  , nBatchesFlushed_(0)
+  , nMessagesBatched_(0)
+  , nFlushesOnSize_(0)
+  , nFlushesOnDeadline_(0)
+  , nFlushesOnPunct_(0)
+  , nBytesBeforeCompression_(0)
+  , nBytesAfterCompression_(0)
+  , compressionTime_(0)
   , currWindow_(0)
   , flipped_(0)
   , savedCongestion_(0)
+  , pins_(1)
 {
     SPCDBG(L_INFO,
            "Enter "
              << "server address=" << server << " port=" << port << " required=" << required
              << " blockOnCongestion=" << blockOnCongestion_,
            CORE_TRANS_TCP);
+    if (asyncQueueSize > 0) {
+        asyncWriter_.reset(new TCPAsyncWriter(*this, asyncQueueSize));
+    }
+}
+
+TCPConnection::~TCPConnection()
+{
+    // A writer blocked on a congested socket gives up once the connection is closed
+    closed_.store(true);
+    asyncWriter_.reset();
 }
 
 TCPConnection* TCPConnection::newInstance(const DataSender::Id& senderId,
@@ -369,6 +440,8 @@ void TCPConnection::connectToServerUnlocked()
      * Grab a new socket.
      */
     if (!connInProgress_ && !closed_) {
+        ring_.reset();
+        compressing_ = false;
         socket_.reset(TCPInstance::instance()->newSocket(false));
         setState(ConnectionState::CONNECTING);
         notifyOnConnecting();
@@ -684,9 +757,22 @@ void TCPConnection::doConnectionHandshake()
             return;
         }
 
+        // Same host receivers are offered a shared memory ring, the others
+        // compression
+        if (proposeShmRing()) {
+            createShmRing();
+        }
+        bool compression = !ring_ && proposeCompression();
+        if (ring_ || compression) {
+            doNegotiatedHandshake(compression);
+            return;
+        }
+
         // Write the handshake buffer to the port
         TCPCommon::writeSocketWithHeader(socket_.get(), handshakeBuffer_->getUCharPtr(),
                                          handshakeBuffer_->getSerializedDataSize());
+    } catch (HandshakeErrorException& ex) {
+        throw;
     } catch (DistilleryException& ex) {
         // A failure while trying to do the handshake
         // NOTE: SystemTest Runtime testcases rely on message pattern "Connection Handshake Error"
@@ -697,6 +783,195 @@ void TCPConnection::doConnectionHandshake()
     }
 }
 
+// Note: caller must hold mutex_.
+bool TCPConnection::isLocalReceiver()
+{
+    try {
+        return HostInfo(addr_).isThisHost();
+    } catch (HostInfoException& ex) {
+        SPCDBG(L_DEBUG, "Unable to resolve " << QT(addr_) << ": " << ex.getExplanation(),
+               CORE_TRANS_TCP);
+    }
+    return false;
+}
+
+// Note: caller must hold mutex_.
+bool TCPConnection::proposeShmRing()
+{
+    if (shmRingSize == 0 || TCPInstance::instance()->isSecure()) {
+        return false;
+    }
+    if (ringRefusals_ > 0 && getTimeInMicrosecs() < ringRetryTime_) {
+        return false;
+    }
+    return isLocalReceiver();
+}
+
+// Note: caller must hold mutex_.
+void TCPConnection::refuseShmRing()
+{
+    uint32_t shift = std::min(ringRefusals_, RING_RETRY_MAX_SHIFT);
+    ringRefusals_++;
+    ringRetryTime_ = getTimeInMicrosecs() + (RING_RETRY_MICROS << shift);
+}
+
+// Note: caller must hold mutex_.
+void TCPConnection::createShmRing()
+{
+    try {
+        ring_.reset(ShmRing::create(shmRingSize));
+    } catch (ShmRingException& ex) {
+        SPCDBG(L_WARN,
+               "Using the socket for " << QT(label()) << ", ring not available: "
+                                       << ex.getExplanation(),
+               CORE_TRANS_TCP);
+        refuseShmRing();
+    }
+}
+
+// Note: caller must hold mutex_.
+bool TCPConnection::proposeCompression()
+{
+    if (compressionLevel == 0 || compressionRefused_) {
+        return false;
+    }
+    return !isLocalReceiver();
+}
+
+// Note: caller must hold mutex_.
+void TCPConnection::doNegotiatedHandshake(bool compression)
+{
+    ConnectionHandshakeReply::connHandshakeCode code = ConnectionHandshakeReply::RING_REFUSED;
+    bool accepted = false;
+    try {
+        // Same handshake, followed by the proposals
+        SBuffer sbuf(handshakeBuffer_->getUCharPtr(), handshakeBuffer_->getSerializedDataSize());
+        ConnectionHandshake connHandshake(sbuf, label());
+        if (ring_) {
+            connHandshake.setShmRing(ring_->name());
+        }
+        connHandshake.setCompression(compression);
+        SBuffer proposal;
+        connHandshake.serialize(proposal);
+        TCPCommon::writeSocketWithHeader(socket_.get(), proposal.getUCharPtr(),
+                                         proposal.getSerializedDataSize());
+
+        // Receivers which know about the proposals always reply
+        TCPCommon::waitOnSocket(socket_.get(), 0, ConnectionHandshake::getTimeoutUsec(false));
+        size_t size;
+        auto_array<unsigned char> data(
+          (unsigned char*)TCPCommon::readSocketWithHeader(socket_.get(), &size));
+        SBuffer rbuf(data.get(), size);
+        ConnectionHandshakeReply reply(rbuf);
+        code = reply.getReplyCode();
+        accepted = reply.getCompression();
+    } catch (DistilleryException& ex) {
+        // The receiver may predate the proposals and ignore them: retry
+        // the connection without them
+        if (ring_) {
+            ring_->unlink();
+            ring_.reset();
+            refuseShmRing();
+        }
+        if (compression) {
+            compressionRefused_ = true;
+        }
+        THROW_NESTED(HandshakeError,
+                     "Connection handshake negotiation error for connection to "
+                       << QT(label()) << "(" << ex.getExplanation() << ")",
+                     ex);
+    }
+
+    if (ring_) {
+        ring_->unlink();
+        if (code != ConnectionHandshakeReply::CONNECTED) {
+            SPCDBG(L_INFO, "Receiver " << QT(label()) << " refused the ring, using the socket",
+                   CORE_TRANS_TCP);
+            ring_.reset();
+            refuseShmRing();
+        } else {
+            ringRefusals_ = 0;
+            SPCDBG(L_INFO, "Connection to " << QT(label()) << " uses ring " << QT(ring_->name()),
+                   CORE_TRANS_TCP);
+        }
+    }
+
+    if (compression) {
+        if (!accepted) {
+            SPCDBG(L_INFO, "Receiver " << QT(label()) << " refused compression", CORE_TRANS_TCP);
+            compressionRefused_ = true;
+            return;
+        }
+        if (!deflater_) {
+            deflater_.reset(new TCPDeflater(compressionLevel));
+        }
+        compressing_ = true;
+        SPCDBG(L_INFO,
+               "Connection to " << QT(label()) << " compresses data at level " << compressionLevel,
+               CORE_TRANS_TCP);
+    }
+}
+
+// Note: caller must hold mutex_.
+bool TCPConnection::compressUnlocked(const struct iovec* iov, int iovcnt, uint32_t size)
+{
+    if (!compressing_ || size < compressionThreshold) {
+        return false;
+    }
+
+    streams_time_t started = threadCpuTimeMicros();
+    bool compressed = deflater_->compress(iov, iovcnt, size);
+    compressionTime_.fetch_add(threadCpuTimeMicros() - started, boost::memory_order_relaxed);
+
+    // Blocks which do not shrink are sent as is and count as not compressed
+    nBytesBeforeCompression_.fetch_add(size, boost::memory_order_relaxed);
+    nBytesAfterCompression_.fetch_add(compressed ? deflater_->frameSize() : size,
+                                      boost::memory_order_relaxed);
+    return compressed;
+}
+
+// Note: caller must hold mutex_.
+inline ssize_t TCPConnection::send(const void* data, size_t count)
+{
+    if (!ring_) {
+        // Write to socket; use MSG_NOSIGNAL ==> no SIGPIPE
+        return socket_->send(data, count, MSG_NOSIGNAL);
+    }
+    struct iovec iov;
+    iov.iov_base = const_cast<void*>(data);
+    iov.iov_len = count;
+    return sendv(&iov, 1);
+}
+
+// Note: caller must hold mutex_.
+ssize_t TCPConnection::sendv(const struct iovec* iov, int iovcnt)
+{
+    if (!ring_) {
+        return socket_->writev(iov, iovcnt);
+    }
+
+    size_t rc = ring_->writev(iov, iovcnt);
+    if (rc == 0) {
+        // The ring is full: a receiver which has gone away closed the socket
+        char c;
+        if (::recv(**socket_, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 0) {
+            errno = EPIPE;
+            return -1;
+        }
+        errno = EWOULDBLOCK;
+        return -1;
+    }
+
+    // Wake up the receiver if it waits on the socket
+    if (ring_->needsWakeup()) {
+        char c = 0;
+        if (socket_->send(&c, 1, MSG_NOSIGNAL) == -1 && errno != EWOULDBLOCK) {
+            return -1;
+        }
+    }
+    return rc;
+}
+
 void TCPConnection::close()
 {
     // Set flag outside of critical section
@@ -709,6 +984,7 @@ void TCPConnection::close()
     if (socket_.get() != NULL) {
         socket_->close();
     }
+    ring_.reset();
     setState(ConnectionState::CLOSED);
     notifyOnConnected(false); // no longer connecting; balance callbacks if necessary
     notifyOnClose();
@@ -738,15 +1014,31 @@ void TCPConnection::doHeartbeat(streams_time_t beforeTime, streams_time_t curTim
     }
 }
 
+void TCPConnection::enqueue(const SharedMessageRef& msg,
+                            bool alwaysRetryAfterReconnect,
+                            bool resetReconnectionState)
+{
+    assert(asyncWriter_);
+    asyncWriter_->enqueue(msg, alwaysRetryAfterReconnect, resetReconnectionState);
+}
+
+void TCPConnection::enqueueFlush()
+{
+    assert(asyncWriter_);
+    asyncWriter_->enqueueFlush();
+}
+
+bool TCPConnection::drainAsync(uint32_t millis)
+{
+    return !asyncWriter_ || asyncWriter_->drain(millis);
+}
+
 // TODO join the two TCPConnection::write() using the template method pattern
 void TCPConnection::write(const void* data,
                           const uint32_t count,
                           bool alwaysRetryAfterReconnect,
                           bool resetReconnectionState)
 {
-    uint32_t remaining = count;
-    const unsigned char* small_buffer_ptr = reinterpret_cast<const unsigned char*>(data);
-
     AutoMutex am(mutex_);
 
     // Connect if not connected and continue with write only if connection is on
@@ -754,9 +1046,14 @@ void TCPConnection::write(const void* data,
         return;
     }
 
+    // Messages which bypass the send buffer must not overtake the buffered ones
+    if (batchBytes_ > 0) {
+        flushUnlocked(FLUSH_ON_UNBATCHED);
+    }
+
 #ifndef NDEBUG
     SPCDBG(L_TRACE,
-           "Writing " << remaining << " bytes to " << *this << ", host:port=" << addr_ << ":"
+           "Writing " << count << " bytes to " << *this << ", host:port=" << addr_ << ":"
                       << port_,
            CORE_TRANS_TCP);
 #endif
@@ -766,13 +1063,25 @@ void TCPConnection::write(const void* data,
         return;
     }
 
+    writeUnlocked(data, count, alwaysRetryAfterReconnect, resetReconnectionState);
+}
+
+// Note: caller must hold mutex_.
+void TCPConnection::writeUnlocked(const void* data,
+                                  const uint32_t count,
+                                  bool alwaysRetryAfterReconnect,
+                                  bool resetReconnectionState)
+{
+    uint32_t remaining = count;
+    const unsigned char* small_buffer_ptr = reinterpret_cast<const unsigned char*>(data);
+
     // Do the write
     while (remaining > 0) {
         // Check if we need to flip the congestion measurement windows
         checkWindowFlip();
 
-        // Write to socket; use MSG_NOSIGNAL ==> no SIGPIPE
-        ssize_t rc = socket_->send((void*)small_buffer_ptr, remaining, MSG_NOSIGNAL);
+        // Write to the ring or the socket
+        ssize_t rc = send(small_buffer_ptr, remaining);
 
         // If success, update write timestamp, then exit loop(s)
         if (static_cast<uint32_t>(rc) == remaining) {
@@ -846,6 +1155,11 @@ void TCPConnection::write(const socket_header_t& hdr,
         return;
     }
 
+    // Messages which bypass the send buffer must not overtake the buffered ones
+    if (batchBytes_ > 0) {
+        flushUnlocked(FLUSH_ON_UNBATCHED);
+    }
+
 #ifndef NDEBUG
     SPCDBG(L_TRACE, "Writing " << remaining << " bytes to " << *this, CORE_TRANS_TCP);
 #endif
@@ -855,12 +1169,19 @@ void TCPConnection::write(const socket_header_t& hdr,
         return;
     }
 
+    // Messages which bypass the send buffer are compressed on their own
+    if (compressUnlocked(iov, 2, remaining)) {
+        writeUnlocked(deflater_->frame(), deflater_->frameSize(), alwaysRetryAfterReconnect,
+                      resetReconnectionState);
+        return;
+    }
+
     while (remaining > 0) {
         // Check if we need to flip the congestion measurement windows
         checkWindowFlip();
 
-        // Write to socket
-        ssize_t rc = socket_->writev(iov, 2);
+        // Write to the ring or the socket
+        ssize_t rc = sendv(iov, 2);
 
         // If success, update write timestamp, then exit loop(s)
         if (static_cast<uint32_t>(rc) == remaining) {
@@ -915,6 +1236,125 @@ void TCPConnection::write(const socket_header_t& hdr,
     }
 }
 
+void TCPConnection::append(const socket_header_t& hdr,
+                           const void* data,
+                           const size_t size,
+                           bool alwaysRetryAfterReconnect,
+                           bool resetReconnectionState)
+{
+    const uint32_t total = sizeof(hdr) + size;
+
+    AutoMutex am(mutex_);
+
+    // Connect if not connected and continue with write only if connection is on
+    if (!checkConnectionBeforeWrite()) {
+        return;
+    }
+
+    if (!doWriteAfterReconnect(alwaysRetryAfterReconnect, resetReconnectionState)) {
+        SPCDBG(L_TRACE, "Discarding data after reconnect", CORE_TRANS_TCP);
+        return;
+    }
+
+    // Make room for the message
+    if (batchBytes_ + total > batchSize) {
+        flushUnlocked(FLUSH_ON_SIZE);
+    }
+    if (!batch_) {
+        batch_.reset(new unsigned char[batchSize]);
+    }
+
+    streams_time_t now = getTimeInMicrosecs();
+    if (batchBytes_ == 0) {
+        batchStarted_ = now;
+    }
+
+    memcpy(batch_.get() + batchBytes_, &hdr, sizeof(hdr));
+    memcpy(batch_.get() + batchBytes_ + sizeof(hdr), data, size);
+    batchBytes_ += total;
+    batchMessages_ += 1;
+
+    if (batchBytes_ >= batchSize) {
+        flushUnlocked(FLUSH_ON_SIZE);
+    } else if (static_cast<streams_time_interval_t>(now - batchStarted_) >= batchLatency) {
+        flushUnlocked(FLUSH_ON_DEADLINE);
+    }
+}
+
+void TCPConnection::flush(FlushReason reason)
+{
+    AutoMutex am(mutex_);
+    flushUnlocked(reason);
+}
+
+void TCPConnection::flushIfExpired(streams_time_t now)
+{
+    // Don't wait for a busy connection: the writer flushes on its own
+    if (!mutex_.tryLock()) {
+        return;
+    }
+    try {
+        // The connection may have been closed since the monitor thread pinned it
+        if (!closed_ && batchBytes_ > 0 &&
+            static_cast<streams_time_interval_t>(now - batchStarted_) >= batchLatency) {
+            flushUnlocked(FLUSH_ON_DEADLINE);
+        }
+    } catch (...) {
+        mutex_.unlock();
+        throw;
+    }
+    mutex_.unlock();
+}
+
+// Note: caller must hold mutex_.
+void TCPConnection::flushUnlocked(FlushReason reason)
+{
+    if (batchBytes_ == 0) {
+        return;
+    }
+
+#ifndef NDEBUG
+    SPCDBG(L_TRACE,
+           "Flushing " << batchMessages_ << " messages (" << batchBytes_ << " bytes) to " << *this
+                       << ", reason=" << reason,
+           CORE_TRANS_TCP);
+#endif
+
+    // Reset the buffer first: if the write fails, the connection is being
+    // closed and the buffered messages are dropped
+    const uint32_t bytes = batchBytes_;
+    const uint32_t messages = batchMessages_;
+    batchBytes_ = 0;
+    batchMessages_ = 0;
+
+    nBatchesFlushed_.fetch_add(1, boost::memory_order_relaxed);
+    nMessagesBatched_.fetch_add(messages, boost::memory_order_relaxed);
+    switch (reason) {
+        case FLUSH_ON_SIZE:
+            nFlushesOnSize_.fetch_add(1, boost::memory_order_relaxed);
+            break;
+        case FLUSH_ON_DEADLINE:
+            nFlushesOnDeadline_.fetch_add(1, boost::memory_order_relaxed);
+            break;
+        case FLUSH_ON_PUNCT:
+            nFlushesOnPunct_.fetch_add(1, boost::memory_order_relaxed);
+            break;
+        case FLUSH_ON_UNBATCHED:
+            // Counted with the batches flushed only
+            break;
+    }
+
+    // Only messages without reconnection directives are batched
+    struct iovec iov;
+    iov.iov_base = batch_.get();
+    iov.iov_len = bytes;
+    if (compressUnlocked(&iov, 1, bytes)) {
+        writeUnlocked(deflater_->frame(), deflater_->frameSize(), false, false);
+    } else {
+        writeUnlocked(batch_.get(), bytes, false, false);
+    }
+}
+
 // Note: caller must hold mutex_.
 void TCPConnection::block()
 {
@@ -933,11 +1373,17 @@ void TCPConnection::block()
     // representative of the time we should have waited, but there's
     // not much we can do about that. We just hope it happens so
     // rarely that it won't effect our stats significantly.
-    timeval time;
-    socket_->block(0, BLOCK_TIMEOUT_USEC, time);
+    long waited;
+    if (ring_) {
+        waited = ring_->waitWritable(BLOCK_TIMEOUT_USEC);
+    } else {
+        timeval time;
+        socket_->block(0, BLOCK_TIMEOUT_USEC, time);
+        waited = BLOCK_TIMEOUT_USEC - time.tv_usec;
+    }
 
     for (int i = 0; i < NUM_WINDOWS; ++i) {
-        windows_[i].waited += BLOCK_TIMEOUT_USEC - time.tv_usec;
+        windows_[i].waited += waited;
 #if 0
         SPCDBG(L_TRACE, "windows[" << i << "]: blocks=" << windows_[i].blocks <<
                 ", waited=" << windows_[i].waited <<
@@ -978,7 +1424,24 @@ int TCPConnection::getCongestion(DataSender::OutputCongestion& congestion) const
     congestion.receiverPEId = ns_label.getPEId();
     congestion.receiverPortId = ns_label.getPortId();
 
+    // The sender sees a full writer queue as congestion, whatever the socket does
+    if (asyncWriter_) {
+        uint32_t depth = asyncWriter_->getQueueDepth();
+        value = std::max<int>(value, 100ULL * depth / asyncWriter_->getCapacity());
+        congestion.nMessagesQueued = depth;
+        congestion.nMessagesDropped = asyncWriter_->getDroppedCount();
+    }
+
     congestion.congestionFactor = value;
+    congestion.nBatchesFlushed = nBatchesFlushed_.load(boost::memory_order_relaxed);
+    congestion.nMessagesBatched = nMessagesBatched_.load(boost::memory_order_relaxed);
+    congestion.nFlushesOnSize = nFlushesOnSize_.load(boost::memory_order_relaxed);
+    congestion.nFlushesOnDeadline = nFlushesOnDeadline_.load(boost::memory_order_relaxed);
+    congestion.nFlushesOnPunct = nFlushesOnPunct_.load(boost::memory_order_relaxed);
+    congestion.nBytesBeforeCompression =
+      nBytesBeforeCompression_.load(boost::memory_order_relaxed);
+    congestion.nBytesAfterCompression = nBytesAfterCompression_.load(boost::memory_order_relaxed);
+    congestion.compressionTime = compressionTime_.load(boost::memory_order_relaxed);
     return rc;
 }
 
@@ -21,13 +21,17 @@
 #include <TRANS/DataSender.h>
 #include <TRANS/OperatorPortLabelImpl.h>
 #include <TRANS/PortLabelImpl.h>
+#include <TRANS/ShmRing.h>
+#include <TRANS/TCPAsyncWriter.h>
 #include <TRANS/TCPCommon.h>
+#include <TRANS/TCPCompression.h>
 #include <UTILS/Atomic.h>
 #include <UTILS/Mutex.h>
 #include <UTILS/SBuffer.h>
 #include <UTILS/Socket.h>
 
 #include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -68,6 +72,12 @@ class TCPConnection
                                       boost::shared_ptr<ConnectionHelper>& helper,
                                       const bool required = true);
 
+    /**
+     * Destructor.
+     * Stops the asynchronous writer, if any.
+     */
+    ~TCPConnection();
+
     /** Set connection id. */
     void setId(DataSender::ConnectionId id);
 
@@ -132,6 +142,132 @@ class TCPConnection
                bool autoRetryOnReconnect,
                bool resetReconnectionState);
 
+    /**
+     * Reason for writing the send buffer to the socket.
+     */
+    enum FlushReason
+    {
+        FLUSH_ON_SIZE,      ///< the buffer has reached the batching size threshold
+        FLUSH_ON_DEADLINE,  ///< the oldest buffered message has reached the latency deadline
+        FLUSH_ON_PUNCT,     ///< the client asked for a flush
+        FLUSH_ON_UNBATCHED  ///< the client wrote a message which bypasses the buffer
+    };
+
+    /**
+     * Append the message header and the data buffer to this connection's
+     * send buffer.  The send buffer is written to the socket as a single
+     * frame of back-to-back messages when it reaches the batching size
+     * threshold, or when its oldest message has waited longer than the
+     * batching latency deadline.
+     * @param hdr  message header
+     * @param data  data buffer
+     * @param count  size of the data buffer; the header and the data must
+     *      fit in the send buffer
+     * @param alwaysRetryAfterReconnect if write should be retried after a reconnect
+     * @param resetReconnectionState indicates if the transport should clear up any reconnection
+     * related state
+     *
+     * @throw WriteFailedException if connection doesn't have a label and
+     *  write failed
+     * @throw OptionalConnectIncompleteException if optional connection has
+     *  not been established - the caller will set a helper thread to run
+     *  reconnection
+     * @throw ConnectionRemovedException if connection has been closed
+     * @note obtains mutex_
+     */
+    void append(const socket_header_t& hdr,
+                const void* data,
+                const size_t count,
+                bool alwaysRetryAfterReconnect,
+                bool resetReconnectionState);
+
+    /**
+     * Write the content of the send buffer to the socket.
+     * @param reason  why the buffer is written
+     * @throw same exceptions as append()
+     * @note obtains mutex_
+     */
+    void flush(FlushReason reason);
+
+    /**
+     * Write the content of the send buffer to the socket if its oldest
+     * message has waited longer than the batching latency deadline.  The
+     * connection is skipped if mutex_ is busy, as the thread holding it is
+     * writing and checks the deadline itself.
+     * @param now  current time (microseconds)
+     * @throw same exceptions as append()
+     * @note tries to obtain mutex_
+     */
+    void flushIfExpired(streams_time_t now);
+
+    /**
+     * Keep the connection from being deleted while a thread uses it
+     * without holding the lock of its sender.
+     */
+    void pin() { pins_.fetch_add(1, boost::memory_order_relaxed); }
+
+    /**
+     * Release a pin, or the reference of the sender which owns the
+     * connection.  The connection is deleted when the last one goes away.
+     * @param conn  connection to release
+     */
+    static void unpin(TCPConnection* conn)
+    {
+        if (conn->pins_.fetch_sub(1, boost::memory_order_acq_rel) == 1) {
+            delete conn;
+        }
+    }
+
+    /**
+     * Queue a message to this connection's asynchronous writer.
+     * @param msg  message shared with the other connections of the sender
+     * @param alwaysRetryAfterReconnect if write should be retried after a reconnect
+     * @param resetReconnectionState indicates if the transport should clear up any reconnection
+     * related state
+     *
+     * @throw ConnectionRemovedException if connection has been closed
+     * @pre isAsync()
+     * @note waits while the writer queue is full
+     */
+    void enqueue(const SharedMessageRef& msg,
+                 bool alwaysRetryAfterReconnect,
+                 bool resetReconnectionState);
+
+    /**
+     * Queue a flush of the send buffer behind the messages queued to the
+     * asynchronous writer.
+     * @throw ConnectionRemovedException if connection has been closed
+     * @pre isAsync()
+     */
+    void enqueueFlush();
+
+    /**
+     * Wait until the asynchronous writer has written all queued messages.
+     * @param millis  timeout (milliseconds)
+     * @return true if the queue was drained, or there is no writer
+     */
+    bool drainAsync(uint32_t millis);
+
+    /**
+     * Determine if connections coalesce messages into their send buffer.
+     */
+    static bool isBatching() { return batchSize > 0; }
+
+    /**
+     * Determine if connections write messages from their own thread.
+     */
+    static bool isAsync() { return asyncQueueSize > 0; }
+
+    /**
+     * Return the send buffer size threshold (bytes).
+     */
+    static uint32_t getBatchSize() { return batchSize; }
+
+    /**
+     * Return the longest time a message waits in the send buffer (microseconds).
+     */
+    static streams_time_interval_t getBatchLatency() { return batchLatency; }
+
     /**
      * Return this connection's destination port label.
      */
@@ -307,6 +443,74 @@ class TCPConnection
      */
     void doConnectionHandshake();
 
+    /**
+     * Determine if the receiver runs on this host.
+     * @note caller must hold mutex_
+     */
+    bool isLocalReceiver();
+
+    /**
+     * Determine if the connection should propose a shared memory ring to
+     * the receiver: rings are enabled, the connection is not secure, the
+     * receiver runs on this host and the backoff of the last ring refusal,
+     * if any, has passed.
+     * @note caller must hold mutex_
+     */
+    bool proposeShmRing();
+
+    /**
+     * Record that a ring could not be used, and hold off proposing rings
+     * for a delay which doubles with each consecutive refusal.
+     * @note caller must hold mutex_
+     */
+    void refuseShmRing();
+
+    /**
+     * Create the shared memory ring to propose to the receiver.  On failure
+     * ring_ stays empty and the connection holds off proposing rings.
+     * @note caller must hold mutex_
+     */
+    void createShmRing();
+
+    /**
+     * Determine if the connection should propose compression to the
+     * receiver: compression is enabled, the receiver runs on another host
+     * and it has not failed a compression handshake.
+     * @note caller must hold mutex_
+     */
+    bool proposeCompression();
+
+    /**
+     * Send the connection handshake message proposing the shared memory
+     * ring in ring_, if any, and compression, if requested, then wait for
+     * the receiver's reply.  On success ring_ holds the connection's data
+     * path, otherwise the socket is used; compressing_ tells whether the
+     * receiver accepted compression.
+     * @param compression  propose compression
+     * @throws HandshakeErrorException if the receiver did not reply
+     * @note caller must hold mutex_
+     */
+    void doNegotiatedHandshake(bool compression);
+
+    /**
+     * Compress a block of messages if the receiver accepted compression and
+     * the block reaches the compression threshold, and update the
+     * compression metrics.
+     * @return true if the compressed frame is available from deflater_
+     * @note caller must hold mutex_
+     */
+    bool compressUnlocked(const struct iovec* iov, int iovcnt, uint32_t size);
+
+    /**
+     * Write data to the connection's data path (the shared memory ring if
+     * any, the socket otherwise) with the semantics of send(2): return the
+     * number of bytes written, or -1 with errno set to EWOULDBLOCK if the
+     * data path is full.
+     * @note caller must hold mutex_
+     */
+    ssize_t send(const void* data, size_t count);
+    ssize_t sendv(const struct iovec* iov, int iovcnt);
+
     /**
      * Report a broken connection after a socket write error, notify listeners,
      * write trace message.
@@ -366,6 +570,22 @@ class TCPConnection
      */
     void setState(const ConnectionState::State& state);
 
+    /**
+     * Write the data buffer to the socket, reconnecting and retrying on
+     * failure.
+     * @note caller must hold mutex_
+     */
+    void writeUnlocked(const void* data,
+                       const uint32_t count,
+                       bool alwaysRetryAfterReconnect,
+                       bool resetReconnectionState);
+
+    /**
+     * Write the content of the send buffer to the socket.
+     * @note caller must hold mutex_
+     */
+    void flushUnlocked(FlushReason reason);
+
     // These two functions are used by the write function to initialize and
     // update the write buffer for partial writes.
     static void reset_iovec(struct iovec* iov,
@@ -388,6 +608,29 @@ class TCPConnection
      */
     static bool lockQueueOnWrite;
 
+    /**
+     * Message batching.
+     * Size threshold of the per-connection send buffer (bytes); 0 disables
+     * batching.
+     */
+    static uint32_t batchSize;
+
+    /// Longest time a message waits in the send buffer (microseconds).
+    static streams_time_interval_t batchLatency;
+
+    /// Capacity of the shared memory rings (bytes); 0 disables the rings.
+    static uint32_t shmRingSize;
+
+    /// Capacity of the asynchronous writer queues (messages); 0 disables
+    /// asynchronous writes.
+    static uint32_t asyncQueueSize;
+
+    /// zlib level of the compressed connections; 0 disables compression.
+    static uint32_t compressionLevel;
+
+    /// Size under which batches and messages are sent uncompressed (bytes).
+    static uint32_t compressionThreshold;
+
     /// Length of congestion measurement window (seconds).
     static const int WINDOW_LENGTH_SEC = 5;
     /**
@@ -462,6 +705,12 @@ class TCPConnection
     // TODO review state flags semantics and reduce their number
     boost::scoped_ptr<InetSocket> socket_; ///< output socket
     boost::scoped_ptr<SBuffer> handshakeBuffer_;
+    boost::scoped_ptr<ShmRing> ring_; ///< shared memory data path to a receiver on this host
+    uint32_t ringRefusals_;           ///< consecutive ring handshake failures
+    streams_time_t ringRetryTime_;    ///< no ring is proposed before this time (microseconds)
+    bool compressing_;                ///< the receiver accepted compression
+    bool compressionRefused_;         ///< the receiver failed a compression handshake
+    boost::scoped_ptr<TCPDeflater> deflater_; ///< kept across reconnections
     ConnectionState::State state_;   ///< current state
     atomic_bool closed_;             ///< connection closed (removal pending)
     bool hasConnected_;              ///< connection has connected at least once
@@ -479,6 +728,24 @@ class TCPConnection
 
     boost::atomic<streams_time_t> lastWrite_; ///< timestamp of the last write (number of writes)
 
+    /// Send buffer
+    boost::scoped_array<unsigned char> batch_; ///< coalesced messages (allocated on first use)
+    uint32_t batchBytes_;                      ///< bytes in the send buffer
+    uint32_t batchMessages_;                   ///< messages in the send buffer
+    streams_time_t batchStarted_;              ///< time of the oldest message (microseconds)
+
+    /// Batching metrics
+    boost::atomic<uint64_t> nBatchesFlushed_;
+    boost::atomic<uint64_t> nMessagesBatched_;
+    boost::atomic<uint64_t> nFlushesOnSize_;
+    boost::atomic<uint64_t> nFlushesOnDeadline_;
+    boost::atomic<uint64_t> nFlushesOnPunct_;
+
+    /// Compression metrics
+    boost::atomic<uint64_t> nBytesBeforeCompression_;
+    boost::atomic<uint64_t> nBytesAfterCompression_;
+    boost::atomic<uint64_t> compressionTime_; ///< thread CPU time (microseconds)
+
     /// Congestion info
     struct block_info_t
     {
@@ -515,6 +782,12 @@ class TCPConnection
     time_t flipped_;                     ///< time of last flip (secs)
     mutable atomic_int savedCongestion_; ///< the last calculated congestion value,
                                          ///< returned when no fresh value available
+
+    /// Owner reference plus pins; see pin()
+    boost::atomic<uint32_t> pins_;
+
+    /// Writer thread, if asynchronous writes are on; destroyed first
+    boost::scoped_ptr<TCPAsyncWriter> asyncWriter_;
 };
 
 /////////////////////////////////////////////////////////////////////////////
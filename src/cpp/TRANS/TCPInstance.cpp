@@ -61,6 +61,7 @@ TCPInstance::TCPInstance()
   , securityDirectorySet_(false)
   , securityDirectory_()
   , heartBeatOn_(TransportUtils::configureHeartbeatOn())
+  , batchingOn_(TransportUtils::configureBatchSize() > 0)
   , monitor_(this)
 {
     init();
@@ -90,8 +91,8 @@ TCPInstance::~TCPInstance()
 
 void TCPInstance::start()
 {
-    // Create TCP monitor thread if the instance configuration has heartbeat on
-    if (heartBeatOn_) {
+    // Create TCP monitor thread if the instance configuration has heartbeat or batching on
+    if (heartBeatOn_ || batchingOn_) {
         monitor_.create();
         SPCDBG(L_INFO, "TCPMonitorThread started", CORE_TRANS_TCP);
     } else {
@@ -232,6 +233,48 @@ void TCPInstance::doHeartbeat(volatile bool* interruptFlag,
     }
 }
 
+void TCPInstance::doFlush(volatile bool* interruptFlag, streams_time_t now)
+{
+    // Pin the connections under the locks, then flush them without the locks
+    std::vector<TCPConnection*> conns;
+    {
+        AutoMutex am(sendersMutex_);
+        for (TCPSenderList::list_iterator it(senders_.begin()); !it.end() && !(*interruptFlag);
+             it++) {
+            TCPSender* sender = *it;
+            if (sender->completedShutdown()) {
+                //
+                // Skip this sender, it will be removed by TCPSender
+                //
+            } else {
+                sender->pinConnections(conns);
+            }
+        }
+    }
+
+    for (std::vector<TCPConnection*>::const_iterator it = conns.begin(); it != conns.end(); it++) {
+        TCPConnection* conn = *it;
+        try {
+            if (!(*interruptFlag)) {
+                conn->flushIfExpired(now);
+            }
+        } catch (OptionalConnectIncompleteException const& ex) {
+            // Optional connection is incomplete, skip it and move on.
+            SPCDBG(L_TRACE, ex.getExplanation() << ". Moving on to next connection",
+                   CORE_TRANS_TCP);
+        } catch (const ConnectionRemovedException& ex) {
+            // The sender deletes the connection on its next write
+        } catch (DistilleryException const& e) {
+            SPCDBG(L_ERROR, "Unexpected exception " << e, CORE_TRANS_TCP);
+        } catch (std::exception const& e) {
+            SPCDBG(L_ERROR, "Unexpected exception " << e.what(), CORE_TRANS_TCP);
+        } catch (...) {
+            SPCDBG(L_ERROR, "Unexpected exception", CORE_TRANS_TCP);
+        }
+        TCPConnection::unpin(conn);
+    }
+}
+
 std::ostream& Distillery::operator<<(std::ostream& s, const Distillery::TCPInstance::Id& id)
 {
     s << "(PE=" << id.peId << ", launchCount=" << id.peLaunchCount << ')';
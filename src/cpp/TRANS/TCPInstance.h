@@ -224,9 +224,16 @@ class TCPInstance : private boost::noncopyable
      */
     const bool heartBeatOn_;
 
-    // Heartbeat thread
+    /*
+     * Controlling the batching mechanism.  When on, the monitor thread
+     * flushes connection send buffers whose messages exceed the batching
+     * latency deadline.
+     */
+    const bool batchingOn_;
+
+    // Heartbeat and batch flush thread
     TCPMonitorThread monitor_;
-    friend class TCPMonitorThread; // invokes doHeartbeat()
+    friend class TCPMonitorThread; // invokes doHeartbeat() and doFlush()
 
     // Task invoked by a TCPMonitorThread to send heartbeats to all senders of this instance
     // TODO add task to the monitor thread initialization and remove the need for friend class
@@ -235,6 +242,12 @@ class TCPInstance : private boost::noncopyable
                      streams_time_t beforeTime,
                      streams_time_t curTime);
 
+    // Task invoked by a TCPMonitorThread to flush the expired send buffers of
+    // all senders of this instance.  The connections are written to without
+    // holding sendersMutex_ or the locks of the senders, so that a congested
+    // connection does not hold up the other senders and connections.
+    void doFlush(volatile bool* interruptFlag, streams_time_t now);
+
     TCPInstance();
     void init();
     void start();
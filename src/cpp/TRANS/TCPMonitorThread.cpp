@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <TRANS/TCPConnection.h>
 #include <TRANS/TCPInstance.h>
 #include <TRANS/TCPMonitorThread.h>
 #include <TRC/RuntimeTrcAspects.h>
@@ -31,16 +32,26 @@ void* TCPMonitorThread::run(void* threadArgs)
 {
     while (1) {
         streams_time_t beginTime = TCPCommon::sysTimeMillis();
-        tcpInstance_->doHeartbeat(&shutdown_, beginTime - heartbeatMillis_, beginTime);
+        if (tcpInstance_->heartBeatOn_) {
+            tcpInstance_->doHeartbeat(&shutdown_, beginTime - heartbeatMillis_, beginTime);
+        }
         if (shutdown_) {
             SPCDBG(L_INFO, "TCPMonitorThread will end", CORE_TRANS_TCP);
             break;
         }
 
-        // sleep at least minSleepBetweenRuns and up to intervalMillis
-        streams_time_interval_t toNextRun =
-          (beginTime + heartbeatMillis_ - TCPCommon::sysTimeMillis());
-        this->sleep(toNextRun);
+        if (tcpInstance_->batchingOn_) {
+            // flush expired send buffers until the next heartbeat is due
+            while (!shutdown_ && TCPCommon::sysTimeMillis() < beginTime + heartbeatMillis_) {
+                usleep(TCPConnection::getBatchLatency());
+                tcpInstance_->doFlush(&shutdown_, getTimeInMicrosecs());
+            }
+        } else {
+            // sleep at least minSleepBetweenRuns and up to intervalMillis
+            streams_time_interval_t toNextRun =
+              (beginTime + heartbeatMillis_ - TCPCommon::sysTimeMillis());
+            this->sleep(toNextRun);
+        }
     } // end while
     return NULL;
 }
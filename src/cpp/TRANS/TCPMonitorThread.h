@@ -28,7 +28,8 @@ namespace Distillery {
 class TCPInstance;
 
 /**
- * @internal General monitoring thread currently used for heartbeat.
+ * @internal General monitoring thread currently used for heartbeat and
+ * flushing expired connection send buffers.
  */
 class TCPMonitorThread
   : public Thread
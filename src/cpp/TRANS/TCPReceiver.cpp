@@ -19,6 +19,7 @@
 #include <TRANS/TCPCommon.h>
 #include <TRANS/TCPInstance.h>
 #include <TRANS/TCPReceiver.h>
+#include <TRANS/TransportUtils.h>
 #include <TRC/DistilleryDebug.h>
 #include <TRC/RuntimeTrcAspects.h>
 #include <UTILS/Formatter.h>
@@ -27,7 +28,10 @@
 #include <UTILS/SBuffer.h>
 #include <UTILS/auto_array.h>
 
+#include <algorithm>
+#include <sched.h>
 #include <sys/epoll.h>
+#include <sys/socket.h>
 
 UTILS_NAMESPACE_USE;
 NAM_NAMESPACE_USE;
@@ -36,10 +40,20 @@ DEBUG_NAMESPACE_USE
 
 #define CTOR_INIT                                                                                  \
     _wait_called(false), _epoll_fd(-1), _shutdown_fd(-1), _shutdown_other_fd(-1),                  \
-      _shutdown_requested(false)
+      _shutdown_requested(false), _shards_started(false)
 
 #define PREFETCH_SIZE (32 * 1024)
 
+// Large enough to read a whole batch of messages coalesced by the sender
+static const uint32_t prefetchBufferSize =
+  std::max<uint32_t>(PREFETCH_SIZE, TransportUtils::configureBatchSize());
+
+// Ready sockets handled per epoll_wait() call
+static const uint32_t receiverEvents = TransportUtils::configureReceiverEvents();
+
+// Threads reading the data ports of a receiver
+static const uint32_t receiverThreads = TransportUtils::configureReceiverThreads();
+
 uint16_t TCPReceiver::PORT_BASE = 10000;
 
 ostream& Distillery::operator<<(ostream& strm, const TCPReceiver::internal_port_data_t& p)
@@ -79,6 +93,21 @@ TCPReceiver::TCPReceiver(const vector<port_data_t>& ports)
 
     // register port labels and add socket entries to _port_data list
     registerPortLabels(ns, hostinfo.c_str(), new_sockets);
+
+    // Different ports are read by different shards: a port whose callback
+    // must not run concurrently with the others keeps the receiver on one thread
+    uint32_t nThreads = receiverThreads;
+    for (vector<port_data_t>::const_iterator it = ports.begin(); nThreads > 1 && it != ports.end();
+         it++) {
+        if (it->singleThreaded) {
+            SPCDBG(L_INFO,
+                   "Reading data ports with a single thread, as the callback of port "
+                     << QT(it->ns_label) << " must not run concurrently with the others",
+                   CORE_TRANS_TCP);
+            nThreads = 1;
+        }
+    }
+    createShards(nThreads);
 }
 
 TCPReceiver::~TCPReceiver()
@@ -100,6 +129,15 @@ TCPReceiver::~TCPReceiver()
 
     _port_data.clear();
 
+    for (size_t i = 0; i < _shards.size(); i++) {
+        deleteRetiredPorts(*_shards[i]);
+        if (i > 0) {
+            close(_shards[i]->epoll_fd);
+        }
+        delete _shards[i];
+    }
+    _shards.clear();
+
     close(_shutdown_fd);
     close(_shutdown_other_fd);
     close(_epoll_fd);
@@ -164,6 +202,9 @@ TCPReceiver::internal_port_data_t* TCPReceiver::createAcceptSocket(uint16_t tcp_
     DataSender::Id id;
     pd->senderId = id;
     pd->epollRegistered = false;
+    pd->shard = NULL;
+    pd->ring = NULL;
+    pd->inflater = NULL;
 
     try {
         pd->sock->bind(tcp_port, addr);
@@ -235,7 +276,8 @@ TCPReceiver::internal_port_data_t* TCPReceiver::acceptNewConnection(
     // Check the connection handshake to make sure it is not erroneous
     bool required = true;
     DataSender::Id senderId;
-    doConnectionHandshake(socket, accept_port->ns_label.str(), required, senderId);
+    ShmRing* ring = NULL;
+    doConnectionHandshake(socket, accept_port->ns_label.str(), required, senderId, ring);
 
     // TODO make internal_port_data_t data port constructor
     internal_port_data_t* new_pd = new internal_port_data_t;
@@ -248,13 +290,16 @@ TCPReceiver::internal_port_data_t* TCPReceiver::acceptNewConnection(
     new_pd->connections = 0;
     new_pd->reqConnFlag = required;
 #ifdef PREFETCH_SIZE
-    new_pd->prefetch_buffer = new unsigned char[PREFETCH_SIZE];
+    new_pd->prefetch_buffer = new unsigned char[prefetchBufferSize];
 #else
     new_pd->prefetch_buffer = NULL;
 #endif
     new_pd->prefetch_offset = 0;
     new_pd->prefetch_size = 0;
     new_pd->epollRegistered = false;
+    new_pd->shard = NULL;
+    new_pd->ring = ring;
+    new_pd->inflater = NULL;
     new_pd->senderId = senderId;
     return new_pd;
 }
@@ -262,7 +307,8 @@ TCPReceiver::internal_port_data_t* TCPReceiver::acceptNewConnection(
 void TCPReceiver::doConnectionHandshake(InetSocket* socket,
                                         const string& ns_label,
                                         bool& required,
-                                        DataSender::Id& senderId)
+                                        DataSender::Id& senderId,
+                                        ShmRing*& ring)
 {
     // Skip connection handshake if there is no label
     if (ns_label.empty()) {
@@ -289,6 +335,30 @@ void TCPReceiver::doConnectionHandshake(InetSocket* socket,
         ConnectionHandshake handshake(sbuf, ns_label);
         required = handshake.isRequiredConnection();
         senderId = handshake.getSenderId();
+
+        // A sender proposing a ring or compression waits for the reply
+        if (!handshake.getShmRing().empty() || handshake.getCompression()) {
+            ConnectionHandshakeReply::connHandshakeCode code = ConnectionHandshakeReply::CONNECTED;
+            if (!handshake.getShmRing().empty()) {
+                try {
+                    ring = ShmRing::attach(handshake.getShmRing());
+                    ring->unlink();
+                } catch (ShmRingException const& ex) {
+                    SPCDBG(L_WARN,
+                           "Refusing ring " << QT(handshake.getShmRing()) << " for input port "
+                                            << QT(ns_label) << ": " << ex.getExplanation(),
+                           CORE_TRANS_TCP);
+                    code = ConnectionHandshakeReply::RING_REFUSED;
+                }
+            }
+            // Data copied through a ring gains nothing from compression
+            bool compression = handshake.getCompression() && ring == NULL;
+            ConnectionHandshakeReply reply(code, compression);
+            SBuffer rbuf;
+            reply.serialize(rbuf);
+            TCPCommon::writeSocketWithHeader(socket, rbuf.getUCharPtr(),
+                                             rbuf.getSerializedDataSize());
+        }
     } catch (UnexpectedInstanceException const& ex) {
         SPCDBG(L_ERROR,
                "Rejecting Connection for input port "
@@ -312,6 +382,8 @@ void TCPReceiver::doConnectionHandshake(InetSocket* socket,
                CORE_TRANS_TCP);
         socket->close();
         delete socket;
+        delete ring;
+        ring = NULL;
         THROW_NESTED(HandshakeError, "Bad Connection Handshake", ex);
     }
 }
@@ -319,7 +391,8 @@ void TCPReceiver::doConnectionHandshake(InetSocket* socket,
 void TCPReceiver::closeDataPort(internal_port_data_t* pd)
 {
     if (pd->epollRegistered) {
-        if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, **pd->sock, NULL)) {
+        int epollFd = pd->shard != NULL ? pd->shard->epoll_fd : _epoll_fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_DEL, **pd->sock, NULL)) {
             ErrnoString s(errno);
             THROW(TCPReceiver, "Unable to remove fd=" << **pd->sock << " from epoll",
                   TRANSSystemCallFailed, "epoll_ctl(...EPOLL_CTL_DEL)", s.c_str());
@@ -339,6 +412,9 @@ void TCPReceiver::closeDataPort(internal_port_data_t* pd)
     if (pd->sock != NULL) {
         pd->sock->close();
     }
+    if (pd->ring != NULL) {
+        pd->ring->close();
+    }
     pd->prefetch_size = 0;
 }
 
@@ -347,6 +423,8 @@ void TCPReceiver::deletePort(internal_port_data_t* pd)
     if (pd->sock != NULL) {
         delete pd->sock;
     }
+    delete pd->ring;
+    delete pd->inflater;
 #ifdef PREFETCH_SIZE
     delete[] pd->prefetch_buffer;
 #endif
@@ -390,11 +468,10 @@ void TCPReceiver::rejectSameSender(internal_port_data_t** ppd, PortList& ports)
 
                 // newPd has higher or same PE launch count, close old pd and
                 // remove from list
-                closeDataPort(pd);
-                deletePort(pd);
                 PortList::iterator tmp(it);
                 it++;
                 ports.erase(tmp);
+                retirePort(pd);
 
                 // TODO for equal launch counts, investigate draining the old
                 // connection before reading the new one
@@ -538,33 +615,13 @@ void TCPReceiver::wait()
         }
     }
 
-    // For each new connection, register its file descriptor and event EPOLLIN with the current
-    // epoll instance _epoll_fd Add new connection to _port_data
+    // For each new connection, register its file descriptor and event EPOLLIN with the epoll
+    // instance of a shard. Add new connection to _port_data
     list<internal_port_data_t*>::iterator it2 = new_clients.begin();
     while (it2 != new_clients.end()) {
         internal_port_data_t* pd = *it2;
         _port_data.push_back(pd);
-
-        if (!pd->epollRegistered) {
-            struct epoll_event evt;
-            memset(&evt, 0, sizeof(evt));
-            evt.events = EPOLLIN;
-            evt.data.ptr = pd;
-            if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, **pd->sock, &evt)) {
-                ErrnoString s(errno);
-                THROW(TCPReceiver, "epoll_ctl(" << _epoll_fd << ", EPOLL_CTL_ADD...)",
-                      TRANSSystemCallFailed, "epoll_ctl", s.c_str());
-            }
-            pd->epollRegistered = true;
-            pd->callback->onConnected(pd->ns_label.getPortId(), pd->senderId.toPortLabel(),
-                                      !pd->reqConnFlag);
-        } else {
-            // Socket already registered with epoll
-            std::stringstream ss;
-            ss << "Socket fd=" << **pd->sock << " from " << pd->senderId
-               << " already registered with the epoll instance";
-            THROW_STRING(LogicError, pd->ns_label.str(), TRANSLogicError, ss.str().c_str());
-        }
+        registerDataPort(pd);
         it2++;
     }
 }
@@ -615,6 +672,9 @@ uint32_t TCPReceiver::readOrDie(internal_port_data_t* pd,
     if (max_size == 0 || min_size == 0) {
         return 0; // read nothing
     }
+    if (pd->ring != NULL) {
+        return readRingOrDie(pd, data, min_size, max_size);
+    }
     do {
         ssize_t rc = pd->sock->read(data, max_size);
 
@@ -648,9 +708,55 @@ uint32_t TCPReceiver::readOrDie(internal_port_data_t* pd,
     return readBytes;
 }
 
+uint32_t TCPReceiver::readRingOrDie(internal_port_data_t* pd,
+                                    void* data,
+                                    size_t min_size,
+                                    size_t max_size)
+{
+    size_t readBytes = 0;
+    for (;;) {
+        size_t rc = pd->ring->read(data, max_size);
+        readBytes += rc;
+        data = (char*)data + rc;
+        max_size -= rc;
+        if (rc >= min_size) {
+            return readBytes;
+        }
+        min_size -= rc;
+
+        // The rest of the message is being written; check that the sender
+        // is still there, then read the data it wrote before leaving
+        if ((!drainWakeups(pd) && pd->ring->empty()) || _shutdown_requested) {
+            SPCDBG(L_INFO, "Connection lost: " << *pd, CORE_TRANS_TCP);
+            closeDataPort(pd);
+            return 0;
+        }
+        sched_yield();
+    }
+}
+
+bool TCPReceiver::drainWakeups(internal_port_data_t* pd)
+{
+    char buf[64];
+    for (;;) {
+        ssize_t rc = recv(**pd->sock, buf, sizeof(buf), MSG_DONTWAIT);
+        if (rc == 0) {
+            return false;
+        }
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // EWOULDBLOCK: no more wakeups; other errors end the connection
+            return errno == EWOULDBLOCK;
+        }
+    }
+}
+
 uint32_t TCPReceiver::prefetchOrRead(internal_port_data_t* pd,
                                      unsigned char** data_ptr,
-                                     unsigned char* small_buffer)
+                                     unsigned char* small_buffer,
+                                     bool& compressed)
 {
     // This function is called only if there is data in the prefetch buffer
 
@@ -680,6 +786,7 @@ uint32_t TCPReceiver::prefetchOrRead(internal_port_data_t* pd,
     }
     uint32_t msgSize = hdr->messageSize();
     uint32_t hdrSize = sizeof(*hdr);
+    compressed = hdr->isCompressed();
 
     // TODO limit the amount allocated - what is the MAX_TUPLE_SIZE?
     unsigned char* data = msgSize > TCP_SMALL_BUFFER ? new unsigned char[msgSize] : small_buffer;
@@ -748,9 +855,232 @@ uint32_t TCPReceiver::prefetchOrRead(internal_port_data_t* pd,
     return msgSize;
 }
 
+void TCPReceiver::readPort(internal_port_data_t* pd, unsigned char* small_buffer)
+{
+    SPCDBG(L_TRACE, "Reading data from fd=" << **pd->sock << ", ptr=0x" << pd, CORE_TRANS_TCP);
+
+    unsigned char* data_ptr = NULL;
+    uint32_t size = 0;
+    bool compressed = false;
+
+    if (pd->ring != NULL) {
+        // The socket only carries wakeups; the data is in the ring
+        bool connected = drainWakeups(pd);
+        if (pd->ring->empty()) {
+            if (!connected) {
+                SPCDBG(L_INFO, "Connection lost: " << *pd, CORE_TRANS_TCP);
+                closeDataPort(pd);
+            }
+            return;
+        }
+    }
+
+#ifdef PREFETCH_SIZE
+    pd->prefetch_size =
+      readOrDie(pd, pd->prefetch_buffer, sizeof(socket_header_t), prefetchBufferSize);
+    pd->prefetch_offset = 0;
+    if (pd->prefetch_size == 0) {
+        // We got EOF. the socket has already been removed from
+        // the epoll list. skipping it now
+        return;
+    }
+
+    size = prefetchOrRead(pd, &data_ptr, small_buffer, compressed);
+    if (size == 0) {
+        // We either: (a) received a zero-length message, or
+        // (b) got EOF in read(), the socket has already been removed from
+        // the epoll list, skipping it now
+        return;
+    }
+#else
+    // no prefetch, read only as much as needed
+    socket_header_t hdr;
+
+    if (readOrDie(pd, &hdr, sizeof(hdr), sizeof(hdr)) == 0) {
+        // We got EOF. the socket has already been removed from
+        // the epoll list. skipping it now
+        return;
+    }
+
+    if (!hdr.isValid()) {
+        string s = hdr.toString();
+        THROW_CHAR(ReadError, "Bad MAGIC", TRANSInvalidMessageHeader, s.c_str());
+    }
+
+    uint32_t msgSize = hdr.messageSize();
+    compressed = hdr.isCompressed();
+
+    unsigned char* data = new unsigned char[msgSize];
+
+    if (readOrDie(pd, data, msgSize, msgSize) == 0) {
+        // We either: (a) received a zero-length message, or
+        // (b) got EOF in read(), the socket has already been removed from
+        // the epoll list, skipping it now
+        return;
+    }
+
+    data_ptr = data;
+    size = msgSize;
+#endif
+    deliver(pd, data_ptr, size, compressed);
+
+    if (data_ptr != small_buffer) {
+        delete[] data_ptr;
+    }
+}
+
+void TCPReceiver::deliver(internal_port_data_t* pd,
+                          unsigned char* data,
+                          uint32_t size,
+                          bool compressed)
+{
+    if (!compressed) {
+        pd->callback->onMessage(data, size, pd->user_data);
+        return;
+    }
+
+    if (pd->inflater == NULL) {
+        pd->inflater = new TCPInflater;
+    }
+    uint32_t blockSize;
+    unsigned char* block = pd->inflater->decompress(data, size, blockSize);
+    if (block == NULL) {
+        THROW(ReadError, "Unable to decompress a frame of " << size << " bytes",
+              TRANSDataCorrupted);
+    }
+
+    // The block holds complete messages, each with its header
+    uint32_t offset = 0;
+    while (offset < blockSize) {
+        if (blockSize - offset < sizeof(socket_header_t)) {
+            THROW(ReadError, "Truncated message header in a compressed frame", TRANSDataCorrupted);
+        }
+        socket_header_t* hdr = reinterpret_cast<socket_header_t*>(block + offset);
+        if (!hdr->isValid() || hdr->isCompressed()) {
+            string s = hdr->toString();
+            THROW_CHAR(ReadError, "Bad MAGIC", TRANSInvalidMessageHeader, s.c_str());
+        }
+        uint32_t msgSize = hdr->messageSize();
+        offset += sizeof(*hdr);
+        if (msgSize > blockSize - offset) {
+            THROW(ReadError, "Truncated message in a compressed frame", TRANSDataCorrupted);
+        }
+        if (msgSize > 0) {
+            pd->callback->onMessage(block + offset, msgSize, pd->user_data);
+        }
+        offset += msgSize;
+    }
+}
+
+bool TCPReceiver::drainPrefetched(Shard& shard, unsigned char* small_buffer)
+{
+    bool more = false;
+    PortList::iterator it = shard.ports.begin();
+    while (it != shard.ports.end() && !_shutdown_requested) {
+        internal_port_data_t* pd = *it;
+        while (pd->prefetch_size > 0 && !_shutdown_requested) {
+            unsigned char* data_ptr = NULL;
+            bool compressed = false;
+            uint32_t size = prefetchOrRead(pd, &data_ptr, small_buffer, compressed);
+            if (size == 0) {
+                // We either: (a) received a zero-length message, or
+                // (b) got EOF in read(), the socket has already been removed from
+                // the epoll list, skipping it now
+                continue;
+            }
+
+            deliver(pd, data_ptr, size, compressed);
+
+            if (data_ptr != small_buffer) {
+                delete[] data_ptr;
+            }
+        }
+
+        // Ask for a wakeup before waiting, unless the ring has data already
+        if (pd->ring != NULL && pd->epollRegistered && pd->prefetch_size == 0 &&
+            !pd->ring->park()) {
+            pd->prefetch_size =
+              readOrDie(pd, pd->prefetch_buffer, sizeof(socket_header_t), prefetchBufferSize);
+            pd->prefetch_offset = 0;
+            more = true;
+        }
+
+        it++;
+    }
+    return more;
+}
+
+void TCPReceiver::acceptConnection(internal_port_data_t* pd)
+{
+    SPCDBG(L_DEBUG,
+           "Activity on an accept socket"
+             << " (port " << pd->sock->getPort() << ")",
+           CORE_TRANS_TCP);
+
+    try {
+        internal_port_data_t* new_pd = acceptNewConnection(pd);
+        rejectSameSender(&new_pd, _port_data);
+        rejectUnexpectedSender(&new_pd, pd);
+
+        if (new_pd != NULL) {
+            SPCDBG(L_DEBUG,
+                   "Accept port " << pd->ns_label.str()
+                                  << ": registering connection from sender id "
+                                  << QT(new_pd->senderId) << " with PE restart count "
+                                  << new_pd->senderId.peRestartCount,
+                   CORE_TRANS_TCP);
+
+            _port_data.push_back(new_pd);
+            registerDataPort(new_pd);
+        }
+    } catch (const HandshakeErrorException& ex) {
+        SPCDBG(L_INFO,
+               "Rejecting Connection for input port "
+                 << QT(pd->ns_label)
+                 << ", connection handshake exception : " << ex.getExplanation(),
+               CORE_TRANS_TCP);
+    } catch (const SocketException& ex) {
+        SPCDBG(L_INFO,
+               "Skipping Connection for input port "
+                 << QT(pd->ns_label) << ", socket exception : " << ex.getExplanation(),
+               CORE_TRANS_TCP);
+    }
+}
+
 void TCPReceiver::run()
+{
+    // The calling thread runs the first shard and accepts new connections
+    for (size_t i = 1; i < _shards.size(); i++) {
+        _shards[i]->create();
+    }
+    _shards_started = true;
+
+    bool signaled = false;
+    try {
+        signaled = runShard(*_shards[0]);
+    } catch (...) {
+        stopShards();
+        throw;
+    }
+    stopShards();
+
+    SPCDBG(L_INFO, "Shutdown signal received", CORE_TRANS_TCP);
+    doShutdown();
+    for (size_t i = 1; i < _shards.size(); i++) {
+        if (!_shards[i]->error.empty()) {
+            THROW(TCPReceiver, "Receiver thread " << i << " failed: " << _shards[i]->error);
+        }
+    }
+    if (signaled) {
+        THROW(ShutdownRequested, "");
+    }
+}
+
+bool TCPReceiver::runShard(Shard& shard)
 {
     unsigned char small_buffer[TCP_SMALL_BUFFER];
+    std::vector<struct epoll_event> events(receiverEvents);
+    std::vector<internal_port_data_t*> accepts;
 
     while (!_shutdown_requested) {
 
@@ -758,28 +1088,11 @@ void TCPReceiver::run()
          * Use prefetched data if we have any
          */
 
+        bool more = false;
 #if PREFETCH_SIZE
-        PortList::iterator it = _port_data.begin();
-        while (it != _port_data.end() && !_shutdown_requested) {
-            internal_port_data_t* pd = *it;
-            while (pd->prefetch_size > 0 && !_shutdown_requested) {
-                unsigned char* data_ptr = NULL;
-                uint32_t size = prefetchOrRead(pd, &data_ptr, small_buffer);
-                if (size == 0) {
-                    // We either: (a) received a zero-length message, or
-                    // (b) got EOF in read(), the socket has already been removed from
-                    // the epoll list, skipping it now
-                    continue;
-                }
-
-                pd->callback->onMessage(data_ptr, size, pd->user_data);
-
-                if (data_ptr != small_buffer) {
-                    delete[] data_ptr;
-                }
-            }
-
-            it++;
+        {
+            AutoMutex am(shard.mutex);
+            more = drainPrefetched(shard, small_buffer);
         }
 #endif
 
@@ -788,15 +1101,12 @@ void TCPReceiver::run()
         }
 
         /*
-         * No prefetched data available, waiting for a socket to be active
+         * No prefetched data available, waiting for sockets to be active
          */
 
-        struct epoll_event evt;
-        memset(&evt, 0, sizeof(evt));
-
         SPCDBG(L_TRACE, "Entering epoll_wait()", CORE_TRANS_TCP);
 
-        int rc = epoll_wait(_epoll_fd, &evt, 1, -1);
+        int rc = epoll_wait(shard.epoll_fd, &events[0], events.size(), more ? 0 : -1);
 
         SPCDBG(L_TRACE, "epoll_wait() returned with code " << rc, CORE_TRANS_TCP);
 
@@ -810,162 +1120,194 @@ void TCPReceiver::run()
             }
         }
 
-        if (rc != 1) {
+        if (rc == 0 && more) {
+            continue;
+        }
+
+        if (rc < 1) {
             THROW_CHAR(AcceptError, "Invalid return code from epoll_wait", TRANSSystemCallFailed,
                        "epoll_wait", rc);
         }
 
-        if (evt.events == EPOLLIN) {
-            if (evt.data.fd == _shutdown_fd) {
-                SPCDBG(L_INFO, "Shutdown signal received", CORE_TRANS_TCP);
-                doShutdown();
-                THROW(ShutdownRequested, "");
-            }
-
-            internal_port_data_t* pd = (internal_port_data_t*)evt.data.ptr;
-
-            /*
-             * Process accept requests.
-             */
-
-            if (pd->accept) {
-                SPCDBG(L_DEBUG,
-                       "Activity on an accept socket"
-                         << " (port " << pd->sock->getPort() << ")",
-                       CORE_TRANS_TCP);
-
-                try {
-                    internal_port_data_t* new_pd = acceptNewConnection(pd);
-                    rejectSameSender(&new_pd, _port_data);
-                    rejectUnexpectedSender(&new_pd, pd);
+        /*
+         * Process read requests. Accept requests are processed after all the
+         * ready data ports because they may retire ports referenced by the
+         * events.
+         */
 
-                    if (new_pd != NULL) {
-                        SPCDBG(L_DEBUG,
-                               "Accept port " << pd->ns_label.str()
-                                              << ": registering connection from sender id "
-                                              << QT(new_pd->senderId) << " with PE restart count "
-                                              << new_pd->senderId.peRestartCount,
-                               CORE_TRANS_TCP);
+        accepts.clear();
+        {
+            AutoMutex am(shard.mutex);
+            for (int i = 0; i < rc; i++) {
+                struct epoll_event& evt = events[i];
+                if (evt.events == EPOLLIN) {
+                    if (evt.data.fd == _shutdown_fd) {
+                        SPCDBG(L_INFO, "Shutdown signal received", CORE_TRANS_TCP);
+                        return true;
+                    }
 
-                        _port_data.push_back(new_pd);
-
-                        if (!new_pd->epollRegistered) {
-
-                            memset(&evt, 0, sizeof(evt));
-                            evt.events = EPOLLIN;
-                            evt.data.ptr = new_pd;
-
-                            if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, **new_pd->sock, &evt)) {
-                                ErrnoString s(errno);
-                                THROW_CHAR(TCPReceiver, "epoll_ctl_add failed",
-                                           TRANSSystemCallFailed, "epoll_ctl(...EPOLL_CTL_ADD)",
-                                           s.c_str());
-                            }
-                            new_pd->epollRegistered = true;
-                            pd->callback->onConnected(new_pd->ns_label.getPortId(),
-                                                      new_pd->senderId.toPortLabel(),
-                                                      !new_pd->reqConnFlag);
-                        } else {
-                            // Socket already registered with epoll
-                            std::stringstream ss;
-                            ss << "Socket fd=" << **new_pd->sock << " from " << new_pd->senderId
-                               << " already registered with the epoll instance";
-                            THROW_STRING(LogicError, new_pd->ns_label.str(), TRANSLogicError,
-                                         ss.str().c_str());
-                        }
+                    internal_port_data_t* pd = (internal_port_data_t*)evt.data.ptr;
+                    if (pd->accept) {
+                        accepts.push_back(pd);
+                    } else if (pd->epollRegistered) {
+                        readPort(pd, small_buffer);
                     }
-                } catch (const HandshakeErrorException& ex) {
-                    SPCDBG(L_INFO,
-                           "Rejecting Connection for input port "
-                             << QT(pd->ns_label)
-                             << ", connection handshake exception : " << ex.getExplanation(),
-                           CORE_TRANS_TCP);
-                } catch (const SocketException& ex) {
-                    SPCDBG(L_INFO,
-                           "Skipping Connection for input port "
-                             << QT(pd->ns_label) << ", socket exception : " << ex.getExplanation(),
-                           CORE_TRANS_TCP);
+                    // else the port was closed after epoll_wait() returned
+                } else if (evt.events & EPOLLHUP) {
+                    // Close data port (sender closed connection)
+                    internal_port_data_t* pd = (internal_port_data_t*)evt.data.ptr;
+                    if (pd->epollRegistered) {
+                        closeDataPort(pd);
+                        SPCDBG(L_INFO, "Connection lost: " << *pd, CORE_TRANS_TCP);
+                    }
+                } else {
+                    EPollEventString str(evt.events);
+                    THROW_CHAR(AcceptError, "Invalid event on epoll_wait", TRANSSystemCallFailed,
+                               "epoll_wait", str.c_str());
                 }
-                continue;
             }
+            deleteRetiredPorts(shard);
+        }
 
-            /*
-             * Process read requests.
-             */
-
-            SPCDBG(L_TRACE,
-                   "Reading data from fd=" << **pd->sock << ", " << evt.data.fd << ", ptr=0x" << pd,
-                   CORE_TRANS_TCP);
-
-            unsigned char* data_ptr = NULL;
-            uint32_t size = 0;
+        /*
+         * Process accept requests.
+         */
 
-#ifdef PREFETCH_SIZE
-            pd->prefetch_size =
-              readOrDie(pd, pd->prefetch_buffer, sizeof(socket_header_t), PREFETCH_SIZE);
-            pd->prefetch_offset = 0;
-            if (pd->prefetch_size == 0) {
-                // We got EOF. the socket has already been removed from
-                // the epoll list. skipping it now
-                continue;
-            }
+        for (size_t i = 0; i < accepts.size() && !_shutdown_requested; i++) {
+            acceptConnection(accepts[i]);
+        }
+    }
+    return false;
+}
 
-            size = prefetchOrRead(pd, &data_ptr, small_buffer);
-            if (size == 0) {
-                // We either: (a) received a zero-length message, or
-                // (b) got EOF in read(), the socket has already been removed from
-                // the epoll list, skipping it now
-                continue;
-            }
-#else
-            // no prefetch, read only as much as needed
-            socket_header_t hdr;
+void* TCPReceiver::Shard::run(void* threadArgs)
+{
+    // A failed shard stops the receiver: run() reports the failure to the PE
+    try {
+        receiver_.runShard(*this);
+        return NULL;
+    } catch (DistilleryException const& e) {
+        SPCDBG(L_ERROR, "Unexpected exception from receiver shard: " << e, CORE_TRANS_TCP);
+        error = e.getExplanation();
+    } catch (std::exception const& e) {
+        SPCDBG(L_ERROR, "Unexpected exception from receiver shard: " << e.what(), CORE_TRANS_TCP);
+        error = e.what();
+    } catch (...) {
+        SPCDBG(L_ERROR, "Unexpected exception from receiver shard", CORE_TRANS_TCP);
+        error = "unknown exception";
+    }
+    if (error.empty()) {
+        error = "unknown error";
+    }
+    receiver_.shutdown();
+    return NULL;
+}
 
-            if (readOrDie(pd, &hdr, sizeof(hdr), sizeof(hdr)) == 0) {
-                // We got EOF. the socket has already been removed from
-                // the epoll list. skipping it now
-                continue;
-            }
+void TCPReceiver::createShards(uint32_t nThreads)
+{
+    _shards.push_back(new Shard(*this, _epoll_fd));
+    for (uint32_t i = 1; i < nThreads; i++) {
+        int fd = epoll_create(2);
+        if (fd == -1) {
+            ErrnoString s(errno);
+            THROW_CHAR(TCPReceiver, "epoll_create() failed", TRANSSystemCallFailed, "epoll_create",
+                       s.c_str());
+        }
+        _shards.push_back(new Shard(*this, fd));
 
-            if (!hdr.isValid()) {
-                string s = hdr.toString();
-                THROW_CHAR(ReadError, "Bad MAGIC", TRANSInvalidMessageHeader, s.c_str());
-            }
+        // All shards watch the shutdown pipe
+        struct epoll_event evt;
+        memset(&evt, 0, sizeof(evt));
+        evt.events = EPOLLIN;
+        evt.data.fd = _shutdown_fd;
+        if (epoll_ctl(fd, EPOLL_CTL_ADD, _shutdown_other_fd, &evt)) {
+            ErrnoString s(errno);
+            THROW_CHAR(TCPReceiver, "epoll_ctl_add failed", TRANSSystemCallFailed, "epoll_ctl_add",
+                       s.c_str());
+        }
+    }
+    SPCDBG(L_INFO, "Reading data ports with " << _shards.size() << " thread(s)", CORE_TRANS_TCP);
+}
 
-            uint32_t msgSize = hdr.messageSize();
+void TCPReceiver::stopShards()
+{
+    if (!_shards_started) {
+        return;
+    }
+    if (_shards.size() > 1) {
+        if (!_shutdown_requested) {
+            shutdown();
+        }
+        for (size_t i = 1; i < _shards.size(); i++) {
+            _shards[i]->join();
+        }
+    }
+    _shards_started = false;
+}
 
-            unsigned char* data = new unsigned char[msgSize];
+void TCPReceiver::registerDataPort(internal_port_data_t* pd)
+{
+    if (pd->epollRegistered) {
+        // Socket already registered with epoll
+        std::stringstream ss;
+        ss << "Socket fd=" << **pd->sock << " from " << pd->senderId
+           << " already registered with the epoll instance";
+        THROW_STRING(LogicError, pd->ns_label.str(), TRANSLogicError, ss.str().c_str());
+    }
 
-            if (readOrDie(pd, data, msgSize, msgSize) == 0) {
-                // We either: (a) received a zero-length message, or
-                // (b) got EOF in read(), the socket has already been removed from
-                // the epoll list, skipping it now
-                continue;
+    // Only this thread adds and removes shard ports. The connections of a
+    // PE input port all go to the shard of its first connection.
+    Shard*& shard = _port_shards[pd->ns_label.getPortId()];
+    if (shard == NULL) {
+        shard = _shards[0];
+        for (size_t i = 1; i < _shards.size(); i++) {
+            if (_shards[i]->inputPorts < shard->inputPorts) {
+                shard = _shards[i];
             }
+        }
+        shard->inputPorts++;
+    }
 
-            data_ptr = data;
-            size = msgSize;
-#endif
-            pd->callback->onMessage(data_ptr, size, pd->user_data);
+    AutoMutex am(shard->mutex);
+    struct epoll_event evt;
+    memset(&evt, 0, sizeof(evt));
+    evt.events = EPOLLIN;
+    evt.data.ptr = pd;
+    if (epoll_ctl(shard->epoll_fd, EPOLL_CTL_ADD, **pd->sock, &evt)) {
+        ErrnoString s(errno);
+        THROW(TCPReceiver, "epoll_ctl(" << shard->epoll_fd << ", EPOLL_CTL_ADD...)",
+              TRANSSystemCallFailed, "epoll_ctl", s.c_str());
+    }
+    pd->epollRegistered = true;
+    pd->shard = shard;
+    shard->ports.push_back(pd);
+    pd->callback->onConnected(pd->ns_label.getPortId(), pd->senderId.toPortLabel(),
+                              !pd->reqConnFlag);
+}
 
-            if (data_ptr != small_buffer) {
-                delete[] data_ptr;
-            }
-        } else if (evt.events & EPOLLHUP) {
-            // Close data port (sender closed connection)
-            internal_port_data_t* pd = (internal_port_data_t*)evt.data.ptr;
-            closeDataPort(pd);
-            SPCDBG(L_INFO, "Connection lost: " << *pd, CORE_TRANS_TCP);
-            continue;
-        } else {
-            EPollEventString str(evt.events);
-            THROW_CHAR(AcceptError, "Invalid event on epoll_wait", TRANSSystemCallFailed,
-                       "epoll_wait", str.c_str());
-        }
+void TCPReceiver::retirePort(internal_port_data_t* pd)
+{
+    if (pd->shard == NULL) {
+        closeDataPort(pd);
+        deletePort(pd);
+        return;
     }
 
-    SPCDBG(L_INFO, "Shutdown signal received", CORE_TRANS_TCP);
-    doShutdown();
+    Shard& shard = *pd->shard;
+    AutoMutex am(shard.mutex);
+    if (pd->epollRegistered) {
+        closeDataPort(pd);
+    }
+    shard.ports.remove(pd);
+    shard.retired.push_back(pd);
+}
+
+void TCPReceiver::deleteRetiredPorts(Shard& shard)
+{
+    for (PortList::iterator it = shard.retired.begin(); it != shard.retired.end(); it++) {
+        deletePort(*it);
+    }
+    shard.retired.clear();
 }
 
 void TCPReceiver::doShutdown()
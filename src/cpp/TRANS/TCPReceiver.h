@@ -21,13 +21,18 @@
 #include <TRANS/DataSender.h>
 #include <TRANS/OperatorPortLabelImpl.h>
 #include <TRANS/PortLabelImpl.h>
+#include <TRANS/ShmRing.h>
 #include <TRANS/TCPCommon.h>
+#include <TRANS/TCPCompression.h>
 #include <UTILS/DistilleryException.h>
 #include <UTILS/LinkedList.h>
+#include <UTILS/Mutex.h>
 #include <UTILS/Socket.h>
+#include <UTILS/Thread.h>
 #include <UTILS/UTILSTypes.h>
 #include <netinet/in.h>
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -47,6 +52,8 @@ class TCPReceiver : public DataReceiver
     static uint16_t PORT_BASE;
 
   protected:
+    class Shard;
+
     typedef struct _internal_port_data_t
     {
         DataReceiver::Callback* callback; // PE Input Port message callback
@@ -64,15 +71,51 @@ class TCPReceiver : public DataReceiver
         bool reqConnFlag;                 // Flag indicating if this is a required connection
         DataSender::Id senderId;          // Id of sender connected to this port
         bool epollRegistered; // true if port registered with the epoll instance, otherwise false
+        Shard* shard;         // Shard reading this data port, NULL if not assigned yet
+        ShmRing* ring;        // Shared memory data path of a same host sender, NULL if none
+        TCPInflater* inflater; // Decompresses the frames of a compressing sender,
+                               // NULL until the first frame
     } internal_port_data_t;
 
+    typedef std::list<internal_port_data_t*> PortList;
+
+    /// A thread and an epoll instance reading a subset of the data ports.
+    /// All the data ports of a PE input port are read by the same shard,
+    /// which the port stays with for its lifetime: the PE deserializes the
+    /// messages of an input port into a single tuple, so they must be
+    /// delivered by a single thread.
+    class Shard : public Thread
+    {
+      public:
+        Shard(TCPReceiver& receiver, int epollFd)
+          : epoll_fd(epollFd)
+          , inputPorts(0)
+          , receiver_(receiver)
+        {}
+
+        /// Read the shard's data ports until shutdown
+        void* run(void* threadArgs);
+
+        int epoll_fd;     // epoll instance watching the shard's data ports
+        Mutex mutex;      // held while reading data ports; protects ports and retired
+        PortList ports;   // data ports read by this shard
+        PortList retired; // ports closed by the accepting thread, deleted by the shard
+        uint32_t inputPorts; // PE input ports assigned to this shard
+        std::string error;   // failure that stopped the shard, empty if none
+
+      private:
+        TCPReceiver& receiver_;
+    };
+
     bool _wait_called;
     int _epoll_fd;
     int _shutdown_fd;
     int _shutdown_other_fd;
     volatile bool _shutdown_requested;
-    typedef std::list<internal_port_data_t*> PortList;
     PortList _port_data;
+    std::vector<Shard*> _shards; // _shards[0] is run by the thread calling run()
+    bool _shards_started;
+    std::map<unsigned long long, Shard*> _port_shards; // PE input port id -> its shard
 
     /// Create a socket to listen for new connections
     /// @param tcp_port port to listen on
@@ -97,10 +140,27 @@ class TCPReceiver : public DataReceiver
     /// @param ns_label Label of the input port
     /// @param required (Out) Flag indicating if this is a required connection
     /// @param senderId (Out) The sender Id read from the handshake buffer
+    /// @param ring (Out) The shared memory ring proposed by the sender, NULL
+    /// if none was proposed or it could not be attached
+    /// Compression proposed by a sender is accepted unless a ring is used.
     void doConnectionHandshake(InetSocket* socket,
                                const std::string& ns_label,
                                bool& required,
-                               DataSender::Id& senderId);
+                               DataSender::Id& senderId,
+                               ShmRing*& ring);
+
+    /// Read a message from the shared memory ring of a port
+    /// @param pd TCPReceiver port with a ring
+    /// @param data Pointer to buffer to read message into
+    /// @param min_size Minimum amount of data to be read
+    /// @param max_size Maximum amount of data to be read
+    /// @return amount of data read from the ring, 0 if the sender is gone
+    uint32_t readRingOrDie(internal_port_data_t* pd, void* data, size_t min_size, size_t max_size);
+
+    /// Consume the wakeups a sender posted on the socket of a ring port
+    /// @param pd TCPReceiver port with a ring
+    /// @return false if the sender closed the connection
+    bool drainWakeups(internal_port_data_t* pd);
 
     /// Read a message from a port
     /// @param pd TCPReceiver port with data to be read
@@ -114,10 +174,51 @@ class TCPReceiver : public DataReceiver
     /// @param pd TCPReceiver port with data to be read
     /// @param data Pointer to buffer to read message into
     /// @param small_buffer
+    /// @param compressed (Out) true if the message is a compressed frame
     /// @return amount of data pre-fetched or read from port
     uint32_t prefetchOrRead(internal_port_data_t* pd,
                             unsigned char** data,
-                            unsigned char* small_buffer);
+                            unsigned char* small_buffer,
+                            bool& compressed);
+
+    /// Deliver a message read from a port, or the messages of a compressed frame
+    /// @param pd TCPReceiver port the message was read from
+    /// @param data message
+    /// @param size message size
+    /// @param compressed true if the message is a compressed frame
+    void deliver(internal_port_data_t* pd, unsigned char* data, uint32_t size, bool compressed);
+
+    /// Read a message from a ready data port and deliver it
+    /// @param pd TCPReceiver port with data to be read
+    /// @param small_buffer
+    void readPort(internal_port_data_t* pd, unsigned char* small_buffer);
+
+    /// Deliver the messages left in the pre-fetch buffers of a shard's ports
+    /// @param shard the shard owning the ports; caller must hold its mutex
+    /// @param small_buffer
+    /// @return true if a ring received data which was not signaled on its
+    /// socket, and the shard must poll again without waiting
+    bool drainPrefetched(Shard& shard, unsigned char* small_buffer);
+
+    /// Accept a new connection on a listener port and register it
+    /// @param accept_port The listener port that received the new connection
+    void acceptConnection(internal_port_data_t* accept_port);
+
+    /// Assign a new data port to the least loaded shard and register it
+    /// with the shard's epoll instance
+    /// @param pd the data port
+    void registerDataPort(internal_port_data_t* pd);
+
+    /// Close a data port which may be read by another thread.  The port is
+    /// deleted right away if not assigned to a shard, otherwise by its shard.
+    /// @param pd the data port
+    void retirePort(internal_port_data_t* pd);
+
+    /// Read the data ports of a shard until shutdown. The first shard also
+    /// accepts new connections.
+    /// @param shard the shard
+    /// @return true if the shutdown signal was received
+    bool runShard(Shard& shard);
 
   public:
     /// Constructor
@@ -161,6 +262,17 @@ class TCPReceiver : public DataReceiver
     /// Unregister PE Input port labels from the name service.
     void unregisterPortLabels();
 
+    /// Create the receiver shards. The first shard uses the epoll instance
+    /// which also watches the accept ports.
+    /// @param nThreads number of shards
+    void createShards(uint32_t nThreads);
+
+    /// Stop the shard threads and wait for them to exit
+    void stopShards();
+
+    /// Delete the ports retired from a shard; caller must hold its mutex
+    void deleteRetiredPorts(Shard& shard);
+
     /// Cleanup resources at shutdown time.  This function is getting called
     /// from the main thread after a shutdown state transition.
     void doShutdown();
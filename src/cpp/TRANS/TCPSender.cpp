@@ -112,7 +112,8 @@ void TCPSender::deleteConnection(Connections::iterator& it)
 {
     DataSender::ConnectionId id = (*it)->getId();
     idManager_.mustReturnId(id);
-    delete *it;
+    // The monitor thread may still be flushing it
+    TCPConnection::unpin(*it);
     connsMap_.erase(id);
     conns_.erase(it);
 }
@@ -170,11 +171,26 @@ void TCPSender::shutdown()
 {
     SPCDBG(L_INFO, "Entering shutdown", CORE_TRANS_TCP);
 
+    // Let the asynchronous writers deliver what was submitted before the
+    // shutdown; they write concurrently, so the deadline applies to all
+    Connections::const_iterator it;
+    if (TCPConnection::isAsync()) {
+        streams_time_t deadline = TCPCommon::sysTimeMillis() + ASYNC_DRAIN_MILLIS;
+        for (it = conns_.begin(); it != conns_.end(); it++) {
+            streams_time_t now = TCPCommon::sysTimeMillis();
+            if (!(*it)->drainAsync(now < deadline ? deadline - now : 0)) {
+                SPCDBG(L_INFO,
+                       "Closing connection to " << QT((*it)->destinationPortLabel())
+                                                << " with messages still queued",
+                       CORE_TRANS_TCP);
+            }
+        }
+    }
+
     // Set shutdown requested flag; TCPInstance will remove us when it sees we
     // have set this
     DataSender::shutdown();
 
-    Connections::const_iterator it;
     for (it = conns_.begin(); it != conns_.end(); it++) {
         (*it)->close();
     }
@@ -337,7 +353,15 @@ void TCPSender::write(const void* data,
     SPCDBG(L_TRACE, "write(" << data << ", " << size << ")", CORE_TRANS_TCP);
 #endif
 
-    if (size <= TCP_SMALL_BUFFER) {
+    if (TCPConnection::isAsync()) {
+        // Copy once, then hand over to the connection writers
+        write_async fun(data, size, alwaysRetryAfterReconnect, resetReconnectionState);
+        write(data, size, fun);
+    } else if (write_batch::accepts(size, alwaysRetryAfterReconnect, resetReconnectionState)) {
+        // Coalesce with other messages into the connection send buffer
+        write_batch fun(data, size, alwaysRetryAfterReconnect, resetReconnectionState);
+        write(data, size, fun);
+    } else if (size <= TCP_SMALL_BUFFER) {
 #ifndef NDEBUG
         SPCDBG(L_TRACE,
                "Payload size is below " << TCP_SMALL_BUFFER << " bytes, using small buffer",
@@ -369,7 +393,15 @@ void TCPSender::write(const std::vector<ConnectionId>& ids,
            CORE_TRANS_TCP);
 #endif
 
-    if (size <= TCP_SMALL_BUFFER) {
+    if (TCPConnection::isAsync()) {
+        // Copy once, then hand over to the connection writers
+        write_async fun(data, size, alwaysRetryAfterReconnect, resetReconnectionState);
+        write(ids, data, size, fun);
+    } else if (write_batch::accepts(size, alwaysRetryAfterReconnect, resetReconnectionState)) {
+        // Coalesce with other messages into the connection send buffer
+        write_batch fun(data, size, alwaysRetryAfterReconnect, resetReconnectionState);
+        write(ids, data, size, fun);
+    } else if (size <= TCP_SMALL_BUFFER) {
 #ifndef NDEBUG
         SPCDBG(L_TRACE,
                "Payload size is below " << TCP_SMALL_BUFFER << " bytes, using small buffer",
@@ -422,4 +454,46 @@ void TCPSender::doHeartbeat(volatile bool* interruptFlag,
     }
 }
 
+void TCPSender::flush()
+{
+    if (!TCPConnection::isBatching()) {
+        return;
+    }
+
+    bool canRemoveConnections = false;
+    Connections::const_iterator it;
+    for (it = conns_.begin(); !_shutdown_requested && it != conns_.end(); it++) {
+        try {
+            if (TCPConnection::isAsync()) {
+                // Flush behind the messages still queued to the writer
+                (*it)->enqueueFlush();
+            } else {
+                (*it)->flush(TCPConnection::FLUSH_ON_PUNCT);
+            }
+        } catch (const OptionalConnectIncompleteException& ex) {
+            // Optional connection is incomplete, skip port
+            SPCDBG(L_TRACE, ex.getExplanation() << ". Moving on to next connection",
+                   CORE_TRANS_TCP);
+        } catch (const ConnectionRemovedException& ex) {
+            // Connection was closed (will delete later), skip port
+            canRemoveConnections = true;
+        }
+    }
+    if (canRemoveConnections) {
+        deleteClosedConnections();
+    }
+}
+
+void TCPSender::pinConnections(std::vector<TCPConnection*>& conns)
+{
+    Connections::const_iterator it;
+    for (it = conns_.begin(); it != conns_.end(); it++) {
+        TCPConnection* conn = *it;
+        if (!conn->isClosed()) {
+            conn->pin();
+            conns.push_back(conn);
+        }
+    }
+}
+
 IMPL_EXCEPTION(Distillery, TCPSender, DataSender);
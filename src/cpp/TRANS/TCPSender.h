@@ -89,7 +89,15 @@ class TCPSender
                        bool resetReconnectionState);
 
     /**
-     * Set the shutdown flag and close all connections.
+     * Write out the messages buffered by all connections.
+     * @see DataSender::flush
+     */
+    virtual void flush();
+
+    /**
+     * Set the shutdown flag and close all connections.  With asynchronous
+     * writes on, the connections are closed once their writers have written
+     * the queued messages, or after ASYNC_DRAIN_MILLIS.
      * @note synchronized
      */
     virtual void shutdown();
@@ -154,7 +162,7 @@ class TCPSender
     DataSender::Id getId() const;
 
   protected:
-    friend class TCPInstance; // TCPSender factory, calls doHeartbeat()
+    friend class TCPInstance; // TCPSender factory, calls doHeartbeat() and pinConnections()
 
     typedef boost::shared_ptr<ConnectionHelper> ConnectionHelperRef;
     typedef std::tr1::unordered_map<ConnectionId, TCPConnection*> ConnectionMap;
@@ -183,6 +191,11 @@ class TCPSender
                              streams_time_t beforeTime,
                              streams_time_t curTime);
 
+    // Invoked by the TCPInstance to flush the connection buffers holding
+    // messages older than the batch latency: pin the open connections and
+    // append them to conns, so that they can be flushed without the locks.
+    virtual void pinConnections(std::vector<TCPConnection*>& conns);
+
     // Add to TCPInstance
     void registerSender();
 
@@ -264,6 +277,9 @@ class TCPSender
                        const uint32_t size,
                        write_function& write_fun);
 
+    /// Longest time shutdown() waits for the asynchronous writers (milliseconds)
+    static const uint32_t ASYNC_DRAIN_MILLIS = 5000;
+
     uint64_t portId_;
     TCPInstance::shared_ptr tcpInstance_;
     Connections conns_;
@@ -345,6 +361,74 @@ class write_iov : public write_function
     bool resetReconnectionState_;
 };
 
+/**
+ * Append data to the connection send buffer
+ */
+class write_batch : public write_function
+{
+  public:
+    explicit write_batch(const void* data,
+                         const uint32_t size,
+                         bool alwaysRetryAfterReconnect,
+                         bool resetReconnectionState)
+      : hdr_(size)
+      , data_(data)
+      , size_(size)
+      , alwaysRetryAfterReconnect_(alwaysRetryAfterReconnect)
+      , resetReconnectionState_(resetReconnectionState)
+    {}
+
+    void operator()(TCPConnection* conn)
+    {
+        conn->append(hdr_, data_, size_, alwaysRetryAfterReconnect_, resetReconnectionState_);
+    }
+
+    /// Can a message be batched? Messages carrying reconnection directives
+    /// and those larger than the send buffer are written directly.
+    static bool accepts(const uint32_t size,
+                        bool alwaysRetryAfterReconnect,
+                        bool resetReconnectionState)
+    {
+        return TCPConnection::isBatching() && !alwaysRetryAfterReconnect &&
+               !resetReconnectionState &&
+               size + sizeof(socket_header_t) <= TCPConnection::getBatchSize();
+    }
+
+  private:
+    socket_header_t hdr_;
+    const void* data_;
+    const uint32_t size_;
+    bool alwaysRetryAfterReconnect_;
+    bool resetReconnectionState_;
+};
+
+/**
+ * Queue data to the connection asynchronous writer; the data is copied once
+ * and shared by all connections
+ */
+class write_async : public write_function
+{
+  public:
+    explicit write_async(const void* data,
+                         const uint32_t size,
+                         bool alwaysRetryAfterReconnect,
+                         bool resetReconnectionState)
+      : msg_(SharedMessage::create(data, size))
+      , alwaysRetryAfterReconnect_(alwaysRetryAfterReconnect)
+      , resetReconnectionState_(resetReconnectionState)
+    {}
+
+    void operator()(TCPConnection* conn)
+    {
+        conn->enqueue(msg_, alwaysRetryAfterReconnect_, resetReconnectionState_);
+    }
+
+  private:
+    SharedMessageRef msg_;
+    bool alwaysRetryAfterReconnect_;
+    bool resetReconnectionState_;
+};
+
 DECL_EXCEPTION(UTILS_NAMESPACE, TCPSender, DataSender);
 
 } // end namespace Distillery
@@ -44,6 +44,16 @@ class TCPSenderDynamic : public TCPSender
         TCPSender::connect();
     }
 
+    /**
+     * Write out the messages buffered by all connections.
+     * @see DataSender::flush
+     */
+    inline void flush()
+    {
+        AutoMutex am(connsMutex_);
+        TCPSender::flush();
+    }
+
     /**
      * Set the shutdown flag and close all connections.
      * @note synchronized
@@ -114,7 +124,7 @@ class TCPSenderDynamic : public TCPSender
     }
 
   protected:
-    friend class TCPInstance; // TCPSender factory, calls doHeartbeat()
+    friend class TCPInstance; // TCPSender factory, calls doHeartbeat() and pinConnections()
 
     /**
      * Constructor.
@@ -144,6 +154,12 @@ class TCPSenderDynamic : public TCPSender
         TCPSender::doHeartbeat(interruptFlag, beforeTime, curTime);
     }
 
+    inline void pinConnections(std::vector<TCPConnection*>& conns)
+    {
+        AutoMutex am(connsMutex_);
+        TCPSender::pinConnections(conns);
+    }
+
     /**
      * Add a connection to a receiver
      * @param pd  description of the remote port to connect to
@@ -40,6 +40,77 @@ bool TransportUtils::configureBlockingWrites()
     return (strcmp(value.c_str(), "true") == 0);
 }
 
+uint32_t TransportUtils::configureBatchSize()
+{
+    // if env var not defined, then default to batching disabled
+    std::string value = get_environment_variable("STREAMS_TCP_BATCH_SIZE", "0");
+    unsigned long size = strtoul(value.c_str(), NULL, 10);
+    return size < MAX_BATCH_SIZE ? size : MAX_BATCH_SIZE;
+}
+
+uint32_t TransportUtils::configureBatchLatency()
+{
+    std::string value = get_environment_variable("STREAMS_TCP_BATCH_LATENCY_USEC", "");
+    unsigned long latency = strtoul(value.c_str(), NULL, 10);
+    return latency > 0 ? latency : DEFAULT_BATCH_LATENCY_US;
+}
+
+uint32_t TransportUtils::configureReceiverEvents()
+{
+    std::string value = get_environment_variable("STREAMS_TCP_RECEIVER_EVENTS", "");
+    unsigned long events = strtoul(value.c_str(), NULL, 10);
+    if (events == 0) {
+        return DEFAULT_RECEIVER_EVENTS;
+    }
+    return events < MAX_RECEIVER_EVENTS ? events : MAX_RECEIVER_EVENTS;
+}
+
+uint32_t TransportUtils::configureReceiverThreads()
+{
+    // if env var not defined, then default to a single receiver thread
+    std::string value = get_environment_variable("STREAMS_TCP_RECEIVER_THREADS", "1");
+    unsigned long threads = strtoul(value.c_str(), NULL, 10);
+    if (threads == 0) {
+        return 1;
+    }
+    return threads < MAX_RECEIVER_THREADS ? threads : MAX_RECEIVER_THREADS;
+}
+
+uint32_t TransportUtils::configureShmRingSize()
+{
+    std::string value = get_environment_variable("STREAMS_TCP_SHM_RING_SIZE", "");
+    if (value.empty()) {
+        return DEFAULT_SHM_RING_SIZE;
+    }
+    unsigned long size = strtoul(value.c_str(), NULL, 10);
+    return size < MAX_SHM_RING_SIZE ? size : MAX_SHM_RING_SIZE;
+}
+
+uint32_t TransportUtils::configureAsyncQueueSize()
+{
+    // if env var not defined, then default to asynchronous writes disabled
+    std::string value = get_environment_variable("STREAMS_TCP_ASYNC_QUEUE_SIZE", "0");
+    unsigned long size = strtoul(value.c_str(), NULL, 10);
+    return size < MAX_ASYNC_QUEUE_SIZE ? size : MAX_ASYNC_QUEUE_SIZE;
+}
+
+uint32_t TransportUtils::configureCompressionLevel()
+{
+    // if env var not defined, then default to compression disabled
+    std::string value = get_environment_variable("STREAMS_TCP_COMPRESSION_LEVEL", "0");
+    unsigned long level = strtoul(value.c_str(), NULL, 10);
+    return level < MAX_COMPRESSION_LEVEL ? level : MAX_COMPRESSION_LEVEL;
+}
+
+uint32_t TransportUtils::configureCompressionThreshold()
+{
+    std::string value = get_environment_variable("STREAMS_TCP_COMPRESSION_THRESHOLD", "");
+    if (value.empty()) {
+        return DEFAULT_COMPRESSION_THRESHOLD;
+    }
+    return strtoul(value.c_str(), NULL, 10);
+}
+
 std::string TransportUtils::getTransportSecurityDirectory()
 {
     return std::string("/etc/config/job/");
@@ -55,6 +55,99 @@ class TransportUtils
      */
     static bool configureBlockingWrites();
 
+    /**
+     * Determine by reading the STREAMS_TCP_BATCH_SIZE environment variable
+     * the size threshold in bytes at which a TCP connection flushes the
+     * messages it has coalesced into its send buffer.
+     *
+     * @return the value of STREAMS_TCP_BATCH_SIZE, capped to
+     * MAX_BATCH_SIZE; 0 (batching disabled) if the variable is not defined.
+     */
+    static uint32_t configureBatchSize();
+
+    /**
+     * Determine by reading the STREAMS_TCP_BATCH_LATENCY_USEC environment
+     * variable how long a message can stay in a TCP connection's send
+     * buffer before the buffer is flushed.
+     *
+     * @return the value of STREAMS_TCP_BATCH_LATENCY_USEC if defined and
+     * greater than 0; otherwise DEFAULT_BATCH_LATENCY_US.
+     */
+    static uint32_t configureBatchLatency();
+
+    /**
+     * Determine by reading the STREAMS_TCP_RECEIVER_EVENTS environment
+     * variable how many ready sockets a TCP receiver thread handles per
+     * epoll_wait() call.
+     *
+     * @return the value of STREAMS_TCP_RECEIVER_EVENTS if defined and
+     * greater than 0, capped to MAX_RECEIVER_EVENTS; otherwise
+     * DEFAULT_RECEIVER_EVENTS.
+     */
+    static uint32_t configureReceiverEvents();
+
+    /**
+     * Determine by reading the STREAMS_TCP_RECEIVER_THREADS environment
+     * variable how many threads a TCP receiver shards its input ports
+     * across.  All the connections of an input port are read by the same
+     * thread; with more than one thread the receiver callbacks of
+     * different input ports are invoked concurrently.  A receiver with a
+     * port flagged singleThreaded, such as a PE input port feeding an
+     * operator which is single threaded on its inputs, uses one thread
+     * whatever the setting.
+     *
+     * @return the value of STREAMS_TCP_RECEIVER_THREADS if defined and
+     * greater than 0, capped to MAX_RECEIVER_THREADS; otherwise 1.
+     */
+    static uint32_t configureReceiverThreads();
+
+    /**
+     * Determine by reading the STREAMS_TCP_SHM_RING_SIZE environment
+     * variable the capacity of the shared memory ring which replaces the
+     * socket data path of a connection between two PEs on the same host.
+     *
+     * @return the value of STREAMS_TCP_SHM_RING_SIZE if defined, capped to
+     * MAX_SHM_RING_SIZE, 0 disabling the rings; otherwise
+     * DEFAULT_SHM_RING_SIZE.
+     */
+    static uint32_t configureShmRingSize();
+
+    /**
+     * Determine by reading the STREAMS_TCP_ASYNC_QUEUE_SIZE environment
+     * variable how many messages a TCP connection queues for its own writer
+     * thread.  With asynchronous writes on, a sender serializes a message
+     * once and hands it to the writer of each connection, so a slow
+     * receiver does not delay the others until its queue fills up.
+     *
+     * @return the value of STREAMS_TCP_ASYNC_QUEUE_SIZE, capped to
+     * MAX_ASYNC_QUEUE_SIZE; 0 (asynchronous writes disabled) if the variable
+     * is not defined.
+     */
+    static uint32_t configureAsyncQueueSize();
+
+    /**
+     * Determine by reading the STREAMS_TCP_COMPRESSION_LEVEL environment
+     * variable the zlib level at which connections compress their data.
+     * Compression is negotiated with each receiver during the connection
+     * handshake; connections to a receiver on the same host, or to a
+     * receiver which does not support it, are not compressed.
+     *
+     * @return the value of STREAMS_TCP_COMPRESSION_LEVEL, capped to
+     * MAX_COMPRESSION_LEVEL; 0 (compression disabled) if the variable is not
+     * defined.
+     */
+    static uint32_t configureCompressionLevel();
+
+    /**
+     * Determine by reading the STREAMS_TCP_COMPRESSION_THRESHOLD environment
+     * variable the size under which a batch or a message is sent
+     * uncompressed.
+     *
+     * @return the value of STREAMS_TCP_COMPRESSION_THRESHOLD if defined,
+     * otherwise DEFAULT_COMPRESSION_THRESHOLD.
+     */
+    static uint32_t configureCompressionThreshold();
+
     /**
      * Return the path of the directory dedicated to transport security.
      */
@@ -70,6 +163,21 @@ class TransportUtils
      */
     static std::string getTransportKeyPath(void);
 
+    static const uint32_t MAX_BATCH_SIZE = 1024 * 1024;
+    static const uint32_t DEFAULT_BATCH_LATENCY_US = 1000;
+
+    static const uint32_t DEFAULT_RECEIVER_EVENTS = 64;
+    static const uint32_t MAX_RECEIVER_EVENTS = 1024;
+    static const uint32_t MAX_RECEIVER_THREADS = 64;
+
+    static const uint32_t DEFAULT_SHM_RING_SIZE = 1024 * 1024;
+    static const uint32_t MAX_SHM_RING_SIZE = 256 * 1024 * 1024;
+
+    static const uint32_t MAX_ASYNC_QUEUE_SIZE = 64 * 1024;
+
+    static const uint32_t MAX_COMPRESSION_LEVEL = 9;
+    static const uint32_t DEFAULT_COMPRESSION_THRESHOLD = 1024;
+
     static const uint32_t MIN_WAIT_TIME_US = 10000;
     static const uint32_t MAX_WAIT_TIME_US = 10000000;
 
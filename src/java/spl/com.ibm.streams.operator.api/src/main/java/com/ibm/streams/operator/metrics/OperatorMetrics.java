@@ -170,7 +170,59 @@ public interface OperatorMetrics {
      *
      * @since IBM&reg; Streams Version 4.2.3.0
      */
-    nEnqueueWaits;
+    nEnqueueWaits,
+    /**
+     * Time the port thread waited for items to be queued (milliseconds).
+     *
+     * @since IBM&reg; Streams Version 5.0
+     */
+    queueWaitTime,
+    /**
+     * Number of batches of items dequeued by the port thread. The average
+     * number of items dequeued per batch is the number of items processed
+     * divided by this value.
+     *
+     * @since IBM&reg; Streams Version 5.0
+     */
+    nDequeueBatches,
+    /**
+     * Median time items spent queued for the port (nanoseconds, sampled).
+     *
+     * @since IBM&reg; Streams Version 6.0
+     */
+    queueLatencyP50,
+    /**
+     * 99th percentile of the time items spent queued for the port (nanoseconds, sampled).
+     *
+     * @since IBM&reg; Streams Version 6.0
+     */
+    queueLatencyP99,
+    /**
+     * 99.9th percentile of the time items spent queued for the port (nanoseconds, sampled).
+     *
+     * @since IBM&reg; Streams Version 6.0
+     */
+    queueLatencyP999,
+    /**
+     * Median time spent processing tuples received by the port (nanoseconds, sampled).
+     *
+     * @since IBM&reg; Streams Version 6.0
+     */
+    processLatencyP50,
+    /**
+     * 99th percentile of the time spent processing tuples received by the port (nanoseconds,
+     * sampled).
+     *
+     * @since IBM&reg; Streams Version 6.0
+     */
+    processLatencyP99,
+    /**
+     * 99.9th percentile of the time spent processing tuples received by the port (nanoseconds,
+     * sampled).
+     *
+     * @since IBM&reg; Streams Version 6.0
+     */
+    processLatencyP999;
 
     /**
      * Convenience method to get the metric for a specific operator port.
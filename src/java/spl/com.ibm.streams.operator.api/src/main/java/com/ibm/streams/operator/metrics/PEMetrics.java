@@ -64,7 +64,27 @@ public interface PEMetrics {
     /** Number of window punctuation marks processed by the port. */
     nWindowPunctsProcessed,
     /** Number of final punctuation marks processed by the port. */
-    nFinalPunctsProcessed;
+    nFinalPunctsProcessed,
+    /**
+     * Median time to deliver received messages to the operators (nanoseconds, sampled).
+     *
+     * @since IBM&reg; Streams Version 6.0
+     */
+    deliverLatencyP50,
+    /**
+     * 99th percentile of the time to deliver received messages to the operators (nanoseconds,
+     * sampled).
+     *
+     * @since IBM&reg; Streams Version 6.0
+     */
+    deliverLatencyP99,
+    /**
+     * 99.9th percentile of the time to deliver received messages to the operators (nanoseconds,
+     * sampled).
+     *
+     * @since IBM&reg; Streams Version 6.0
+     */
+    deliverLatencyP999;
 
     /**
      * Convenience method to get the Metric for a specific processing element port.
@@ -80,6 +80,8 @@ public abstract class RuntimeMetricsFactory
       case nTuplesProcessed:
       case nWindowPunctsProcessed:
       case nEnqueueWaits:
+      case queueWaitTime:
+      case nDequeueBatches:
         kind = Metric.Kind.COUNTER;
         break;
       case nFinalPunctsQueued:
@@ -88,6 +90,12 @@ public abstract class RuntimeMetricsFactory
       case queueSize:
       case maxItemsQueued:
       case recentMaxItemsQueued:
+      case queueLatencyP50:
+      case queueLatencyP99:
+      case queueLatencyP999:
+      case processLatencyP50:
+      case processLatencyP99:
+      case processLatencyP999:
         kind = Metric.Kind.GAUGE;
         break;
       case recentMaxItemsQueuedInterval:
@@ -70,6 +70,17 @@ public class DirectTupleInput extends DirectTuple {
       case recentMaxItemsQueued:
       case recentMaxItemsQueuedInterval:
       case nEnqueueWaits:
+      case queueWaitTime:
+      case nDequeueBatches:
+        return RuntimeMetric.ZERO_METRIC;
+
+        // Latencies are only sampled by the native runtime
+      case queueLatencyP50:
+      case queueLatencyP99:
+      case queueLatencyP999:
+      case processLatencyP50:
+      case processLatencyP99:
+      case processLatencyP999:
         return RuntimeMetric.ZERO_METRIC;
       default:
         throw new UnsupportedOperationException(name.name());
@@ -105,6 +105,20 @@ public class DirectTupleThreadedInput extends DirectTupleInput {
       case nEnqueueWaits:
         return enqueueWaitsMetric;
 
+        // The Java queue hands over items one at a time
+      case queueWaitTime:
+      case nDequeueBatches:
+        return RuntimeMetric.ZERO_METRIC;
+
+        // Latencies are only sampled by the native runtime
+      case queueLatencyP50:
+      case queueLatencyP99:
+      case queueLatencyP999:
+      case processLatencyP50:
+      case processLatencyP99:
+      case processLatencyP999:
+        return RuntimeMetric.ZERO_METRIC;
+
       default:
         throw new UnsupportedOperationException(name.name());
     }